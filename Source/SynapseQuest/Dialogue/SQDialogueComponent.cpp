@@ -1,7 +1,10 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "Dialogue/SQDialogueComponent.h"
+#include "Dialogue/SQDialogueRelayComponent.h"
 #include "Component/SynapseComponent.h"
+#include "Interaction/SQInteractionSubsystem.h"
+#include "Engine/World.h"
 #include "SynapseQuest.h"
 
 
@@ -27,6 +30,22 @@ void USQDialogueComponent::BeginPlay()
 				 "Add a USynapseComponent to this actor for dialogue to work."),
 			*GetOwner()->GetName());
 	}
+
+	// Let player characters find us without tracing
+	if (USQInteractionSubsystem* Interaction = GetWorld()->GetSubsystem<USQInteractionSubsystem>())
+	{
+		Interaction->RegisterInteractable(GetOwner());
+	}
+}
+
+void USQDialogueComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USQInteractionSubsystem* Interaction = GetWorld()->GetSubsystem<USQInteractionSubsystem>())
+	{
+		Interaction->UnregisterInteractable(GetOwner());
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 USynapseComponent* USQDialogueComponent::GetSynapseComponent() const
@@ -58,13 +77,42 @@ TMap<FString, FString> USQDialogueComponent::BuildTemplateVariables() const
 // ============================================================
 
 void USQDialogueComponent::StartDialogue(const FString& PlayerName)
+{
+	// Clients ask the server to run the conversation and wait for its first line
+	if (IsNetMode(NM_Client))
+	{
+		if (DialogueState != ESQDialogueState::Inactive)
+		{
+			UE_LOG(LogSynapseQuest, Warning,
+				TEXT("USQDialogueComponent::StartDialogue: Dialogue already active on '%s'"),
+				*GetOwner()->GetName());
+			return;
+		}
+
+		USQDialogueRelayComponent* Relay = USQDialogueRelayComponent::FindLocal(this);
+		if (!IsValid(Relay))
+		{
+			UE_LOG(LogSynapseQuest, Error,
+				TEXT("USQDialogueComponent::StartDialogue: No USQDialogueRelayComponent on the local player controller"));
+			return;
+		}
+
+		SetDialogueState(ESQDialogueState::WaitingForNPC);
+		Relay->ServerStartDialogue(this);
+		return;
+	}
+
+	StartDialogueFor(nullptr, PlayerName);
+}
+
+bool USQDialogueComponent::StartDialogueFor(USQDialogueRelayComponent* Relay, const FString& PlayerName)
 {
 	if (DialogueState != ESQDialogueState::Inactive)
 	{
 		UE_LOG(LogSynapseQuest, Warning,
 			TEXT("USQDialogueComponent::StartDialogue: Dialogue already active on '%s'"),
 			*GetOwner()->GetName());
-		return;
+		return false;
 	}
 
 	USynapseComponent* Synapse = GetSynapseComponent();
@@ -73,10 +121,11 @@ void USQDialogueComponent::StartDialogue(const FString& PlayerName)
 		UE_LOG(LogSynapseQuest, Error,
 			TEXT("USQDialogueComponent::StartDialogue: No USynapseComponent on '%s'"),
 			*GetOwner()->GetName());
-		return;
+		return false;
 	}
 
 	CurrentPlayerName = PlayerName;
+	Participant = Relay;
 
 	// Clear any previous conversation history so each dialogue is fresh
 	Synapse->ClearHistory();
@@ -92,6 +141,8 @@ void USQDialogueComponent::StartDialogue(const FString& PlayerName)
 		GetDialogueSystemPrompt(),
 		OpeningPrompt,
 		BuildTemplateVariables());
+
+	return true;
 }
 
 void USQDialogueComponent::SelectOption(int32 OptionIndex)
@@ -111,6 +162,18 @@ void USQDialogueComponent::SelectOption(int32 OptionIndex)
 		return;
 	}
 
+	// Clients hand the choice to the server, which runs the conversation
+	if (IsNetMode(NM_Client))
+	{
+		if (USQDialogueRelayComponent* Relay = USQDialogueRelayComponent::FindLocal(this);
+			IsValid(Relay))
+		{
+			SetDialogueState(ESQDialogueState::WaitingForNPC);
+			Relay->ServerSelectOption(this, static_cast<uint8>(OptionIndex));
+		}
+		return;
+	}
+
 	const FSQDialogueOption& Option = CurrentLine.Options[OptionIndex];
 
 	// If this was a goodbye option, end the dialogue
@@ -143,6 +206,19 @@ void USQDialogueComponent::EndDialogue()
 		return;
 	}
 
+	// Clients close their side right away and let the server know
+	if (IsNetMode(NM_Client))
+	{
+		if (USQDialogueRelayComponent* Relay = USQDialogueRelayComponent::FindLocal(this);
+			IsValid(Relay))
+		{
+			Relay->ServerEndDialogue(this);
+		}
+
+		ResetDialogue();
+		return;
+	}
+
 	// Cancel any pending LLM requests
 	if (USynapseComponent* Synapse = GetSynapseComponent();
 		IsValid(Synapse))
@@ -150,11 +226,59 @@ void USQDialogueComponent::EndDialogue()
 		Synapse->CancelAllRequests();
 	}
 
-	CurrentLine = FSQDialogueLine();
-	CurrentPlayerName.Empty();
+	// Close the remote participant's side too
+	if (Participant.IsValid() && !Participant->IsLocal())
+	{
+		Participant->SendDialogueEnded(this);
+	}
 
-	SetDialogueState(ESQDialogueState::Inactive);
-	OnDialogueEnded.Broadcast(this);
+	ResetDialogue();
+}
+
+void USQDialogueComponent::EndDialogueFor(USQDialogueRelayComponent* Relay)
+{
+	if (!IsParticipant(Relay))
+	{
+		return;
+	}
+
+	// The participant already knows, so don't send them the end
+	Participant.Reset();
+
+	EndDialogue();
+}
+
+// ============================================================
+// Networking
+// ============================================================
+
+bool USQDialogueComponent::IsParticipant(const USQDialogueRelayComponent* Relay) const
+{
+	return Relay && Participant.Get() == Relay;
+}
+
+void USQDialogueComponent::ReceiveRemoteLine(const FSQDialogueLine& Line)
+{
+	// Drop lines of a conversation we have already left
+	if (DialogueState == ESQDialogueState::Inactive)
+	{
+		return;
+	}
+
+	CurrentLine = Line;
+
+	SetDialogueState(ESQDialogueState::PlayerChoosing);
+	OnDialogueLineReady.Broadcast(this, CurrentLine);
+}
+
+void USQDialogueComponent::ReceiveRemoteEnd()
+{
+	if (DialogueState == ESQDialogueState::Inactive)
+	{
+		return;
+	}
+
+	ResetDialogue();
 }
 
 // ============================================================
@@ -188,16 +312,26 @@ void USQDialogueComponent::HandleLLMResponse(
 		GoodbyeOption.Tone = ESQDialogueTone::Neutral;
 		CurrentLine.Options.Add(GoodbyeOption);
 
-		SetDialogueState(ESQDialogueState::PlayerChoosing);
-		OnDialogueLineReady.Broadcast(this, CurrentLine);
+		PublishCurrentLine();
 		return;
 	}
 
 	// Parse the structured response
 	CurrentLine = ParseResponse(Response.Content);
 
+	PublishCurrentLine();
+}
+
+void USQDialogueComponent::PublishCurrentLine()
+{
 	SetDialogueState(ESQDialogueState::PlayerChoosing);
 	OnDialogueLineReady.Broadcast(this, CurrentLine);
+
+	// Only the participant receives the line, through their own connection
+	if (Participant.IsValid() && !Participant->IsLocal())
+	{
+		Participant->SendLine(this, CurrentLine);
+	}
 }
 
 // ============================================================
@@ -340,6 +474,16 @@ FSQDialogueLine USQDialogueComponent::ParseResponse(const FString& ResponseText)
 // State Management
 // ============================================================
 
+void USQDialogueComponent::ResetDialogue()
+{
+	CurrentLine = FSQDialogueLine();
+	CurrentPlayerName.Empty();
+	Participant.Reset();
+
+	SetDialogueState(ESQDialogueState::Inactive);
+	OnDialogueEnded.Broadcast(this);
+}
+
 void USQDialogueComponent::SetDialogueState(ESQDialogueState NewState)
 {
 	if (DialogueState != NewState)
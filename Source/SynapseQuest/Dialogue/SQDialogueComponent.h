@@ -10,6 +10,7 @@
 
 
 class USynapseComponent;
+class USQDialogueRelayComponent;
 
 
 /**
@@ -53,6 +54,11 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(
  * 4. Bind to OnDialogueLineReady to display NPC text and options.
  * 5. Call SelectOption() when the player picks a response.
  * 6. Call EndDialogue() to close the conversation.
+ *
+ * In multiplayer the server runs the conversation and alone talks to the
+ * LLM. Calls made on a client are forwarded through the local player's
+ * USQDialogueRelayComponent, and the resulting lines are relayed back to
+ * that player only.
  */
 UCLASS(ClassGroup = (AI), meta = (BlueprintSpawnableComponent))
 class SYNAPSEQUEST_API USQDialogueComponent : public UActorComponent
@@ -68,6 +74,8 @@ public:
 
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	// ============================================================
 	// Configuration
 	// ============================================================
@@ -100,6 +108,7 @@ public:
 	 * @brief Starts a dialogue conversation with the NPC.
 	 * Sends the opening prompt to the LLM and transitions to WaitingForNPC.
 	 * @param PlayerName The player's display name for template substitution.
+	 * Ignored on clients, where the server uses the name from the player state.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Dialogue")
 	void StartDialogue(const FString& PlayerName = TEXT("Player"));
@@ -141,6 +150,38 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Dialogue")
 	const FString& GetNPCName() const { return NPCName; }
 
+	// ============================================================
+	// Networking
+	// ============================================================
+
+	/**
+	 * @brief Starts a dialogue on the server on behalf of a player.
+	 * @param Relay The participating player's relay, or null for a local player.
+	 * @return False if the dialogue could not be started.
+	 */
+	bool StartDialogueFor(USQDialogueRelayComponent* Relay, const FString& PlayerName);
+
+	/**
+	 * @brief Ends the dialogue on the server if the given player is taking
+	 * part in it, without notifying them.
+	 */
+	void EndDialogueFor(USQDialogueRelayComponent* Relay);
+
+	/**
+	 * @brief Returns true if the given player is taking part in the dialogue.
+	 */
+	bool IsParticipant(const USQDialogueRelayComponent* Relay) const;
+
+	/**
+	 * @brief Applies a line relayed by the server. Client only.
+	 */
+	void ReceiveRemoteLine(const FSQDialogueLine& Line);
+
+	/**
+	 * @brief Ends the dialogue after the server has ended it. Client only.
+	 */
+	void ReceiveRemoteEnd();
+
 	// ============================================================
 	// Events
 	// ============================================================
@@ -191,6 +232,16 @@ protected:
 	 */
 	FSQDialogueLine ParseResponse(const FString& ResponseText) const;
 
+	/**
+	 * @brief Broadcasts the current line and relays it to a remote participant.
+	 */
+	void PublishCurrentLine();
+
+	/**
+	 * @brief Clears conversation state and broadcasts the end of the dialogue.
+	 */
+	void ResetDialogue();
+
 	/**
 	 * @brief Sets the dialogue state and broadcasts the change.
 	 */
@@ -213,6 +264,9 @@ protected:
 	/** Player name for the current conversation */
 	FString CurrentPlayerName;
 
+	/** Relay of the player taking part in the conversation. Server only */
+	TWeakObjectPtr<USQDialogueRelayComponent> Participant;
+
 	/** Cached SynapseComponent reference */
 	UPROPERTY()
 	mutable TObjectPtr<USynapseComponent> CachedSynapseComponent;
@@ -0,0 +1,264 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Dialogue/SQDialogueRelayComponent.h"
+#include "Dialogue/SQDialogueComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+#include "Engine/NetConnection.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/OutputDevice.h"
+#include "SynapseQuest.h"
+
+
+static TAutoConsoleVariable<bool> CVarSQDialogueMeasureNet(
+	TEXT("SQ.Dialogue.MeasureNet"),
+	false,
+	TEXT("If true, the client connection is flushed around every dialogue turn, so SQ.Dialogue.NetStats can count\n")
+	TEXT("the bytes each turn puts on the wire, packet and bunch overhead included. Sends extra packets, so leave it off outside of measurements."),
+	ECVF_Default);
+
+/** Server side accounting of the bytes sent per turn, printed with SQ.Dialogue.NetStats */
+namespace SQDialogueNetStats
+{
+	static int64 Turns = 0;
+	static int64 TotalBytes = 0;
+	static int64 MaxTurnBytes = 0;
+}
+
+static FAutoConsoleCommandWithOutputDevice SQDialogueNetStatsCommand(
+	TEXT("SQ.Dialogue.NetStats"),
+	TEXT("Prints the bytes sent to clients per dialogue turn since the last reset. Requires SQ.Dialogue.MeasureNet 1."),
+	FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& Ar)
+	{
+		using namespace SQDialogueNetStats;
+
+		Ar.Logf(TEXT("SQ.Dialogue.NetStats: %lld turns, %.1f bytes per turn on average, %lld at most"),
+			Turns, Turns > 0 ? static_cast<double>(TotalBytes) / Turns : 0.0, MaxTurnBytes);
+	}));
+
+static FAutoConsoleCommand SQDialogueResetNetStatsCommand(
+	TEXT("SQ.Dialogue.ResetNetStats"),
+	TEXT("Clears the dialogue payload accounting."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		using namespace SQDialogueNetStats;
+
+		Turns = 0;
+		TotalBytes = 0;
+		MaxTurnBytes = 0;
+	}));
+
+
+USQDialogueRelayComponent::USQDialogueRelayComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	// RPCs only go through replicated components
+	SetIsReplicatedByDefault(true);
+}
+
+void USQDialogueRelayComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// The player is leaving, so free up the NPCs they were talking to
+	for (const TWeakObjectPtr<USQDialogueComponent>& Dialogue : ActiveDialogues)
+	{
+		if (Dialogue.IsValid())
+		{
+			Dialogue->EndDialogueFor(this);
+		}
+	}
+
+	ActiveDialogues.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+// ============================================================
+// Lookup
+// ============================================================
+
+USQDialogueRelayComponent* USQDialogueRelayComponent::FindLocal(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	const APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+
+	if (!PlayerController || !PlayerController->IsLocalController())
+	{
+		return nullptr;
+	}
+
+	return PlayerController->FindComponentByClass<USQDialogueRelayComponent>();
+}
+
+bool USQDialogueRelayComponent::IsLocal() const
+{
+	const APlayerController* PlayerController = GetOwner<APlayerController>();
+	return PlayerController && PlayerController->IsLocalController();
+}
+
+// ============================================================
+// Server -> Client
+// ============================================================
+
+void USQDialogueRelayComponent::SendLine(USQDialogueComponent* Dialogue, const FSQDialogueLine& Line)
+{
+	// The full response is only sent when it differs from the label
+	TArray<FSQDialogueOption> Options = Line.Options;
+
+	for (FSQDialogueOption& Option : Options)
+	{
+		if (Option.FullResponse == Option.Text)
+		{
+			Option.FullResponse.Empty();
+		}
+	}
+
+	UNetConnection* Connection = CVarSQDialogueMeasureNet.GetValueOnGameThread() ? GetOwner()->GetNetConnection() : nullptr;
+	int64 BytesBefore = 0;
+
+	// Send what's already queued first, so it isn't counted against this turn
+	if (Connection)
+	{
+		Connection->FlushNet();
+		BytesBefore = Connection->OutTotalBytes;
+	}
+
+	// Lines are far below the engine's partial bunch limits, so they go out in one RPC
+	ClientReceiveLine(Dialogue, Line.NPCText, Options, Line.bIsGoodbye);
+
+	if (Connection)
+	{
+		Connection->FlushNet();
+
+		const int64 TurnBytes = static_cast<int64>(Connection->OutTotalBytes) - BytesBefore;
+
+		{
+			using namespace SQDialogueNetStats;
+
+			++Turns;
+			TotalBytes += TurnBytes;
+			MaxTurnBytes = FMath::Max(MaxTurnBytes, TurnBytes);
+		}
+
+		UE_LOG(LogSynapseQuest, Verbose,
+			TEXT("USQDialogueRelayComponent: sent a turn of '%s' in %lld bytes"),
+			*Dialogue->GetNPCName(), TurnBytes);
+	}
+}
+
+void USQDialogueRelayComponent::SendDialogueEnded(USQDialogueComponent* Dialogue)
+{
+	ActiveDialogues.Remove(Dialogue);
+
+	ClientDialogueEnded(Dialogue);
+}
+
+void USQDialogueRelayComponent::ClientReceiveLine_Implementation(
+	USQDialogueComponent* Dialogue,
+	const FString& NPCText,
+	const TArray<FSQDialogueOption>& Options,
+	bool bIsGoodbye)
+{
+	FSQDialogueLine Line;
+	Line.NPCText = NPCText;
+	Line.Options = Options;
+	Line.bIsGoodbye = bIsGoodbye;
+
+	// Restore the full responses left out to save bandwidth
+	for (FSQDialogueOption& Option : Line.Options)
+	{
+		if (Option.FullResponse.IsEmpty())
+		{
+			Option.FullResponse = Option.Text;
+		}
+	}
+
+	if (IsValid(Dialogue))
+	{
+		Dialogue->ReceiveRemoteLine(Line);
+	}
+}
+
+void USQDialogueRelayComponent::ClientDialogueEnded_Implementation(USQDialogueComponent* Dialogue)
+{
+	if (IsValid(Dialogue))
+	{
+		Dialogue->ReceiveRemoteEnd();
+	}
+}
+
+// ============================================================
+// Client -> Server
+// ============================================================
+
+void USQDialogueRelayComponent::ServerStartDialogue_Implementation(USQDialogueComponent* Dialogue)
+{
+	if (!IsValid(Dialogue))
+	{
+		return;
+	}
+
+	// Don't let players hold NPCs they aren't standing next to
+	if (!IsInDialogueRange(Dialogue))
+	{
+		UE_LOG(LogSynapseQuest, Warning,
+			TEXT("USQDialogueRelayComponent: Refused dialogue with '%s', player is out of range"),
+			*Dialogue->GetOwner()->GetName());
+
+		ClientDialogueEnded(Dialogue);
+		return;
+	}
+
+	// Names come from the server's player state, never from the client, since they end up in the LLM prompt
+	const APlayerController* PlayerController = GetOwner<APlayerController>();
+	const APlayerState* PlayerState = PlayerController ? PlayerController->PlayerState.Get() : nullptr;
+	const FString PlayerName = PlayerState ? PlayerState->GetPlayerName() : TEXT("Player");
+
+	if (Dialogue->StartDialogueFor(this, PlayerName))
+	{
+		ActiveDialogues.AddUnique(Dialogue);
+	}
+	else
+	{
+		// The NPC is busy, so let the client close its dialogue
+		ClientDialogueEnded(Dialogue);
+	}
+}
+
+bool USQDialogueRelayComponent::IsInDialogueRange(const USQDialogueComponent* Dialogue) const
+{
+	const APlayerController* PlayerController = GetOwner<APlayerController>();
+	const APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+	const AActor* NPC = Dialogue->GetOwner();
+
+	if (!IsValid(Pawn) || !IsValid(NPC))
+	{
+		return false;
+	}
+
+	return FVector::DistSquared(Pawn->GetActorLocation(), NPC->GetActorLocation()) <= FMath::Square(MaxDialogueDistance);
+}
+
+void USQDialogueRelayComponent::ServerSelectOption_Implementation(
+	USQDialogueComponent* Dialogue,
+	uint8 OptionIndex)
+{
+	// Only the participant gets to choose
+	if (IsValid(Dialogue) && Dialogue->IsParticipant(this))
+	{
+		Dialogue->SelectOption(OptionIndex);
+	}
+}
+
+void USQDialogueRelayComponent::ServerEndDialogue_Implementation(USQDialogueComponent* Dialogue)
+{
+	if (IsValid(Dialogue))
+	{
+		ActiveDialogues.Remove(Dialogue);
+
+		// The client has already closed its side
+		Dialogue->EndDialogueFor(this);
+	}
+}
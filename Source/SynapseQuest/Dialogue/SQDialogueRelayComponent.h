@@ -0,0 +1,125 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Dialogue/SQDialogueTypes.h"
+#include "SQDialogueRelayComponent.generated.h"
+
+
+class USQDialogueComponent;
+
+
+/**
+ * @brief USQDialogueRelayComponent carries server-owned dialogue to the one
+ * client taking part in it.
+ *
+ * Attach it to the player controller. Since the controller is only relevant
+ * to its owning connection, lines sent through its client RPCs never reach
+ * other players, and option selections travel back through reliable server
+ * RPCs. The server alone talks to the LLM, so LLM load scales with the number
+ * of conversations rather than the number of clients.
+ *
+ * Each line is sent in a single RPC. Options omit their full response when
+ * it matches the label. With SQ.Dialogue.MeasureNet set, the bytes each
+ * turn puts on the connection are counted and printed with
+ * SQ.Dialogue.NetStats.
+ */
+UCLASS(ClassGroup = (AI), meta = (BlueprintSpawnableComponent))
+class SYNAPSEQUEST_API USQDialogueRelayComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	USQDialogueRelayComponent();
+
+	// ============================================================
+	// UActorComponent Interface
+	// ============================================================
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// ============================================================
+	// Configuration
+	// ============================================================
+
+	/**
+	 * @brief Max distance between the player's pawn and the NPC for the
+	 * server to accept a dialogue request.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue", meta = (ClampMin = 0, Units = "cm"))
+	float MaxDialogueDistance = 1500.0f;
+
+	// ============================================================
+	// Lookup
+	// ============================================================
+
+	/**
+	 * @brief Returns the relay of the first local player, if any.
+	 */
+	static USQDialogueRelayComponent* FindLocal(const UObject* WorldContextObject);
+
+	/**
+	 * @brief Returns true if this relay belongs to a player on this machine.
+	 */
+	bool IsLocal() const;
+
+	// ============================================================
+	// Server -> Client
+	// ============================================================
+
+	/**
+	 * @brief Streams a finished dialogue line to the owning client.
+	 * Server only.
+	 */
+	void SendLine(USQDialogueComponent* Dialogue, const FSQDialogueLine& Line);
+
+	/**
+	 * @brief Tells the owning client a dialogue has ended. Server only.
+	 */
+	void SendDialogueEnded(USQDialogueComponent* Dialogue);
+
+	// ============================================================
+	// Client -> Server
+	// ============================================================
+
+	/**
+	 * @brief Asks the server to start a dialogue for this player. The
+	 * server uses the player's name from their player state, and refuses
+	 * if their pawn isn't within MaxDialogueDistance of the NPC.
+	 */
+	UFUNCTION(Server, Reliable)
+	void ServerStartDialogue(USQDialogueComponent* Dialogue);
+
+	/**
+	 * @brief Sends the player's choice to the server.
+	 */
+	UFUNCTION(Server, Reliable)
+	void ServerSelectOption(USQDialogueComponent* Dialogue, uint8 OptionIndex);
+
+	/**
+	 * @brief Asks the server to end a dialogue this player is in.
+	 */
+	UFUNCTION(Server, Reliable)
+	void ServerEndDialogue(USQDialogueComponent* Dialogue);
+
+protected:
+
+	/** Passes a line of the server's dialogue to the client */
+	UFUNCTION(Client, Reliable)
+	void ClientReceiveLine(USQDialogueComponent* Dialogue, const FString& NPCText, const TArray<FSQDialogueOption>& Options, bool bIsGoodbye);
+
+	/**
+	 * @brief Returns true if the player's pawn is close enough to talk to
+	 * the owner of a dialogue.
+	 */
+	bool IsInDialogueRange(const USQDialogueComponent* Dialogue) const;
+
+	/** Ends a dialogue on the client */
+	UFUNCTION(Client, Reliable)
+	void ClientDialogueEnded(USQDialogueComponent* Dialogue);
+
+	/** Dialogues this player is taking part in. Server only */
+	TArray<TWeakObjectPtr<USQDialogueComponent>> ActiveDialogues;
+};
@@ -0,0 +1,40 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Interaction/SQInteractableComponent.h"
+#include "Interaction/SQInteractionSubsystem.h"
+#include "Engine/World.h"
+
+
+USQInteractableComponent::USQInteractableComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void USQInteractableComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (USQInteractionSubsystem* Interaction = GetWorld()->GetSubsystem<USQInteractionSubsystem>())
+	{
+		Interaction->RegisterInteractable(GetOwner());
+	}
+}
+
+void USQInteractableComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USQInteractionSubsystem* Interaction = GetWorld()->GetSubsystem<USQInteractionSubsystem>())
+	{
+		Interaction->UnregisterInteractable(GetOwner());
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+// ============================================================
+// Interaction
+// ============================================================
+
+void USQInteractableComponent::Use(AActor* User)
+{
+	OnUsed.Broadcast(this, User);
+}
@@ -0,0 +1,61 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SQInteractableComponent.generated.h"
+
+
+class USQInteractableComponent;
+
+/**
+ * @brief FOnInteractableUsed fires when a character uses the owning actor.
+ */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(
+	FOnInteractableUsed,
+	USQInteractableComponent*, InteractableComponent,
+	AActor*, User);
+
+
+/**
+ * @brief USQInteractableComponent makes its owner show up as a use
+ * target for player characters.
+ *
+ * The owner is indexed by the USQInteractionSubsystem while the component
+ * is active. Using the owner fires OnUsed in place of the character's
+ * OnUseOther, so the legacy path only sees plain characters. Actors with
+ * a USQDialogueComponent don't need this component, since dialogue
+ * registers its owner on its own.
+ */
+UCLASS(ClassGroup = (Interaction), meta = (BlueprintSpawnableComponent))
+class SYNAPSEQUEST_API USQInteractableComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	USQInteractableComponent();
+
+	// ============================================================
+	// UActorComponent Interface
+	// ============================================================
+
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// ============================================================
+	// Interaction
+	// ============================================================
+
+	/**
+	 * @brief Uses the owning actor.
+	 * @param User The actor using this one, usually a player character.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Interaction")
+	void Use(AActor* User);
+
+	/** Fires when the owning actor is used. */
+	UPROPERTY(BlueprintAssignable, Category = "Interaction")
+	FOnInteractableUsed OnUsed;
+};
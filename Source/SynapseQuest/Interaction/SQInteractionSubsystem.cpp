@@ -0,0 +1,193 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Interaction/SQInteractionSubsystem.h"
+#include "Components/SceneComponent.h"
+#include "Engine/World.h"
+
+
+// ============================================================
+// UWorldSubsystem Interface
+// ============================================================
+
+bool USQInteractionSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer))
+	{
+		return false;
+	}
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && (World->WorldType == EWorldType::Game || World->WorldType == EWorldType::PIE);
+}
+
+void USQInteractionSubsystem::Deinitialize()
+{
+	for (const TPair<TObjectKey<AActor>, FInteractableEntry>& Pair : Entries)
+	{
+		if (AActor* Actor = Pair.Value.Actor.Get();
+			IsValid(Actor) && Actor->GetRootComponent())
+		{
+			Actor->GetRootComponent()->TransformUpdated.Remove(Pair.Value.TransformHandle);
+		}
+	}
+
+	Entries.Reset();
+	Cells.Reset();
+
+	Super::Deinitialize();
+}
+
+// ============================================================
+// Registration
+// ============================================================
+
+void USQInteractionSubsystem::RegisterInteractable(AActor* Actor)
+{
+	if (!IsValid(Actor))
+	{
+		return;
+	}
+
+	FInteractableEntry& Entry = Entries.FindOrAdd(Actor);
+
+	if (++Entry.RefCount > 1)
+	{
+		return;
+	}
+
+	Entry.Actor = Actor;
+	Entry.Cell = GetCell(Actor->GetActorLocation());
+
+	Cells.FindOrAdd(Entry.Cell).Add(Actor);
+
+	// keep the cell up to date as the actor moves
+	if (USceneComponent* Root = Actor->GetRootComponent())
+	{
+		Entry.TransformHandle = Root->TransformUpdated.AddUObject(this, &USQInteractionSubsystem::HandleRootMoved);
+	}
+}
+
+void USQInteractionSubsystem::UnregisterInteractable(AActor* Actor)
+{
+	FInteractableEntry* Entry = Entries.Find(Actor);
+
+	if (!Entry || --Entry->RefCount > 0)
+	{
+		return;
+	}
+
+	if (USceneComponent* Root = Actor ? Actor->GetRootComponent() : nullptr)
+	{
+		Root->TransformUpdated.Remove(Entry->TransformHandle);
+	}
+
+	if (auto* CellActors = Cells.Find(Entry->Cell))
+	{
+		CellActors->RemoveSwap(Actor);
+
+		if (CellActors->Num() == 0)
+		{
+			Cells.Remove(Entry->Cell);
+		}
+	}
+
+	Entries.Remove(Actor);
+}
+
+void USQInteractionSubsystem::HandleRootMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	AActor* Actor = UpdatedComponent ? UpdatedComponent->GetOwner() : nullptr;
+	FInteractableEntry* Entry = Entries.Find(Actor);
+
+	if (!Entry)
+	{
+		return;
+	}
+
+	// only touch the grid when the actor crosses into another cell
+	const FIntPoint NewCell = GetCell(UpdatedComponent->GetComponentLocation());
+
+	if (NewCell == Entry->Cell)
+	{
+		return;
+	}
+
+	if (auto* CellActors = Cells.Find(Entry->Cell))
+	{
+		CellActors->RemoveSwap(Actor);
+
+		if (CellActors->Num() == 0)
+		{
+			Cells.Remove(Entry->Cell);
+		}
+	}
+
+	Entry->Cell = NewCell;
+	Cells.FindOrAdd(NewCell).Add(Actor);
+}
+
+// ============================================================
+// Queries
+// ============================================================
+
+FIntPoint USQInteractionSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+}
+
+AActor* USQInteractionSubsystem::FindInteractable(const FVector& ViewLocation, const FVector& ViewDirection, float MaxDistance, float MinDot, const AActor* IgnoreActor) const
+{
+	if (Cells.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	const FIntPoint MinCell = GetCell(ViewLocation - FVector(MaxDistance));
+	const FIntPoint MaxCell = GetCell(ViewLocation + FVector(MaxDistance));
+	const float MaxDistanceSquared = FMath::Square(MaxDistance);
+
+	AActor* BestActor = nullptr;
+	float BestDot = MinDot;
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			const auto* CellActors = Cells.Find(FIntPoint(X, Y));
+
+			if (!CellActors)
+			{
+				continue;
+			}
+
+			for (const TWeakObjectPtr<AActor>& WeakActor : *CellActors)
+			{
+				AActor* Actor = WeakActor.Get();
+
+				if (!IsValid(Actor) || Actor == IgnoreActor || Actor->IsHidden())
+				{
+					continue;
+				}
+
+				const FVector ToActor = Actor->GetActorLocation() - ViewLocation;
+				const float DistanceSquared = ToActor.SizeSquared();
+
+				if (DistanceSquared > MaxDistanceSquared || DistanceSquared < UE_KINDA_SMALL_NUMBER)
+				{
+					continue;
+				}
+
+				// prefer whatever is closest to the center of the view
+				const float Dot = FVector::DotProduct(ToActor * FMath::InvSqrt(DistanceSquared), ViewDirection);
+
+				if (Dot > BestDot)
+				{
+					BestDot = Dot;
+					BestActor = Actor;
+				}
+			}
+		}
+	}
+
+	return BestActor;
+}
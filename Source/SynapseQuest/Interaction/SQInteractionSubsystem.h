@@ -0,0 +1,108 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "SQInteractionSubsystem.generated.h"
+
+
+/**
+ * @brief USQInteractionSubsystem indexes every interactable actor in the
+ * world in a coarse XY grid so characters can find what they're looking at
+ * without running physics queries.
+ *
+ * Actors are registered by their USQInteractableComponent or
+ * USQDialogueComponent. The subsystem listens to the root component's
+ * transform updates, so moving actors only touch the grid when they
+ * cross into a new cell.
+ */
+UCLASS()
+class SYNAPSEQUEST_API USQInteractionSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	// ============================================================
+	// UWorldSubsystem Interface
+	// ============================================================
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	virtual void Deinitialize() override;
+
+	// ============================================================
+	// Registration
+	// ============================================================
+
+	/**
+	 * @brief Adds an actor to the index. Registrations are reference
+	 * counted, so an actor with several interaction components is
+	 * only removed once every one of them unregisters.
+	 */
+	void RegisterInteractable(AActor* Actor);
+
+	/**
+	 * @brief Releases one registration of an actor.
+	 */
+	void UnregisterInteractable(AActor* Actor);
+
+	// ============================================================
+	// Queries
+	// ============================================================
+
+	/**
+	 * @brief Finds the interactable closest to the center of a view cone.
+	 * @param ViewLocation Apex of the view cone.
+	 * @param ViewDirection Normalized view direction.
+	 * @param MaxDistance Max distance from the view location.
+	 * @param MinDot Min dot product between the view direction and the direction to the actor.
+	 * @param IgnoreActor Actor to skip, usually the one looking.
+	 * @return The best interactable, or nullptr if none is in the cone.
+	 */
+	AActor* FindInteractable(const FVector& ViewLocation, const FVector& ViewDirection, float MaxDistance, float MinDot, const AActor* IgnoreActor) const;
+
+	/**
+	 * @brief Returns the number of indexed actors.
+	 */
+	int32 GetNumInteractables() const { return Entries.Num(); }
+
+protected:
+
+	/** An indexed actor */
+	struct FInteractableEntry
+	{
+		/** Indexed actor */
+		TWeakObjectPtr<AActor> Actor;
+
+		/** Grid cell the actor is binned in */
+		FIntPoint Cell = FIntPoint::ZeroValue;
+
+		/** Number of components that registered the actor */
+		int32 RefCount = 0;
+
+		/** Handle for the root component transform delegate */
+		FDelegateHandle TransformHandle;
+	};
+
+	/**
+	 * @brief Returns the grid cell containing a location.
+	 */
+	FIntPoint GetCell(const FVector& Location) const;
+
+	/**
+	 * @brief Rebins an actor when its root component moves.
+	 */
+	void HandleRootMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	/** Size of the grid cells */
+	float CellSize = 1000.0f;
+
+	/** Indexed actors */
+	TMap<TObjectKey<AActor>, FInteractableEntry> Entries;
+
+	/** Actors binned by grid cell */
+	TMap<FIntPoint, TArray<TWeakObjectPtr<AActor>, TInlineAllocator<4>>> Cells;
+};
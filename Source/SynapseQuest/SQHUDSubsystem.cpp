@@ -0,0 +1,76 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "SQHUDSubsystem.h"
+#include "SQHUDWidget.h"
+#include "Engine/World.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("HUD Changes"), STAT_SQHUD_Changes, STATGROUP_SQHUD);
+DECLARE_DWORD_COUNTER_STAT(TEXT("HUD Flushes"), STAT_SQHUD_Flushes, STATGROUP_SQHUD);
+
+
+// ============================================================
+// UTickableWorldSubsystem Interface
+// ============================================================
+
+bool USQHUDSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USQHUDSubsystem::Tick(float DeltaTime)
+{
+	if (DirtyWidgets.Num() == 0)
+	{
+		return;
+	}
+
+	const double Now = GetWorld()->GetRealTimeSeconds();
+
+	// iterate backwards so flushed widgets can be swapped out
+	for (int32 Index = DirtyWidgets.Num() - 1; Index >= 0; --Index)
+	{
+		USQHUDWidget* Widget = DirtyWidgets[Index].Get();
+
+		if (!Widget)
+		{
+			DirtyWidgets.RemoveAtSwap(Index, EAllowShrinking::No);
+			continue;
+		}
+
+		// rate capped widgets stay queued until their interval is up
+		if (!Widget->CanFlushHUD(Now))
+		{
+			continue;
+		}
+
+		DirtyWidgets.RemoveAtSwap(Index, EAllowShrinking::No);
+		Widget->FlushHUD();
+
+		INC_DWORD_STAT(STAT_SQHUD_Flushes);
+	}
+}
+
+TStatId USQHUDSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USQHUDSubsystem, STATGROUP_Tickables);
+}
+
+// ============================================================
+// HUD Updates
+// ============================================================
+
+void USQHUDSubsystem::QueueFlush(USQHUDWidget* Widget)
+{
+	DirtyWidgets.Add(Widget);
+}
+
+void USQHUDSubsystem::CountChange()
+{
+	INC_DWORD_STAT(STAT_SQHUD_Changes);
+}
+
+USQHUDSubsystem* USQHUDSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<USQHUDSubsystem>() : nullptr;
+}
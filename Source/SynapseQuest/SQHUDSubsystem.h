@@ -0,0 +1,63 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Stats/Stats.h"
+#include "SQHUDSubsystem.generated.h"
+
+DECLARE_STATS_GROUP(TEXT("SQHUD"), STATGROUP_SQHUD, STATCAT_Advanced);
+
+class USQHUDWidget;
+
+/**
+ * @brief USQHUDSubsystem flushes dirty HUD widgets once per frame.
+ *
+ * Ticks after the world has ticked, so every gameplay change made during the
+ * frame is pushed to Blueprint in a single update per widget. Keeps ticking
+ * while the game is paused so the HUD never shows stale values.
+ */
+UCLASS()
+class SYNAPSEQUEST_API USQHUDSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	// ============================================================
+	// UTickableWorldSubsystem Interface
+	// ============================================================
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	virtual bool IsTickableWhenPaused() const override { return true; }
+
+	// ============================================================
+	// HUD Updates
+	// ============================================================
+
+	/**
+	 * @brief Queues a dirty widget for the next flush.
+	 */
+	void QueueFlush(USQHUDWidget* Widget);
+
+	/**
+	 * @brief Counts a HUD change in STATGROUP_SQHUD.
+	 */
+	static void CountChange();
+
+	/**
+	 * @brief Returns the HUD subsystem for the passed world context object.
+	 */
+	static USQHUDSubsystem* Get(const UObject* WorldContextObject);
+
+protected:
+
+	/** Widgets waiting for a flush */
+	TArray<TWeakObjectPtr<USQHUDWidget>> DirtyWidgets;
+};
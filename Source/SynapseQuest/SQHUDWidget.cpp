@@ -0,0 +1,40 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "SQHUDWidget.h"
+#include "SQHUDSubsystem.h"
+#include "Engine/World.h"
+
+// ============================================================
+// HUD Updates
+// ============================================================
+
+void USQHUDWidget::MarkHUDDirty()
+{
+	USQHUDSubsystem::CountChange();
+
+	if (bHUDDirty)
+	{
+		return;
+	}
+
+	// without a HUD subsystem, e.g. in an editor preview, update right away
+	if (USQHUDSubsystem* HUD = USQHUDSubsystem::Get(this))
+	{
+		bHUDDirty = true;
+		HUD->QueueFlush(this);
+	} else {
+		FlushHUD();
+	}
+}
+
+void USQHUDWidget::FlushHUD()
+{
+	bHUDDirty = false;
+
+	if (const UWorld* World = GetWorld())
+	{
+		LastHUDFlushTime = World->GetRealTimeSeconds();
+	}
+
+	NativeFlushHUD();
+}
@@ -0,0 +1,61 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "SQHUDWidget.generated.h"
+
+/**
+ * @brief Base class for HUD widgets that coalesce their updates.
+ *
+ * Gameplay changes are stored natively and the widget is marked dirty.
+ * The HUD subsystem flushes each dirty widget once at the end of the frame,
+ * or less often if MinUpdateInterval is set, so Blueprint and Slate only see
+ * the latest state no matter how many changes happened in between.
+ */
+UCLASS(abstract)
+class SYNAPSEQUEST_API USQHUDWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+public:
+
+	// ============================================================
+	// HUD Updates
+	// ============================================================
+
+	/**
+	 * @brief Queues the widget for the next HUD flush.
+	 */
+	void MarkHUDDirty();
+
+	/**
+	 * @brief Pushes the pending changes to Blueprint right away.
+	 */
+	void FlushHUD();
+
+	/**
+	 * @brief Returns true if enough time has passed since the last flush.
+	 */
+	bool CanFlushHUD(double RealTime) const { return RealTime - LastHUDFlushTime >= MinUpdateInterval; }
+
+protected:
+
+	/**
+	 * @brief Pushes the pending changes to Blueprint. Called at most once per HUD flush.
+	 */
+	virtual void NativeFlushHUD() {}
+
+	/** Min time between HUD flushes. Zero flushes once per frame */
+	UPROPERTY(EditAnywhere, Category="HUD", meta = (ClampMin = 0, ClampMax = 1, Units = "s"))
+	float MinUpdateInterval = 0.0f;
+
+private:
+
+	/** True while the widget is queued for a flush */
+	bool bHUDDirty = false;
+
+	/** Real time of the last flush */
+	double LastHUDFlushTime = -UE_BIG_NUMBER;
+};
@@ -0,0 +1,294 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "SQTraceBatchSubsystem.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Use Traces"), STAT_SQTraces_Use, STATGROUP_SQTraces);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Player Aim Traces"), STAT_SQTraces_PlayerAim, STATGROUP_SQTraces);
+DECLARE_DWORD_COUNTER_STAT(TEXT("NPC Aim Traces"), STAT_SQTraces_NPCAim, STATGROUP_SQTraces);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Light Exposure Traces"), STAT_SQTraces_LightExposure, STATGROUP_SQTraces);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Other Traces"), STAT_SQTraces_Other, STATGROUP_SQTraces);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Batched Traces"), STAT_SQTraces_Batched, STATGROUP_SQTraces);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Immediate Traces"), STAT_SQTraces_Immediate, STATGROUP_SQTraces);
+
+
+// ============================================================
+// FSQTraceBatchTickFunction
+// ============================================================
+
+void FSQTraceBatchTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Owner)
+	{
+		Owner->FlushBatch();
+	}
+}
+
+FString FSQTraceBatchTickFunction::DiagnosticMessage()
+{
+	return TEXT("FSQTraceBatchTickFunction");
+}
+
+FName FSQTraceBatchTickFunction::DiagnosticContext(bool bDetailed)
+{
+	return FName(TEXT("SQTraceBatch"));
+}
+
+// ============================================================
+// UWorldSubsystem Interface
+// ============================================================
+
+bool USQTraceBatchSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer))
+	{
+		return false;
+	}
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && (World->WorldType == EWorldType::Game || World->WorldType == EWorldType::PIE);
+}
+
+void USQTraceBatchSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	TraceDelegate.BindUObject(this, &USQTraceBatchSubsystem::HandleTraceCompleted);
+
+	// flush once gameplay has had a chance to queue traces, so the batch overlaps with physics
+	BatchTickFunction.Owner = this;
+	BatchTickFunction.bCanEverTick = true;
+	BatchTickFunction.bStartWithTickEnabled = true;
+	BatchTickFunction.TickGroup = TG_StartPhysics;
+	BatchTickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void USQTraceBatchSubsystem::Deinitialize()
+{
+	if (BatchTickFunction.IsTickFunctionRegistered())
+	{
+		BatchTickFunction.UnRegisterTickFunction();
+	}
+
+	BatchTickFunction.Owner = nullptr;
+
+	// results still in flight find no continuation and get dropped
+	QueuedTraces.Reset();
+	Continuations.Reset();
+
+	Super::Deinitialize();
+}
+
+// ============================================================
+// Traces
+// ============================================================
+
+USQTraceBatchSubsystem* USQTraceBatchSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<USQTraceBatchSubsystem>() : nullptr;
+}
+
+uint32 USQTraceBatchSubsystem::SubmitTrace(const FSQTraceRequest& Request, FSQTraceContinuation&& Continuation)
+{
+	// 0 is reserved for "no trace"
+	if (++LastTraceId == 0)
+	{
+		++LastTraceId;
+	}
+
+	QueuedTraces.Add({ LastTraceId, Request });
+	Continuations.Add(LastTraceId, MoveTemp(Continuation));
+
+	CountTrace(Request.Source, false);
+
+	return LastTraceId;
+}
+
+void USQTraceBatchSubsystem::CancelTrace(uint32 TraceId)
+{
+	// queued traces without a continuation are skipped when the batch is flushed
+	Continuations.Remove(TraceId);
+}
+
+bool USQTraceBatchSubsystem::TraceImmediate(const FSQTraceRequest& Request, TArray<FHitResult>& OutHits) const
+{
+	CountTrace(Request.Source, true);
+
+	OutHits.Reset();
+
+	UWorld* World = GetWorld();
+	const bool bByObjectType = Request.ObjectQueryParams.IsValid();
+	const bool bLine = Request.Shape.IsLine();
+
+	switch (Request.Type)
+	{
+	case EAsyncTraceType::Test:
+	{
+		bool bBlocked = false;
+
+		if (bByObjectType)
+		{
+			if (bLine)
+			{
+				bBlocked = World->LineTraceTestByObjectType(Request.Start, Request.End, Request.ObjectQueryParams, Request.QueryParams);
+			} else {
+				bBlocked = World->SweepTestByObjectType(Request.Start, Request.End, Request.Rotation, Request.ObjectQueryParams, Request.Shape, Request.QueryParams);
+			}
+		} else {
+			if (bLine)
+			{
+				bBlocked = World->LineTraceTestByChannel(Request.Start, Request.End, Request.Channel, Request.QueryParams);
+			} else {
+				bBlocked = World->SweepTestByChannel(Request.Start, Request.End, Request.Rotation, Request.Channel, Request.Shape, Request.QueryParams);
+			}
+		}
+
+		// match the async trace interface, which reports a test hit as a single blocking hit
+		if (bBlocked)
+		{
+			FHitResult& Hit = OutHits.AddDefaulted_GetRef();
+			Hit.bBlockingHit = true;
+		}
+
+		return bBlocked;
+	}
+
+	case EAsyncTraceType::Single:
+	{
+		FHitResult& Hit = OutHits.AddDefaulted_GetRef();
+
+		if (bByObjectType)
+		{
+			if (bLine)
+			{
+				World->LineTraceSingleByObjectType(Hit, Request.Start, Request.End, Request.ObjectQueryParams, Request.QueryParams);
+			} else {
+				World->SweepSingleByObjectType(Hit, Request.Start, Request.End, Request.Rotation, Request.ObjectQueryParams, Request.Shape, Request.QueryParams);
+			}
+		} else {
+			if (bLine)
+			{
+				World->LineTraceSingleByChannel(Hit, Request.Start, Request.End, Request.Channel, Request.QueryParams);
+			} else {
+				World->SweepSingleByChannel(Hit, Request.Start, Request.End, Request.Rotation, Request.Channel, Request.Shape, Request.QueryParams);
+			}
+		}
+
+		return Hit.bBlockingHit;
+	}
+
+	case EAsyncTraceType::Multi:
+	{
+		if (bByObjectType)
+		{
+			if (bLine)
+			{
+				World->LineTraceMultiByObjectType(OutHits, Request.Start, Request.End, Request.ObjectQueryParams, Request.QueryParams);
+			} else {
+				World->SweepMultiByObjectType(OutHits, Request.Start, Request.End, Request.Rotation, Request.ObjectQueryParams, Request.Shape, Request.QueryParams);
+			}
+		} else {
+			if (bLine)
+			{
+				World->LineTraceMultiByChannel(OutHits, Request.Start, Request.End, Request.Channel, Request.QueryParams);
+			} else {
+				World->SweepMultiByChannel(OutHits, Request.Start, Request.End, Request.Rotation, Request.Channel, Request.Shape, Request.QueryParams);
+			}
+		}
+
+		return OutHits.ContainsByPredicate([](const FHitResult& Hit) { return Hit.bBlockingHit; });
+	}
+	}
+
+	return false;
+}
+
+void USQTraceBatchSubsystem::FlushBatch()
+{
+	if (QueuedTraces.Num() == 0)
+	{
+		return;
+	}
+
+	UWorld* World = GetWorld();
+
+	for (const FQueuedTrace& Queued : QueuedTraces)
+	{
+		// skip traces canceled before the batch went out
+		if (!Continuations.Contains(Queued.TraceId))
+		{
+			continue;
+		}
+
+		const FSQTraceRequest& Request = Queued.Request;
+
+		if (Request.ObjectQueryParams.IsValid())
+		{
+			if (Request.Shape.IsLine())
+			{
+				World->AsyncLineTraceByObjectType(Request.Type, Request.Start, Request.End, Request.ObjectQueryParams, Request.QueryParams, &TraceDelegate, Queued.TraceId);
+			} else {
+				World->AsyncSweepByObjectType(Request.Type, Request.Start, Request.End, Request.Rotation, Request.ObjectQueryParams, Request.Shape, Request.QueryParams, &TraceDelegate, Queued.TraceId);
+			}
+
+		} else {
+
+			if (Request.Shape.IsLine())
+			{
+				World->AsyncLineTraceByChannel(Request.Type, Request.Start, Request.End, Request.Channel, Request.QueryParams, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate, Queued.TraceId);
+			} else {
+				World->AsyncSweepByChannel(Request.Type, Request.Start, Request.End, Request.Rotation, Request.Channel, Request.Shape, Request.QueryParams, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate, Queued.TraceId);
+			}
+		}
+	}
+
+	QueuedTraces.Reset();
+}
+
+void USQTraceBatchSubsystem::HandleTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	// canceled traces have no continuation left
+	FSQTraceContinuation Continuation;
+
+	if (!Continuations.RemoveAndCopyValue(TraceDatum.UserData, Continuation))
+	{
+		return;
+	}
+
+	Continuation(TraceDatum.OutHits);
+}
+
+void USQTraceBatchSubsystem::CountTrace(ESQTraceSource Source, bool bImmediate)
+{
+	switch (Source)
+	{
+	case ESQTraceSource::Use:
+		INC_DWORD_STAT(STAT_SQTraces_Use);
+		break;
+
+	case ESQTraceSource::PlayerAim:
+		INC_DWORD_STAT(STAT_SQTraces_PlayerAim);
+		break;
+
+	case ESQTraceSource::NPCAim:
+		INC_DWORD_STAT(STAT_SQTraces_NPCAim);
+		break;
+
+	case ESQTraceSource::LightExposure:
+		INC_DWORD_STAT(STAT_SQTraces_LightExposure);
+		break;
+
+	default:
+		INC_DWORD_STAT(STAT_SQTraces_Other);
+		break;
+	}
+
+	if (bImmediate)
+	{
+		INC_DWORD_STAT(STAT_SQTraces_Immediate);
+	} else {
+		INC_DWORD_STAT(STAT_SQTraces_Batched);
+	}
+}
@@ -0,0 +1,202 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineBaseTypes.h"
+#include "WorldCollision.h"
+#include "SQTraceBatchSubsystem.generated.h"
+
+DECLARE_STATS_GROUP(TEXT("SQTraces"), STATGROUP_SQTraces, STATCAT_Advanced);
+
+class USQTraceBatchSubsystem;
+
+/**
+ * @brief Gameplay systems that issue traces. Every trace is counted
+ * against its source in STATGROUP_SQTraces.
+ */
+enum class ESQTraceSource : uint8
+{
+	Use,
+	PlayerAim,
+	NPCAim,
+	LightExposure,
+	Other
+};
+
+/**
+ * @brief Describes a single gameplay trace.
+ *
+ * Traces are line traces unless a non-line Shape is set, and run against
+ * Channel unless ObjectQueryParams has object types to query.
+ */
+struct FSQTraceRequest
+{
+	/** System issuing the trace */
+	ESQTraceSource Source = ESQTraceSource::Other;
+
+	/** Single, multi or test trace */
+	EAsyncTraceType Type = EAsyncTraceType::Single;
+
+	/** Trace start */
+	FVector Start = FVector::ZeroVector;
+
+	/** Trace end */
+	FVector End = FVector::ZeroVector;
+
+	/** Sweep shape. Defaults to a line */
+	FCollisionShape Shape;
+
+	/** Sweep rotation */
+	FQuat Rotation = FQuat::Identity;
+
+	/** Channel traced against when no object types are set */
+	ECollisionChannel Channel = ECC_Visibility;
+
+	/** Object types to trace against instead of a channel */
+	FCollisionObjectQueryParams ObjectQueryParams;
+
+	/** Query params, including ignored actors */
+	FCollisionQueryParams QueryParams;
+};
+
+/**
+ * @brief Called with the results of a batched trace. Test traces report a
+ * single blocking hit if anything was in the way.
+ */
+using FSQTraceContinuation = TFunction<void(const TArray<FHitResult>& Hits)>;
+
+/**
+ * @brief Flushes the trace batch at the start of physics.
+ */
+USTRUCT()
+struct FSQTraceBatchTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	/** Subsystem that owns the batch */
+	USQTraceBatchSubsystem* Owner = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+
+	virtual FString DiagnosticMessage() override;
+
+	virtual FName DiagnosticContext(bool bDetailed) override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FSQTraceBatchTickFunction> : public TStructOpsTypeTraitsBase2<FSQTraceBatchTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * @brief USQTraceBatchSubsystem batches gameplay traces so they run in
+ * parallel through the engine's async trace interface instead of one by one
+ * on the game thread.
+ *
+ * Traces submitted during the frame are issued together at the start of
+ * physics and their continuations run once the results come back, usually
+ * on the next frame. Callers that can't wait a frame use TraceImmediate,
+ * which runs the trace synchronously but still counts it against its source.
+ */
+UCLASS()
+class SYNAPSEQUEST_API USQTraceBatchSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	// ============================================================
+	// UWorldSubsystem Interface
+	// ============================================================
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	virtual void Deinitialize() override;
+
+	// ============================================================
+	// Traces
+	// ============================================================
+
+	/**
+	 * @brief Queues a trace for the next batch.
+	 * @param Request The trace to run.
+	 * @param Continuation Called on the game thread with the trace results. Capture weak pointers, the caller may be gone by then.
+	 * @return Id of the trace, used to cancel it. Never 0.
+	 */
+	uint32 SubmitTrace(const FSQTraceRequest& Request, FSQTraceContinuation&& Continuation);
+
+	/**
+	 * @brief Drops a queued or in flight trace without running its continuation.
+	 */
+	void CancelTrace(uint32 TraceId);
+
+	/**
+	 * @brief Returns true if the trace hasn't completed or been canceled yet.
+	 */
+	bool IsTracePending(uint32 TraceId) const { return TraceId != 0 && Continuations.Contains(TraceId); }
+
+	/**
+	 * @brief Runs a trace synchronously for latency critical callers.
+	 * @param Request The trace to run.
+	 * @param OutHits Trace results. Test traces report a single blocking hit if anything was in the way.
+	 * @return True if there was a blocking hit.
+	 */
+	bool TraceImmediate(const FSQTraceRequest& Request, TArray<FHitResult>& OutHits) const;
+
+	/**
+	 * @brief Returns the trace batch subsystem for the passed world context object.
+	 */
+	static USQTraceBatchSubsystem* Get(const UObject* WorldContextObject);
+
+protected:
+
+	friend struct FSQTraceBatchTickFunction;
+
+	/** A trace waiting for the next batch */
+	struct FQueuedTrace
+	{
+		/** Id handed to the caller */
+		uint32 TraceId = 0;
+
+		/** The trace to run */
+		FSQTraceRequest Request;
+	};
+
+	/**
+	 * @brief Issues every queued trace through the async trace interface.
+	 */
+	void FlushBatch();
+
+	/**
+	 * @brief Routes async trace results to their continuation.
+	 */
+	void HandleTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+	/**
+	 * @brief Counts a trace against its source.
+	 */
+	static void CountTrace(ESQTraceSource Source, bool bImmediate);
+
+	/** Tick function that flushes the batch */
+	FSQTraceBatchTickFunction BatchTickFunction;
+
+	/** Delegate shared by every async trace */
+	FTraceDelegate TraceDelegate;
+
+	/** Traces waiting for the next batch */
+	TArray<FQueuedTrace> QueuedTraces;
+
+	/** Continuations for queued and in flight traces, by trace id */
+	TMap<uint32, FSQTraceContinuation> Continuations;
+
+	/** Last trace id handed out */
+	uint32 LastTraceId = 0;
+};
@@ -20,18 +20,23 @@ public class SynapseQuest : ModuleRules
 			"UMG",
 			"Slate",
 			"Synapse",
+			"NetCore",
 		});
 
-		PrivateDependencyModuleNames.AddRange(new string[] { });
+		PrivateDependencyModuleNames.AddRange(new string[] {
+			"Json",
+		});
 
 		PublicIncludePaths.AddRange(new string[] {
 			"SynapseQuest",
 			"SynapseQuest/Dialogue",
 			"SynapseQuest/Dialogue/UI",
+			"SynapseQuest/Interaction",
 			"SynapseQuest/Variant_Horror",
 			"SynapseQuest/Variant_Horror/UI",
 			"SynapseQuest/Variant_Shooter",
 			"SynapseQuest/Variant_Shooter/AI",
+			"SynapseQuest/Variant_Shooter/Benchmark",
 			"SynapseQuest/Variant_Shooter/UI",
 			"SynapseQuest/Variant_Shooter/Weapons"
 		});
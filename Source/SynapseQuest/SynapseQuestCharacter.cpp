@@ -10,6 +10,9 @@
 #include "GameFramework/CharacterMovementComponent.h"
 #include "SynapseQuest.h"
 #include "Kismet/KismetSystemLibrary.h"
+#include "Interaction/SQInteractionSubsystem.h"
+#include "Interaction/SQInteractableComponent.h"
+#include "SQTraceBatchSubsystem.h"
 
 
 ASynapseQuestCharacter::ASynapseQuestCharacter()
@@ -91,42 +94,98 @@ void ASynapseQuestCharacter::LookInput(const FInputActionValue& Value)
 
 }
 
+void ASynapseQuestCharacter::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// only players look for things to use
+	if (IsLocallyControlled() && IsPlayerControlled())
+	{
+		UpdateUseCandidate();
+	}
+}
+
+void ASynapseQuestCharacter::UpdateUseCandidate()
+{
+	AActor* NewCandidate = nullptr;
+
+	if (const USQInteractionSubsystem* Interaction = GetWorld()->GetSubsystem<USQInteractionSubsystem>())
+	{
+		const FVector ViewDirection = GetControlRotation().Vector();
+		const float MinDot = FMath::Cos(FMath::DegreesToRadians(UseConeAngle));
+
+		NewCandidate = Interaction->FindInteractable(GetPawnViewLocation(), ViewDirection, UseDistance, MinDot, this);
+	}
+
+	AActor* OldCandidate = UseCandidate.Get();
+
+	if (NewCandidate != OldCandidate)
+	{
+		UseCandidate = NewCandidate;
+		OnUseCandidateChanged(NewCandidate, OldCandidate);
+	}
+}
+
+void ASynapseQuestCharacter::UseActor(AActor* Other, const FVector& HitLocation)
+{
+	// interactables replace the legacy Blueprint path, so only fall back to it for plain characters
+	if (USQInteractableComponent* Interactable = Other->FindComponentByClass<USQInteractableComponent>())
+	{
+		Interactable->Use(this);
+	}
+	else if (ACharacter* OtherCharacter = Cast<ACharacter>(Other))
+	{
+		OnUseOther(OtherCharacter, HitLocation);
+	}
+}
+
 void ASynapseQuestCharacter::DoUse(const FInputActionValue& Value)
 {
-	const FVector Start = GetPawnViewLocation();
-	const FVector Dir = GetControlRotation().RotateVector(FVector(10000.0f, 0.0f, 0.0f));
-	const FVector End = Start + Dir;
-
-	FCollisionObjectQueryParams QueryParams;
-	QueryParams.AddObjectTypesToQuery(ECC_Pawn); // Example: looking for Pawns, add more as needed
-	QueryParams.AddObjectTypesToQuery(ECC_WorldDynamic);
-
-	const FCollisionShape CollisionShape = FCollisionShape::MakeSphere(10.0f);
-
-	if (TArray<FHitResult> hits;
-		GetWorld()->SweepMultiByObjectType(
-			hits,
-			Start,
-			End,
-			FQuat::Identity,
-			QueryParams,
-			CollisionShape))
+	// use whatever we're looking at
+	if (AActor* Candidate = UseCandidate.Get();
+		IsValid(Candidate))
+	{
+		UseActor(Candidate, Candidate->GetActorLocation());
+		return;
+	}
+
+	USQTraceBatchSubsystem* Traces = USQTraceBatchSubsystem::Get(this);
+
+	if (!Traces)
 	{
-		for (auto& hit : hits)
+		return;
+	}
+
+	// nothing indexed in view, so fall back to a long sweep. A frame of latency on a button press isn't noticeable, so batch it
+	FSQTraceRequest Request;
+	Request.Source = ESQTraceSource::Use;
+	Request.Type = EAsyncTraceType::Multi;
+	Request.Start = GetPawnViewLocation();
+	Request.End = Request.Start + GetControlRotation().RotateVector(FVector(UseFallbackDistance, 0.0f, 0.0f));
+	Request.Shape = FCollisionShape::MakeSphere(10.0f);
+	Request.ObjectQueryParams.AddObjectTypesToQuery(ECC_Pawn); // Example: looking for Pawns, add more as needed
+	Request.ObjectQueryParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+	Request.QueryParams.AddIgnoredActor(this);
+
+	Traces->SubmitTrace(Request, [WeakThis = TWeakObjectPtr<ASynapseQuestCharacter>(this)](const TArray<FHitResult>& Hits)
+	{
+		ASynapseQuestCharacter* This = WeakThis.Get();
+
+		if (!This)
 		{
-			if (hit.GetActor() == this)
-			{
-				continue;
-			}
+			return;
+		}
 
-			if (ACharacter* Other = Cast<ACharacter>(hit.GetActor());
+		for (const FHitResult& Hit : Hits)
+		{
+			if (ACharacter* Other = Cast<ACharacter>(Hit.GetActor());
 				IsValid(Other))
 			{
-				OnUseOther(Other, hit.Location);
+				This->UseActor(Other, Hit.Location);
 				break;
 			}
 		}
-	}
+	});
 }
 
 void ASynapseQuestCharacter::DoAim(float Yaw, float Pitch)
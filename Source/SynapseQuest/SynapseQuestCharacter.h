@@ -52,10 +52,28 @@ protected:
 	/** Use Input Action */
 	UPROPERTY(EditAnywhere, Category ="Input")
 	class UInputAction* UseAction;
+
+	/** Max distance to indexed interactables that can be used */
+	UPROPERTY(EditAnywhere, Category ="Use", meta = (ClampMin = 0, ClampMax = 10000, Units = "cm"))
+	float UseDistance = 1000.0f;
+
+	/** Half angle of the view cone interactables must be in to be used */
+	UPROPERTY(EditAnywhere, Category ="Use", meta = (ClampMin = 0, ClampMax = 90, Units = "Degrees"))
+	float UseConeAngle = 15.0f;
+
+	/** Length of the sweep used when nothing indexed is in view */
+	UPROPERTY(EditAnywhere, Category ="Use", meta = (ClampMin = 0, ClampMax = 100000, Units = "cm"))
+	float UseFallbackDistance = 10000.0f;
+
+	/** Interactable currently being looked at */
+	TWeakObjectPtr<AActor> UseCandidate;
 	
 public:
 	ASynapseQuestCharacter();
 
+	/** Updates the use candidate for locally controlled players */
+	virtual void Tick(float DeltaTime) override;
+
 protected:
 
 	/** Called from Input Actions for movement input */
@@ -86,6 +104,16 @@ protected:
 	UFUNCTION(BlueprintImplementableEvent, Category="Event")
 	void OnUseOther(ACharacter* Other, FVector HitLocation);
 
+	/** Called when the interactable being looked at changes. Use it to highlight the new candidate */
+	UFUNCTION(BlueprintImplementableEvent, Category="Event")
+	void OnUseCandidateChanged(AActor* NewCandidate, AActor* OldCandidate);
+
+	/** Picks the indexed interactable closest to the center of the view */
+	void UpdateUseCandidate();
+
+	/** Uses the passed actor */
+	void UseActor(AActor* Other, const FVector& HitLocation);
+
 protected:
 
 	/** Set up input action bindings */
@@ -100,5 +128,9 @@ public:
 	/** Returns first person camera component **/
 	UCameraComponent* GetFirstPersonCameraComponent() const { return FirstPersonCameraComponent; }
 
+	/** Returns the interactable currently being looked at */
+	UFUNCTION(BlueprintPure, Category="Use")
+	AActor* GetUseCandidate() const { return UseCandidate.Get(); }
+
 };
 
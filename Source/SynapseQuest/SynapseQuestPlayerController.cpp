@@ -6,6 +6,7 @@
 #include "Engine/LocalPlayer.h"
 #include "InputMappingContext.h"
 #include "SynapseQuestCameraManager.h"
+#include "Dialogue/SQDialogueRelayComponent.h"
 #include "Blueprint/UserWidget.h"
 #include "SynapseQuest.h"
 #include "Widgets/Input/SVirtualJoystick.h"
@@ -14,6 +15,9 @@ ASynapseQuestPlayerController::ASynapseQuestPlayerController()
 {
 	// set the player camera manager class
 	PlayerCameraManagerClass = ASynapseQuestCameraManager::StaticClass();
+
+	// create the dialogue relay
+	DialogueRelay = CreateDefaultSubobject<USQDialogueRelayComponent>(TEXT("Dialogue Relay"));
 }
 
 void ASynapseQuestPlayerController::BeginPlay()
@@ -8,16 +8,22 @@
 
 class UInputMappingContext;
 class UUserWidget;
+class USQDialogueRelayComponent;
 
 /**
  *  Simple first person Player Controller
  *  Manages the input mapping context.
  *  Overrides the Player Camera Manager class.
+ *  Relays NPC dialogue in multiplayer.
  */
 UCLASS(abstract, config="Game")
 class SYNAPSEQUEST_API ASynapseQuestPlayerController : public APlayerController
 {
 	GENERATED_BODY()
+
+	/** Relays server-owned NPC dialogue to this player */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	USQDialogueRelayComponent* DialogueRelay;
 	
 public:
 
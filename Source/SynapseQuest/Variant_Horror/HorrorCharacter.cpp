@@ -2,11 +2,13 @@
 
 
 #include "Variant_Horror/HorrorCharacter.h"
+#include "Variant_Horror/HorrorLightExposureSubsystem.h"
 #include "Engine/World.h"
 #include "TimerManager.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Camera/CameraComponent.h"
 #include "Components/SpotLightComponent.h"
+#include "Components/PawnNoiseEmitterComponent.h"
 #include "EnhancedInputComponent.h"
 #include "InputAction.h"
 
@@ -22,26 +24,39 @@ AHorrorCharacter::AHorrorCharacter()
 	SpotLight->AttenuationRadius = 1050.0f;
 	SpotLight->InnerConeAngle = 18.7f;
 	SpotLight->OuterConeAngle = 45.24f;
+
+	// create the noise emitter component
+	PawnNoiseEmitter = CreateDefaultSubobject<UPawnNoiseEmitterComponent>(TEXT("Pawn Noise Emitter"));
 }
 
 void AHorrorCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// initialize sprint meter to max
+	// initialize sprint meter to max. The meter stays idle until we start sprinting
 	SprintMeter = SprintTime;
+	SprintMeterTime = GetWorld()->GetTimeSeconds();
+	SprintMeterRate = 0.0f;
 
 	// Initialize the walk speed
 	GetCharacterMovement()->MaxWalkSpeed = WalkSpeed;
 
-	// start the sprint tick timer
-	GetWorld()->GetTimerManager().SetTimer(SprintTimer, this, &AHorrorCharacter::SprintFixedTick, SprintFixedTickTime, true);
+	// let the horror AI know when the flashlight is on them
+	if (UHorrorLightExposureSubsystem* LightExposure = UHorrorLightExposureSubsystem::Get(this))
+	{
+		LightExposure->RegisterLight(SpotLight);
+	}
 }
 
 void AHorrorCharacter::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
+	if (UHorrorLightExposureSubsystem* LightExposure = UHorrorLightExposureSubsystem::Get(this))
+	{
+		LightExposure->UnregisterLight(SpotLight);
+	}
+
 	// clear the sprint timer
 	GetWorld()->GetTimerManager().ClearTimer(SprintTimer);
 }
@@ -62,6 +77,17 @@ void AHorrorCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCom
 	}
 }
 
+void AHorrorCharacter::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// we only burn stamina while moving faster than walk speed, so watch for that while the button is held
+	if (bSprinting)
+	{
+		UpdateSprintRate();
+	}
+}
+
 void AHorrorCharacter::DoStartSprint()
 {
 	// set the sprinting flag
@@ -77,6 +103,7 @@ void AHorrorCharacter::DoStartSprint()
 		OnSprintStateChanged.Broadcast(true);
 	}
 
+	UpdateSprintRate();
 }
 
 void AHorrorCharacter::DoEndSprint()
@@ -93,37 +120,102 @@ void AHorrorCharacter::DoEndSprint()
 		// call the sprint state changed delegate
 		OnSprintStateChanged.Broadcast(false);
 	}
+
+	UpdateSprintRate();
 }
 
-void AHorrorCharacter::SprintFixedTick()
+bool AHorrorCharacter::IsFlashlightOn() const
 {
-	// are we out of recovery, still have stamina and are moving faster than our walk speed?
+	return SpotLight->IsVisible();
+}
+
+float AHorrorCharacter::GetSprintMeter() const
+{
+	const double Elapsed = GetWorld()->GetTimeSeconds() - SprintMeterTime;
+	return FMath::Clamp(SprintMeter + SprintMeterRate * static_cast<float>(Elapsed), 0.0f, SprintTime);
+}
+
+void AHorrorCharacter::UpdateSprintRate()
+{
+	float NewRate = 0.0f;
+
+	// are we out of recovery, still sprinting and moving faster than our walk speed?
 	if (bSprinting && !bRecovering && GetVelocity().Length() > WalkSpeed)
 	{
+		// burn stamina
+		NewRate = -1.0f;
 
-		// do we still have meter to burn?
-		if (SprintMeter > 0.0f)
-		{
-			// update the sprint meter
-			SprintMeter = FMath::Max(SprintMeter - SprintFixedTickTime, 0.0f);
-
-			// have we run out of stamina?
-			if (SprintMeter <= 0.0f)
-			{
-				// raise the recovering flag
-				bRecovering = true;
-
-				// set the recovering walk speed
-				GetCharacterMovement()->MaxWalkSpeed = RecoveringWalkSpeed;
-			}
-		}
-		
-	} else {
+	} else if (GetSprintMeter() < SprintTime) {
 
 		// recover stamina
-		SprintMeter = FMath::Min(SprintMeter + SprintFixedTickTime, SprintTime);
+		NewRate = 1.0f;
+	}
+
+	if (NewRate != SprintMeterRate)
+	{
+		SetSprintRate(NewRate);
+	}
+}
+
+void AHorrorCharacter::SetSprintRate(float NewRate)
+{
+	// fold the time spent at the old rate into the meter
+	SprintMeter = GetSprintMeter();
+	SprintMeterTime = GetWorld()->GetTimeSeconds();
+	SprintMeterRate = NewRate;
+
+	ScheduleSprintWakeUp();
+}
+
+void AHorrorCharacter::ScheduleSprintWakeUp()
+{
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
 
-		if (SprintMeter >= SprintTime)
+	// idle meters don't need to wake up
+	if (SprintMeterRate == 0.0f || SprintTime <= 0.0f)
+	{
+		TimerManager.ClearTimer(SprintTimer);
+		return;
+	}
+
+	// time until we're exhausted or fully recovered
+	const float Meter = GetSprintMeter();
+	const float ThresholdDelay = SprintMeterRate < 0.0f ? Meter / -SprintMeterRate : (SprintTime - Meter) / SprintMeterRate;
+
+	// time until the meter changes enough to be visible on the UI
+	const float UIDelay = SprintMeterUIStep * SprintTime / FMath::Abs(SprintMeterRate);
+
+	TimerManager.SetTimer(SprintTimer, this, &AHorrorCharacter::SprintWakeUp, FMath::Max(FMath::Min(ThresholdDelay, UIDelay), UE_KINDA_SMALL_NUMBER), false);
+}
+
+void AHorrorCharacter::SprintWakeUp()
+{
+	const float Meter = GetSprintMeter();
+
+	// have we run out of stamina?
+	if (SprintMeterRate < 0.0f && Meter <= 0.0f)
+	{
+		// raise the recovering flag
+		bRecovering = true;
+
+		// set the recovering walk speed
+		GetCharacterMovement()->MaxWalkSpeed = RecoveringWalkSpeed;
+
+		// catching our breath is loud
+		MakeSprintNoise();
+
+		// start recovering
+		SetSprintRate(1.0f);
+		BroadcastSprintMeter();
+		return;
+	}
+
+	// have we fully recovered?
+	if (SprintMeterRate > 0.0f && Meter >= SprintTime)
+	{
+		SetSprintRate(0.0f);
+
+		if (bRecovering)
 		{
 			// lower the recovering flag
 			bRecovering = false;
@@ -135,9 +227,46 @@ void AHorrorCharacter::SprintFixedTick()
 			OnSprintStateChanged.Broadcast(bSprinting);
 		}
 
+		// we may go straight back to sprinting
+		UpdateSprintRate();
+		BroadcastSprintMeter();
+		return;
+	}
+
+	// keep making noise while we sprint
+	if (SprintMeterRate < 0.0f)
+	{
+		MakeSprintNoise();
+	}
+
+	// the meter moved by a visible amount
+	BroadcastSprintMeter();
+	ScheduleSprintWakeUp();
+}
+
+void AHorrorCharacter::BroadcastSprintMeter()
+{
+	const float Percent = SprintTime > 0.0f ? GetSprintMeter() / SprintTime : 0.0f;
+
+	// don't push the same value twice
+	if (Percent == BroadcastSprintPercent)
+	{
+		return;
 	}
 
+	BroadcastSprintPercent = Percent;
+
 	// broadcast the sprint meter updated delegate
-	OnSprintMeterUpdated.Broadcast(SprintMeter / SprintTime);
+	OnSprintMeterUpdated.Broadcast(Percent);
+}
+
+void AHorrorCharacter::MakeSprintNoise()
+{
+	const FVector NoiseLocation = GetActorLocation();
+
+	// report the noise to AI hearing
+	MakeNoise(SprintNoiseLoudness, this, NoiseLocation, SprintNoiseRange, SprintNoiseTag);
 
+	// AI perception replaces the engine's noise handling, so record the noise on the emitter ourselves
+	PawnNoiseEmitter->MakeNoise(this, SprintNoiseLoudness, NoiseLocation);
 }
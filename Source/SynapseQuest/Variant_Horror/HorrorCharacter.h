@@ -8,6 +8,7 @@
 
 class USpotLightComponent;
 class UInputAction;
+class UPawnNoiseEmitterComponent;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FUpdateSprintMeterDelegate, float, Percentage);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FSprintStateChangedDelegate, bool, bSprinting);
@@ -15,6 +16,8 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FSprintStateChangedDelegate, bool, b
 /**
  *  Simple first person horror character
  *  Provides stamina-based sprinting
+ *  Stamina is modeled as a rate plus the meter value at the last state change,
+ *  so it's only re-evaluated when sprinting starts or stops, or when a threshold is reached
  */
 UCLASS(abstract)
 class SYNAPSEQUEST_API AHorrorCharacter : public ASynapseQuestCharacter
@@ -24,6 +27,10 @@ class SYNAPSEQUEST_API AHorrorCharacter : public ASynapseQuestCharacter
 	/** Player light source */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
 	USpotLightComponent* SpotLight;
+
+	/** Records the noises we make so the horror director can react to them */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	UPawnNoiseEmitterComponent* PawnNoiseEmitter;
 	
 protected:
 
@@ -41,17 +48,38 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Walk")
 	float WalkSpeed = 250.0f;
 
-	/** Time interval for sprinting stamina ticks */
-	UPROPERTY(EditAnywhere, Category="Sprint", meta = (ClampMin = 0, ClampMax = 1, Units = "s"))
-	float SprintFixedTickTime = 0.03333f;
+	/** Smallest change in the sprint meter percentage that gets pushed to the UI */
+	UPROPERTY(EditAnywhere, Category="Sprint", meta = (ClampMin = 0.001, ClampMax = 1))
+	float SprintMeterUIStep = 0.02f;
 
-	/** Sprint stamina amount. Maxes at SprintTime */
+	/** Sprint stamina amount at the last state change. Maxes at SprintTime */
 	float SprintMeter = 0.0f;
 
+	/** World time of the last stamina state change */
+	double SprintMeterTime = 0.0;
+
+	/** Stamina change per second since the last state change. Negative while sprinting, zero when idle */
+	float SprintMeterRate = 0.0f;
+
+	/** Sprint meter percentage last pushed to the UI */
+	float BroadcastSprintPercent = -1.0f;
+
 	/** How long we can sprint for, in seconds */
 	UPROPERTY(EditAnywhere, Category="Sprint", meta = (ClampMin = 0, ClampMax = 10, Units = "s"))
 	float SprintTime = 3.0f;
 
+	/** Loudness of the footsteps and breathing made while sprinting */
+	UPROPERTY(EditAnywhere, Category="Sprint", meta = (ClampMin = 0, ClampMax = 1))
+	float SprintNoiseLoudness = 0.6f;
+
+	/** Max range AI can hear sprinting from. Zero means the hearing sense's own range */
+	UPROPERTY(EditAnywhere, Category="Sprint", meta = (ClampMin = 0, ClampMax = 10000, Units = "cm"))
+	float SprintNoiseRange = 1500.0f;
+
+	/** Tag applied to sprinting noises */
+	UPROPERTY(EditAnywhere, Category="Sprint")
+	FName SprintNoiseTag = FName("Sprint");
+
 	/** Walk speed while sprinting */
 	UPROPERTY(EditAnywhere, Category="Sprint", meta = (ClampMin = 0, ClampMax = 10, Units = "cm/s"))
 	float SprintSpeed = 600.0f;
@@ -64,7 +92,7 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Recovery", meta = (ClampMin = 0, ClampMax = 10, Units = "s"))
 	float RecoveryTime = 0.0f;
 
-	/** Sprint tick timer */
+	/** Wakes up the stamina model at the next threshold or visible UI change */
 	FTimerHandle SprintTimer;
 
 public:
@@ -89,6 +117,20 @@ protected:
 	/** Set up input action bindings */
 	virtual void SetupPlayerInputComponent(UInputComponent* InputComponent) override;
 
+public:
+
+	/** Watches the sprint speed threshold while the sprint button is held */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the current sprint stamina amount */
+	float GetSprintMeter() const;
+
+	/** Returns the current sprint stamina as a 0-1 percentage */
+	float GetSprintPercent() const { return SprintTime > 0.0f ? GetSprintMeter() / SprintTime : 0.0f; }
+
+	/** Returns true if the player light is on */
+	bool IsFlashlightOn() const;
+
 protected:
 
 	/** Starts sprinting behavior */
@@ -99,6 +141,21 @@ protected:
 	UFUNCTION(BlueprintCallable, Category="Input")
 	void DoEndSprint();
 
-	/** Called while sprinting at a fixed time interval */
-	void SprintFixedTick();
+	/** Switches the stamina model to the rate matching the current sprint state */
+	void UpdateSprintRate();
+
+	/** Changes the stamina rate, starting from the current meter value */
+	void SetSprintRate(float NewRate);
+
+	/** Schedules the next stamina wake-up, if the meter is changing */
+	void ScheduleSprintWakeUp();
+
+	/** Handles exhaustion, full recovery and UI updates at the scheduled time */
+	void SprintWakeUp();
+
+	/** Pushes the sprint meter to the UI */
+	void BroadcastSprintMeter();
+
+	/** Makes a sprinting noise for AI hearing and the noise emitter */
+	void MakeSprintNoise();
 };
@@ -0,0 +1,172 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Horror/HorrorDirector.h"
+#include "Variant_Horror/HorrorDirectorSubsystem.h"
+#include "Component/SynapseComponent.h"
+#include "Engine/World.h"
+#include "SynapseQuest.h"
+
+AHorrorDirector::AHorrorDirector()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	// create the whisper generator
+	Synapse = CreateDefaultSubobject<USynapseComponent>(TEXT("Synapse"));
+}
+
+void AHorrorDirector::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// whispers are independent of each other, so don't pay for a growing history
+	Synapse->bUseConversationHistory = false;
+	Synapse->OnResponse.AddDynamic(this, &AHorrorDirector::HandleWhisperResponse);
+
+	// start with a full budget
+	TokenBudget = TokensPerMinute;
+	TokenBudgetTime = GetWorld()->GetTimeSeconds();
+
+	if (UHorrorDirectorSubsystem* Director = GetWorld()->GetSubsystem<UHorrorDirectorSubsystem>())
+	{
+		Director->RegisterDirector(this);
+	}
+}
+
+void AHorrorDirector::EndPlay(EEndPlayReason::Type EndPlayReason)
+{
+	if (UHorrorDirectorSubsystem* Director = GetWorld()->GetSubsystem<UHorrorDirectorSubsystem>())
+	{
+		Director->UnregisterDirector(this);
+	}
+
+	// drop any request in flight
+	PendingRequestTime = -1.0;
+	Synapse->CancelAllRequests();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AHorrorDirector::UpdateWhispers(float Stress, const FString& Phase)
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// refill the token budget, capped at a minute's worth
+	TokenBudget = FMath::Min(TokenBudget + static_cast<float>(Now - TokenBudgetTime) * TokensPerMinute / 60.0f, static_cast<float>(TokensPerMinute));
+	TokenBudgetTime = Now;
+
+	// remember the mood for the next request
+	RequestStress = Stress;
+	RequestPhase = Phase;
+
+	// drop whispers that no longer fit the mood
+	ReadyWhispers.RemoveAll([Now, this](const FPrefetchedWhisper& Ready) { return Now - Ready.Time > MaxWhisperAge; });
+
+	// has the request in flight blown the latency budget?
+	if (PendingRequestTime >= 0.0 && Now - PendingRequestTime > MaxWhisperLatency)
+	{
+		UE_LOG(LogSynapseQuest, Log, TEXT("AHorrorDirector: whisper request timed out after %.1fs, backing off for %.0fs"), Now - PendingRequestTime, LatencyBackoff);
+
+		// the tokens were most likely spent anyway, so keep the charge
+		PendingRequestTime = -1.0;
+		BackoffEndTime = Now + LatencyBackoff;
+
+		Synapse->CancelAllRequests();
+	}
+
+	// keep the pre-fetch queue topped up
+	if (ReadyWhispers.Num() < PrefetchCount)
+	{
+		RequestWhisper();
+	}
+}
+
+void AHorrorDirector::Whisper()
+{
+	FString Text;
+
+	// prefer the oldest generated whisper
+	if (ReadyWhispers.Num() > 0)
+	{
+		Text = ReadyWhispers[0].Text;
+		ReadyWhispers.RemoveAt(0);
+
+	} else if (FallbackWhispers.Num() > 0) {
+
+		Text = FallbackWhispers[FMath::RandHelper(FallbackWhispers.Num())];
+	}
+
+	if (!Text.IsEmpty())
+	{
+		OnWhisper.Broadcast(Text);
+	}
+}
+
+void AHorrorDirector::RequestWhisper()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// one request at a time, and none while backing off
+	if (PendingRequestTime >= 0.0 || Now < BackoffEndTime)
+	{
+		return;
+	}
+
+	// can we afford it?
+	const int32 Cost = EstimateTokens(WhisperSystemPrompt) + EstimateTokens(WhisperPrompt) + ResponseTokenReserve;
+
+	if (TokenBudget < Cost)
+	{
+		return;
+	}
+
+	TokenBudget -= Cost;
+	PendingRequestTime = Now;
+
+	TMap<FString, FString> Vars;
+	Vars.Add(TEXT("Stress"), FString::Printf(TEXT("%.2f"), RequestStress));
+	Vars.Add(TEXT("Phase"), RequestPhase);
+
+	Synapse->ChatWithSystem(WhisperSystemPrompt, WhisperPrompt, Vars);
+}
+
+void AHorrorDirector::HandleWhisperResponse(USynapseComponent* Component, const FSynapseResponse& Response)
+{
+	// ignore responses to requests we've given up on
+	if (PendingRequestTime < 0.0)
+	{
+		return;
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const double Latency = Now - PendingRequestTime;
+
+	PendingRequestTime = -1.0;
+
+	if (!Response.IsSuccess())
+	{
+		UE_LOG(LogSynapseQuest, Warning, TEXT("AHorrorDirector: whisper request failed: %s"), *Response.ErrorMessage);
+
+		// don't hammer a failing backend
+		BackoffEndTime = Now + LatencyBackoff;
+		return;
+	}
+
+	// charge the real response length instead of the reserve
+	TokenBudget += ResponseTokenReserve - EstimateTokens(Response.Content);
+
+	FString Text = Response.Content.TrimStartAndEnd().TrimQuotes();
+
+	if (!Text.IsEmpty())
+	{
+		ReadyWhispers.Add({ MoveTemp(Text), Now });
+	}
+
+	UE_LOG(LogSynapseQuest, Verbose, TEXT("AHorrorDirector: whisper ready after %.2fs, %d whispers ready, %.0f tokens left"), Latency, ReadyWhispers.Num(), TokenBudget);
+}
+
+int32 AHorrorDirector::EstimateTokens(const FString& Text)
+{
+	// roughly four characters per token for English text
+	return FMath::DivideAndRoundUp(Text.Len(), 4);
+}
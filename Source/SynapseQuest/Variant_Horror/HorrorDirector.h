@@ -0,0 +1,254 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Synapse.h"
+#include "HorrorDirector.generated.h"
+
+class USynapseComponent;
+class AShooterNPC;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FHorrorWhisperDelegate, const FString&, Whisper);
+
+/**
+ *  Pacing settings for the horror director
+ */
+USTRUCT(BlueprintType)
+struct FHorrorDirectorSettings
+{
+	GENERATED_BODY()
+
+	/** Time between stress evaluations */
+	UPROPERTY(EditAnywhere, Category="Stress", meta = (ClampMin = 0.05, ClampMax = 2, Units = "s"))
+	float EvaluationInterval = 0.25f;
+
+	/** Time it takes the stress level to settle after the signals change */
+	UPROPERTY(EditAnywhere, Category="Stress", meta = (ClampMin = 0.1, ClampMax = 30, Units = "s"))
+	float StressResponseTime = 2.0f;
+
+	/** Stress added by a drained sprint meter */
+	UPROPERTY(EditAnywhere, Category="Stress", meta = (ClampMin = 0, ClampMax = 1))
+	float ExertionWeight = 0.35f;
+
+	/** Stress added by walking around with the flashlight off */
+	UPROPERTY(EditAnywhere, Category="Stress", meta = (ClampMin = 0, ClampMax = 1))
+	float DarknessWeight = 0.15f;
+
+	/** Stress added by the player's noises */
+	UPROPERTY(EditAnywhere, Category="Stress", meta = (ClampMin = 0, ClampMax = 1))
+	float NoiseWeight = 0.3f;
+
+	/** Time it takes a noise to fade from the player's stress */
+	UPROPERTY(EditAnywhere, Category="Stress", meta = (ClampMin = 0.1, ClampMax = 30, Units = "s"))
+	float NoiseMemory = 4.0f;
+
+	/** Stress added by the stalker being close */
+	UPROPERTY(EditAnywhere, Category="Stress", meta = (ClampMin = 0, ClampMax = 1))
+	float ThreatWeight = 0.4f;
+
+	/** Distance the stalker starts adding stress from */
+	UPROPERTY(EditAnywhere, Category="Stress", meta = (ClampMin = 0, ClampMax = 10000, Units = "cm"))
+	float ThreatRadius = 1500.0f;
+
+	/** Min time spent calm before the stalker shows up */
+	UPROPERTY(EditAnywhere, Category="Pacing", meta = (ClampMin = 0, ClampMax = 300, Units = "s"))
+	float CalmDuration = 20.0f;
+
+	/** The stalker only shows up if the player's stress is below this */
+	UPROPERTY(EditAnywhere, Category="Pacing", meta = (ClampMin = 0, ClampMax = 1))
+	float BuildUpStress = 0.3f;
+
+	/** Max time the stalker closes in before the encounter peaks */
+	UPROPERTY(EditAnywhere, Category="Pacing", meta = (ClampMin = 0, ClampMax = 300, Units = "s"))
+	float BuildUpDuration = 45.0f;
+
+	/** Stress that makes the encounter peak early */
+	UPROPERTY(EditAnywhere, Category="Pacing", meta = (ClampMin = 0, ClampMax = 1))
+	float PeakStress = 0.75f;
+
+	/** Time the stalker is allowed to hunt the player at the peak */
+	UPROPERTY(EditAnywhere, Category="Pacing", meta = (ClampMin = 0, ClampMax = 120, Units = "s"))
+	float PeakDuration = 12.0f;
+
+	/** Min time to let the player recover after a peak */
+	UPROPERTY(EditAnywhere, Category="Pacing", meta = (ClampMin = 0, ClampMax = 300, Units = "s"))
+	float RelaxDuration = 20.0f;
+
+	/** Stress the player has to drop below before things calm down */
+	UPROPERTY(EditAnywhere, Category="Pacing", meta = (ClampMin = 0, ClampMax = 1))
+	float RelaxStress = 0.25f;
+
+	/** NPC class used as the stalker. Its StateTree should investigate noises and hunt hostile targets */
+	UPROPERTY(EditAnywhere, Category="Stalker")
+	TSubclassOf<AShooterNPC> StalkerClass;
+
+	/** Team the stalker is assigned to */
+	UPROPERTY(EditAnywhere, Category="Stalker")
+	uint8 StalkerTeam = 1;
+
+	/** Team the player is assigned to */
+	UPROPERTY(EditAnywhere, Category="Stalker")
+	uint8 PlayerTeam = 0;
+
+	/** Min distance from the player the stalker can spawn at */
+	UPROPERTY(EditAnywhere, Category="Stalker", meta = (ClampMin = 0, ClampMax = 10000, Units = "cm"))
+	float MinSpawnDistance = 1500.0f;
+
+	/** Max distance from the player the stalker can spawn at */
+	UPROPERTY(EditAnywhere, Category="Stalker", meta = (ClampMin = 0, ClampMax = 50000, Units = "cm"))
+	float MaxSpawnDistance = 6000.0f;
+
+	/** Time between the noises that lure the stalker towards the player */
+	UPROPERTY(EditAnywhere, Category="Stalker", meta = (ClampMin = 0.5, ClampMax = 60, Units = "s"))
+	float SteerInterval = 6.0f;
+
+	/** Distance from the player the first lure noise is made at. Lures close in on the player as the build up goes on */
+	UPROPERTY(EditAnywhere, Category="Stalker", meta = (ClampMin = 0, ClampMax = 10000, Units = "cm"))
+	float MaxSteerOffset = 1500.0f;
+
+	/** Distance from the player the last lure noise is made at */
+	UPROPERTY(EditAnywhere, Category="Stalker", meta = (ClampMin = 0, ClampMax = 10000, Units = "cm"))
+	float MinSteerOffset = 200.0f;
+
+	/** Tag applied to the lure noises */
+	UPROPERTY(EditAnywhere, Category="Stalker")
+	FName SteerNoiseTag = FName("Director");
+
+	/** The stalker only withdraws once it's out of sight and at least this far from the player */
+	UPROPERTY(EditAnywhere, Category="Stalker", meta = (ClampMin = 0, ClampMax = 10000, Units = "cm"))
+	float WithdrawDistance = 1200.0f;
+};
+
+/**
+ *  Configures the horror director for a level and voices its whispers.
+ *  Pacing and the stalker are run by the horror director subsystem.
+ *  Whispers are generated through a Synapse component under a token and latency budget,
+ *  and pre-fetched so there's always one ready when the director wants to use it.
+ */
+UCLASS()
+class SYNAPSEQUEST_API AHorrorDirector : public AActor
+{
+	GENERATED_BODY()
+
+	/** Generates the whispers */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	USynapseComponent* Synapse;
+
+protected:
+
+	/** Pacing settings */
+	UPROPERTY(EditAnywhere, Category="Director", meta = (ShowOnlyInnerProperties))
+	FHorrorDirectorSettings Settings;
+
+	/** Places the stalker can spawn at. Spawns are picked out of the player's sight */
+	UPROPERTY(EditInstanceOnly, Category="Director")
+	TArray<TObjectPtr<AActor>> StalkerSpawnPoints;
+
+	/** System prompt for whisper generation */
+	UPROPERTY(EditAnywhere, Category="Whispers", meta = (MultiLine = true))
+	FString WhisperSystemPrompt = TEXT("You are the voice in a frightened person's head in a horror game. Reply with a single unsettling whisper of at most twelve words. No quotes, no narration.");
+
+	/** Prompt for each whisper. Use {Stress} and {Phase} as template variables */
+	UPROPERTY(EditAnywhere, Category="Whispers", meta = (MultiLine = true))
+	FString WhisperPrompt = TEXT("The player's stress is {Stress} out of 1 and the encounter is in its {Phase} phase. Whisper to them.");
+
+	/** Number of whispers to keep ready ahead of use */
+	UPROPERTY(EditAnywhere, Category="Whispers", meta = (ClampMin = 0, ClampMax = 8))
+	int32 PrefetchCount = 2;
+
+	/** Max tokens spent on whispers per minute, estimated from prompt and response length */
+	UPROPERTY(EditAnywhere, Category="Whispers", meta = (ClampMin = 0, ClampMax = 100000))
+	int32 TokensPerMinute = 800;
+
+	/** Tokens reserved for each response until its real length is known */
+	UPROPERTY(EditAnywhere, Category="Whispers", meta = (ClampMin = 1, ClampMax = 1000))
+	int32 ResponseTokenReserve = 48;
+
+	/** Requests slower than this are canceled */
+	UPROPERTY(EditAnywhere, Category="Whispers", meta = (ClampMin = 0.5, ClampMax = 60, Units = "s"))
+	float MaxWhisperLatency = 6.0f;
+
+	/** Time to stop requesting whispers after one times out */
+	UPROPERTY(EditAnywhere, Category="Whispers", meta = (ClampMin = 0, ClampMax = 600, Units = "s"))
+	float LatencyBackoff = 30.0f;
+
+	/** Pre-fetched whispers older than this no longer match the mood and are dropped */
+	UPROPERTY(EditAnywhere, Category="Whispers", meta = (ClampMin = 1, ClampMax = 600, Units = "s"))
+	float MaxWhisperAge = 90.0f;
+
+	/** Authored whispers used when no generated one is ready */
+	UPROPERTY(EditAnywhere, Category="Whispers")
+	TArray<FString> FallbackWhispers;
+
+	/** A generated whisper waiting to be used */
+	struct FPrefetchedWhisper
+	{
+		/** Whisper text */
+		FString Text;
+
+		/** World time the whisper arrived */
+		double Time = 0.0;
+	};
+
+	/** Generated whispers ready to be used */
+	TArray<FPrefetchedWhisper> ReadyWhispers;
+
+	/** Tokens left in the budget */
+	float TokenBudget = 0.0f;
+
+	/** World time the token budget was last refilled */
+	double TokenBudgetTime = 0.0;
+
+	/** World time the request in flight was sent, or a negative value if there's none */
+	double PendingRequestTime = -1.0;
+
+	/** World time whisper requests can resume after a timeout */
+	double BackoffEndTime = 0.0;
+
+	/** Stress level sent with the next request */
+	float RequestStress = 0.0f;
+
+	/** Pacing phase sent with the next request */
+	FString RequestPhase;
+
+public:
+
+	/** Called when the director whispers to the player */
+	UPROPERTY(BlueprintAssignable, Category="Whispers")
+	FHorrorWhisperDelegate OnWhisper;
+
+	/** Constructor */
+	AHorrorDirector();
+
+	/** Returns the pacing settings */
+	const FHorrorDirectorSettings& GetSettings() const { return Settings; }
+
+	/** Returns the stalker spawn points */
+	const TArray<TObjectPtr<AActor>>& GetStalkerSpawnPoints() const { return StalkerSpawnPoints; }
+
+	/** Refills the token budget, times out slow requests and tops up the pre-fetched whispers */
+	void UpdateWhispers(float Stress, const FString& Phase);
+
+	/** Whispers to the player with a pre-fetched or authored line. Never waits on a request */
+	void Whisper();
+
+protected:
+
+	/** Gameplay initialization */
+	virtual void BeginPlay() override;
+
+	/** Gameplay cleanup */
+	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
+	/** Sends a whisper request if the budget allows it */
+	void RequestWhisper();
+
+	/** Handles a generated whisper */
+	UFUNCTION()
+	void HandleWhisperResponse(USynapseComponent* Component, const FSynapseResponse& Response);
+
+	/** Estimates the number of tokens in a string */
+	static int32 EstimateTokens(const FString& Text);
+};
@@ -0,0 +1,397 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Horror/HorrorDirectorSubsystem.h"
+#include "Variant_Horror/HorrorDirector.h"
+#include "Variant_Horror/HorrorCharacter.h"
+#include "ShooterNPC.h"
+#include "ShooterTeamSubsystem.h"
+#include "SQTraceBatchSubsystem.h"
+#include "Components/PawnNoiseEmitterComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Perception/AISense_Hearing.h"
+#include "Engine/World.h"
+
+/** Time to wait before retrying a stalker spawn that found no hidden spawn point */
+static constexpr float StalkerSpawnRetryDelay = 2.0f;
+
+bool UHorrorDirectorSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UHorrorDirectorSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UHorrorDirectorSubsystem, STATGROUP_Tickables);
+}
+
+void UHorrorDirectorSubsystem::Tick(float DeltaTime)
+{
+	// nothing to direct without a director in the level
+	AHorrorDirector* CurrentDirector = Director.Get();
+
+	if (!CurrentDirector)
+	{
+		return;
+	}
+
+	// stress changes slowly, so don't evaluate it every frame
+	EvaluationTime += DeltaTime;
+
+	if (EvaluationTime < CurrentDirector->GetSettings().EvaluationInterval)
+	{
+		return;
+	}
+
+	const float Elapsed = EvaluationTime;
+	EvaluationTime = 0.0f;
+
+	AHorrorCharacter* Player = GetPlayer();
+
+	if (!Player)
+	{
+		return;
+	}
+
+	// the stalker's StateTree only hunts hostile actors, so put the player on their own team
+	if (RegisteredPlayer != Player)
+	{
+		if (UShooterTeamSubsystem* Teams = UShooterTeamSubsystem::Get(this))
+		{
+			if (AHorrorCharacter* OldPlayer = RegisteredPlayer.Get())
+			{
+				OldPlayer->OnEndPlay.RemoveDynamic(this, &UHorrorDirectorSubsystem::OnPlayerEndPlay);
+				Teams->UnregisterMember(OldPlayer);
+			}
+
+			Teams->RegisterMember(Player, CurrentDirector->GetSettings().PlayerTeam);
+		}
+
+		// the weak pointer is already gone by the time we'd notice the pawn was destroyed, so unregister as it ends play
+		Player->OnEndPlay.AddUniqueDynamic(this, &UHorrorDirectorSubsystem::OnPlayerEndPlay);
+
+		RegisteredPlayer = Player;
+	}
+
+	UpdateStress(Player, Elapsed);
+	UpdatePacing(Player, Elapsed);
+
+	// keep the whispers for the current mood pre-fetched
+	CurrentDirector->UpdateWhispers(Stress, StaticEnum<EHorrorDirectorPhase>()->GetNameStringByValue(static_cast<int64>(Phase)));
+}
+
+void UHorrorDirectorSubsystem::OnPlayerEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason)
+{
+	if (UShooterTeamSubsystem* Teams = UShooterTeamSubsystem::Get(this))
+	{
+		Teams->UnregisterMember(Actor);
+	}
+
+	if (RegisteredPlayer == Actor)
+	{
+		RegisteredPlayer.Reset();
+	}
+}
+
+void UHorrorDirectorSubsystem::RegisterDirector(AHorrorDirector* InDirector)
+{
+	Director = InDirector;
+
+	Phase = EHorrorDirectorPhase::Calm;
+	PhaseTime = 0.0f;
+	NextSpawnAttemptTime = 0.0f;
+
+	// create the stalker up front so its first appearance doesn't hitch
+	GetOrCreateStalker();
+}
+
+void UHorrorDirectorSubsystem::UnregisterDirector(AHorrorDirector* InDirector)
+{
+	if (Director == InDirector)
+	{
+		Director.Reset();
+	}
+}
+
+AHorrorCharacter* UHorrorDirectorSubsystem::GetPlayer() const
+{
+	const APlayerController* PC = GetWorld()->GetFirstPlayerController();
+	return PC ? Cast<AHorrorCharacter>(PC->GetPawn()) : nullptr;
+}
+
+bool UHorrorDirectorSubsystem::IsStalkerActive() const
+{
+	return IsValid(Stalker) && !Stalker->IsDormant() && !Stalker->IsDead();
+}
+
+void UHorrorDirectorSubsystem::UpdateStress(const AHorrorCharacter* Player, float Elapsed)
+{
+	const FHorrorDirectorSettings& Settings = Director->GetSettings();
+
+	// a drained sprint meter means we've been running
+	const float Exertion = 1.0f - Player->GetSprintPercent();
+
+	// walking around in the dark is unsettling
+	const float Darkness = Player->IsFlashlightOn() ? 0.0f : 1.0f;
+
+	// recent noises fade out over the noise memory
+	float Noise = 0.0f;
+
+	if (const UPawnNoiseEmitterComponent* Emitter = Player->GetPawnNoiseEmitterComponent())
+	{
+		const float Now = GetWorld()->GetTimeSeconds();
+
+		// the emitter keeps noises made by the pawn itself and near it apart, so take the louder of the two
+		for (const bool bSourceWithinNoiseEmitter : { true, false })
+		{
+			const float Age = Now - Emitter->GetLastNoiseTime(bSourceWithinNoiseEmitter);
+			const float Volume = FMath::Clamp(Emitter->GetLastNoiseVolume(bSourceWithinNoiseEmitter), 0.0f, 1.0f);
+
+			Noise = FMath::Max(Noise, Volume * FMath::Exp(-Age / Settings.NoiseMemory));
+		}
+	}
+
+	// a stalker closing in is the scariest thing of all
+	float Threat = 0.0f;
+
+	if (IsStalkerActive() && Settings.ThreatRadius > 0.0f)
+	{
+		Threat = 1.0f - FMath::Clamp(FVector::Dist(Stalker->GetActorLocation(), Player->GetActorLocation()) / Settings.ThreatRadius, 0.0f, 1.0f);
+	}
+
+	const float TargetStress = FMath::Clamp(
+		Exertion * Settings.ExertionWeight +
+		Darkness * Settings.DarknessWeight +
+		Noise * Settings.NoiseWeight +
+		Threat * Settings.ThreatWeight,
+		0.0f, 1.0f);
+
+	// ease towards the target so single spikes don't flip the pacing
+	Stress += (TargetStress - Stress) * (1.0f - FMath::Exp(-Elapsed / Settings.StressResponseTime));
+}
+
+void UHorrorDirectorSubsystem::UpdatePacing(AHorrorCharacter* Player, float Elapsed)
+{
+	const FHorrorDirectorSettings& Settings = Director->GetSettings();
+
+	PhaseTime += Elapsed;
+
+	switch (Phase)
+	{
+	case EHorrorDirectorPhase::Calm:
+
+		// bring in the stalker once the player has settled down
+		if (PhaseTime >= Settings.CalmDuration && PhaseTime >= NextSpawnAttemptTime && Stress < Settings.BuildUpStress)
+		{
+			if (SpawnStalker(Player))
+			{
+				SetPhase(EHorrorDirectorPhase::BuildUp);
+				Director->Whisper();
+
+			} else {
+
+				NextSpawnAttemptTime = PhaseTime + StalkerSpawnRetryDelay;
+			}
+		}
+
+		break;
+
+	case EHorrorDirectorPhase::BuildUp:
+
+		// the player got rid of the stalker
+		if (!IsStalkerActive())
+		{
+			SetPhase(EHorrorDirectorPhase::Relax);
+			break;
+		}
+
+		// has the tension peaked?
+		if (Stress >= Settings.PeakStress || PhaseTime >= Settings.BuildUpDuration)
+		{
+			SetPhase(EHorrorDirectorPhase::Peak);
+			Director->Whisper();
+
+			// send the stalker straight at the player
+			SteerStalker(Player);
+			break;
+		}
+
+		// keep luring the stalker closer
+		SteerTime += Elapsed;
+
+		if (SteerTime >= Settings.SteerInterval)
+		{
+			SteerTime = 0.0f;
+			SteerStalker(Player);
+		}
+
+		break;
+
+	case EHorrorDirectorPhase::Peak:
+
+		// let the stalker hunt for a while
+		if (!IsStalkerActive() || PhaseTime >= Settings.PeakDuration)
+		{
+			SetPhase(EHorrorDirectorPhase::Relax);
+		}
+
+		break;
+
+	case EHorrorDirectorPhase::Relax:
+
+		// send the stalker away as soon as the player can't see it go
+		if (IsStalkerActive() && CanWithdrawStalker(Player))
+		{
+			Stalker->Withdraw();
+		}
+
+		// give the player time to recover before the next encounter
+		if (!IsStalkerActive() && PhaseTime >= Settings.RelaxDuration && Stress < Settings.RelaxStress)
+		{
+			SetPhase(EHorrorDirectorPhase::Calm);
+		}
+
+		break;
+	}
+}
+
+void UHorrorDirectorSubsystem::SetPhase(EHorrorDirectorPhase NewPhase)
+{
+	Phase = NewPhase;
+	PhaseTime = 0.0f;
+	SteerTime = 0.0f;
+	NextSpawnAttemptTime = 0.0f;
+}
+
+bool UHorrorDirectorSubsystem::SpawnStalker(const AHorrorCharacter* Player)
+{
+	AShooterNPC* PooledStalker = GetOrCreateStalker();
+	USQTraceBatchSubsystem* Traces = USQTraceBatchSubsystem::Get(this);
+
+	if (!PooledStalker || !Traces)
+	{
+		return false;
+	}
+
+	const FHorrorDirectorSettings& Settings = Director->GetSettings();
+	const FVector PlayerLocation = Player->GetActorLocation();
+
+	// gather the spawn points in range, closest first
+	TArray<TPair<float, const AActor*>, TInlineAllocator<16>> Candidates;
+
+	for (const AActor* SpawnPoint : Director->GetStalkerSpawnPoints())
+	{
+		if (!IsValid(SpawnPoint))
+		{
+			continue;
+		}
+
+		const float Distance = FVector::Dist(SpawnPoint->GetActorLocation(), PlayerLocation);
+
+		if (Distance >= Settings.MinSpawnDistance && Distance <= Settings.MaxSpawnDistance)
+		{
+			Candidates.Emplace(Distance, SpawnPoint);
+		}
+	}
+
+	Candidates.Sort([](const TPair<float, const AActor*>& A, const TPair<float, const AActor*>& B) { return A.Key < B.Key; });
+
+	// spawn at the closest point the player can't see
+	FSQTraceRequest Request;
+	Request.Type = EAsyncTraceType::Test;
+	Request.Start = Player->GetPawnViewLocation();
+	Request.QueryParams.AddIgnoredActor(Player);
+	Request.QueryParams.AddIgnoredActor(PooledStalker);
+
+	TArray<FHitResult> OutHits;
+
+	for (const TPair<float, const AActor*>& Candidate : Candidates)
+	{
+		Request.End = Candidate.Value->GetActorLocation();
+
+		if (Traces->TraceImmediate(Request, OutHits))
+		{
+			// face the player
+			const FRotator SpawnRotation = FRotator(0.0f, (PlayerLocation - Request.End).Rotation().Yaw, 0.0f);
+
+			PooledStalker->ResetForSpawn(FTransform(SpawnRotation, Request.End));
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void UHorrorDirectorSubsystem::SteerStalker(AHorrorCharacter* Player)
+{
+	const FHorrorDirectorSettings& Settings = Director->GetSettings();
+
+	// lures close in on the player as the build up goes on
+	const float Progress = Phase == EHorrorDirectorPhase::BuildUp && Settings.BuildUpDuration > 0.0f ? FMath::Clamp(PhaseTime / Settings.BuildUpDuration, 0.0f, 1.0f) : 1.0f;
+	const float Offset = FMath::Lerp(Settings.MaxSteerOffset, Settings.MinSteerOffset, Progress);
+
+	const FVector2D Direction = FMath::RandPointInCircle(1.0f).GetSafeNormal();
+	const FVector LureLocation = Player->GetActorLocation() + FVector(Direction * Offset, 0.0f);
+
+	// the stalker only moves on to a new investigate location for a louder stimulus, so each lure is louder than the last
+	UAISense_Hearing::ReportNoiseEvent(GetWorld(), LureLocation, 1.0f + Progress, Player, 0.0f, Settings.SteerNoiseTag);
+}
+
+bool UHorrorDirectorSubsystem::CanWithdrawStalker(const AHorrorCharacter* Player) const
+{
+	const FVector ViewLocation = Player->GetPawnViewLocation();
+	const FVector ToStalker = Stalker->GetActorLocation() - ViewLocation;
+
+	// don't vanish in front of the player
+	if (ToStalker.SizeSquared() < FMath::Square(Director->GetSettings().WithdrawDistance))
+	{
+		return false;
+	}
+
+	return FVector::DotProduct(ToStalker.GetSafeNormal(), Player->GetControlRotation().Vector()) < 0.0f;
+}
+
+AShooterNPC* UHorrorDirectorSubsystem::GetOrCreateStalker()
+{
+	if (IsValid(Stalker))
+	{
+		return Stalker;
+	}
+
+	AHorrorDirector* CurrentDirector = Director.Get();
+
+	if (!CurrentDirector || !CurrentDirector->GetSettings().StalkerClass)
+	{
+		return nullptr;
+	}
+
+	const FTransform SpawnTransform = CurrentDirector->GetActorTransform();
+
+	// defer the spawn so the stalker is flagged as dormant before its controller possesses it
+	Stalker = GetWorld()->SpawnActorDeferred<AShooterNPC>(CurrentDirector->GetSettings().StalkerClass, SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+
+	if (!Stalker)
+	{
+		return nullptr;
+	}
+
+	Stalker->InitPooled();
+	Stalker->SetTeam(CurrentDirector->GetSettings().StalkerTeam);
+	Stalker->FinishSpawning(SpawnTransform);
+
+	// hide it until the director needs it
+	Stalker->EnterDormancy();
+
+	Stalker->OnPawnDeath.AddDynamic(this, &UHorrorDirectorSubsystem::OnStalkerDied);
+
+	return Stalker;
+}
+
+void UHorrorDirectorSubsystem::OnStalkerDied()
+{
+	// back off after the player fends off the stalker
+	if (Phase == EHorrorDirectorPhase::BuildUp || Phase == EHorrorDirectorPhase::Peak)
+	{
+		SetPhase(EHorrorDirectorPhase::Relax);
+	}
+}
@@ -0,0 +1,128 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "HorrorDirectorSubsystem.generated.h"
+
+class AHorrorDirector;
+class AHorrorCharacter;
+class AShooterNPC;
+
+/**
+ *  Pacing phases of a horror encounter
+ */
+UENUM(BlueprintType)
+enum class EHorrorDirectorPhase : uint8
+{
+	Calm,
+	BuildUp,
+	Peak,
+	Relax
+};
+
+/**
+ *  Paces horror encounters around the player's stress level
+ *  Stress is built from the sprint meter, the flashlight, the player's noise emitter and how close the stalker is.
+ *  Once the player has been calm for a while, a stalker NPC is spawned out of sight and lured closer with noises
+ *  its StateTree investigates, until the stress peaks. The stalker then withdraws once the player can't see it.
+ *  Settings come from the Horror Director actor placed in the level. Without one the subsystem does nothing
+ */
+UCLASS()
+class SYNAPSEQUEST_API UHorrorDirectorSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Director actor providing the settings and whispers */
+	TWeakObjectPtr<AHorrorDirector> Director;
+
+	/** Pooled stalker NPC */
+	UPROPERTY()
+	TObjectPtr<AShooterNPC> Stalker;
+
+	/** Player pawn registered with the team subsystem. Unregistered when it ends play */
+	TWeakObjectPtr<AHorrorCharacter> RegisteredPlayer;
+
+	/** Current pacing phase */
+	EHorrorDirectorPhase Phase = EHorrorDirectorPhase::Calm;
+
+	/** Time spent in the current phase */
+	float PhaseTime = 0.0f;
+
+	/** Smoothed player stress, from 0 to 1 */
+	float Stress = 0.0f;
+
+	/** Time accumulated towards the next evaluation */
+	float EvaluationTime = 0.0f;
+
+	/** Time since the stalker was last lured */
+	float SteerTime = 0.0f;
+
+	/** Phase time of the next stalker spawn attempt */
+	float NextSpawnAttemptTime = 0.0f;
+
+public:
+
+	/** Only direct game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Evaluates stress and pacing at the director's interval */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/** Registers the level's director actor and prewarms the stalker */
+	void RegisterDirector(AHorrorDirector* InDirector);
+
+	/** Unregisters the level's director actor */
+	void UnregisterDirector(AHorrorDirector* InDirector);
+
+	/** Returns the player's smoothed stress, from 0 to 1 */
+	UFUNCTION(BlueprintPure, Category="Horror")
+	float GetStress() const { return Stress; }
+
+	/** Returns the current pacing phase */
+	UFUNCTION(BlueprintPure, Category="Horror")
+	EHorrorDirectorPhase GetPhase() const { return Phase; }
+
+protected:
+
+	/** Returns the local player's horror character */
+	AHorrorCharacter* GetPlayer() const;
+
+	/** Returns true if the stalker is alive and out of its pool */
+	bool IsStalkerActive() const;
+
+	/** Blends the player's stress towards the current stress signals */
+	void UpdateStress(const AHorrorCharacter* Player, float Elapsed);
+
+	/** Advances the pacing phase */
+	void UpdatePacing(AHorrorCharacter* Player, float Elapsed);
+
+	/** Switches to a new pacing phase */
+	void SetPhase(EHorrorDirectorPhase NewPhase);
+
+	/** Spawns the stalker at a spawn point out of the player's sight. Returns false if there's none */
+	bool SpawnStalker(const AHorrorCharacter* Player);
+
+	/** Lures the stalker towards the player with a noise, closer as the build up goes on */
+	void SteerStalker(AHorrorCharacter* Player);
+
+	/** Returns true if the stalker can withdraw without the player noticing */
+	bool CanWithdrawStalker(const AHorrorCharacter* Player) const;
+
+	/** Removes the player pawn from the team subsystem while it's still valid, so no stale entry is left behind */
+	UFUNCTION()
+	void OnPlayerEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason);
+
+	/** Returns the pooled stalker, creating it if needed */
+	AShooterNPC* GetOrCreateStalker();
+
+	/** Handles the stalker dying */
+	UFUNCTION()
+	void OnStalkerDied();
+};
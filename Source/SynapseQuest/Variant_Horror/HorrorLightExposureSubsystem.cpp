@@ -0,0 +1,365 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Horror/HorrorLightExposureSubsystem.h"
+#include "SQTraceBatchSubsystem.h"
+#include "Components/SpotLightComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/VectorRegister.h"
+
+DECLARE_CYCLE_STAT(TEXT("Light Exposure Tick"), STAT_HorrorLightExposureTick, STATGROUP_HorrorLight);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Light Receivers"), STAT_HorrorLightReceivers, STATGROUP_HorrorLight);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Lit Receivers"), STAT_HorrorLitReceivers, STATGROUP_HorrorLight);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Occlusion Traces"), STAT_HorrorLightOcclusionTraces, STATGROUP_HorrorLight);
+
+static TAutoConsoleVariable<int32> CVarHorrorLightMaxTracesPerFrame(
+	TEXT("Horror.Light.MaxTracesPerFrame"),
+	4,
+	TEXT("Max number of flashlight occlusion traces sent per frame."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarHorrorLightOcclusionCacheTime(
+	TEXT("Horror.Light.OcclusionCacheTime"),
+	0.25f,
+	TEXT("Seconds a flashlight occlusion result is reused before it's traced again."),
+	ECVF_Default);
+
+bool UHorrorLightExposureSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UHorrorLightExposureSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UHorrorLightExposureSubsystem, STATGROUP_Tickables);
+}
+
+void UHorrorLightExposureSubsystem::Deinitialize()
+{
+	if (USQTraceBatchSubsystem* Traces = USQTraceBatchSubsystem::Get(this))
+	{
+		for (const uint32 TraceId : PendingTraces)
+		{
+			Traces->CancelTrace(TraceId);
+		}
+	}
+
+	Super::Deinitialize();
+}
+
+UHorrorLightExposureSubsystem* UHorrorLightExposureSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UHorrorLightExposureSubsystem>() : nullptr;
+}
+
+void UHorrorLightExposureSubsystem::RegisterLight(USpotLightComponent* Light)
+{
+	if (Light)
+	{
+		Lights.AddUnique(Light);
+	}
+}
+
+void UHorrorLightExposureSubsystem::UnregisterLight(USpotLightComponent* Light)
+{
+	Lights.RemoveSwap(Light);
+}
+
+void UHorrorLightExposureSubsystem::RegisterReceiver(AActor* Receiver)
+{
+	if (!Receiver)
+	{
+		return;
+	}
+
+	if (const int32* Index = ReceiverIndices.Find(Receiver))
+	{
+		++RegistrationCounts[*Index];
+		return;
+	}
+
+	const FVector Location = Receiver->GetActorLocation();
+
+	ReceiverIndices.Add(Receiver, Receivers.Add(Receiver));
+	PositionsX.Add(Location.X);
+	PositionsY.Add(Location.Y);
+	PositionsZ.Add(Location.Z);
+	DistancesSquared.AddZeroed();
+	Projections.AddZeroed();
+	ConeExposures.Add(0.0f);
+	ExposingLights.Add(INDEX_NONE);
+	Exposures.Add(0.0f);
+	Occluded.Add(false);
+	OcclusionTimes.Add(-1.0);
+	PendingTraces.Add(0);
+	RegistrationCounts.Add(1);
+}
+
+void UHorrorLightExposureSubsystem::UnregisterReceiver(AActor* Receiver)
+{
+	const int32* Index = ReceiverIndices.Find(Receiver);
+
+	if (!Index || --RegistrationCounts[*Index] > 0)
+	{
+		return;
+	}
+
+	RemoveReceiverAt(*Index);
+}
+
+float UHorrorLightExposureSubsystem::GetExposure(const AActor* Receiver) const
+{
+	const int32* Index = ReceiverIndices.Find(Receiver);
+	return Index ? Exposures[*Index] : 0.0f;
+}
+
+void UHorrorLightExposureSubsystem::RemoveReceiverAt(int32 Index)
+{
+	// drop the occlusion trace in flight, if any
+	if (PendingTraces[Index] != 0)
+	{
+		if (USQTraceBatchSubsystem* Traces = USQTraceBatchSubsystem::Get(this))
+		{
+			Traces->CancelTrace(PendingTraces[Index]);
+		}
+	}
+
+	ReceiverIndices.Remove(Receivers[Index]);
+
+	Receivers.RemoveAtSwap(Index, EAllowShrinking::No);
+	PositionsX.RemoveAtSwap(Index, EAllowShrinking::No);
+	PositionsY.RemoveAtSwap(Index, EAllowShrinking::No);
+	PositionsZ.RemoveAtSwap(Index, EAllowShrinking::No);
+	DistancesSquared.RemoveAtSwap(Index, EAllowShrinking::No);
+	Projections.RemoveAtSwap(Index, EAllowShrinking::No);
+	ConeExposures.RemoveAtSwap(Index, EAllowShrinking::No);
+	ExposingLights.RemoveAtSwap(Index, EAllowShrinking::No);
+	Exposures.RemoveAtSwap(Index, EAllowShrinking::No);
+	Occluded.RemoveAtSwap(Index, EAllowShrinking::No);
+	OcclusionTimes.RemoveAtSwap(Index, EAllowShrinking::No);
+	PendingTraces.RemoveAtSwap(Index, EAllowShrinking::No);
+	RegistrationCounts.RemoveAtSwap(Index, EAllowShrinking::No);
+
+	// the last receiver was moved into the freed slot
+	if (Receivers.IsValidIndex(Index))
+	{
+		ReceiverIndices.Add(Receivers[Index], Index);
+	}
+}
+
+void UHorrorLightExposureSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_HorrorLightExposureTick);
+
+	UpdatePositions();
+	UpdateConeExposures();
+	UpdateOcclusion();
+
+	// only trust the cone exposure once a trace has confirmed the light reaches the receiver
+	int32 NumLit = 0;
+
+	for (int32 Index = 0; Index < Receivers.Num(); ++Index)
+	{
+		const bool bLit = ExposingLights[Index] != INDEX_NONE && OcclusionTimes[Index] >= 0.0 && !Occluded[Index];
+
+		Exposures[Index] = bLit ? ConeExposures[Index] : 0.0f;
+		NumLit += bLit;
+	}
+
+	SET_DWORD_STAT(STAT_HorrorLightReceivers, Receivers.Num());
+	SET_DWORD_STAT(STAT_HorrorLitReceivers, NumLit);
+}
+
+void UHorrorLightExposureSubsystem::UpdatePositions()
+{
+	// iterate backwards so destroyed receivers can be swapped out
+	for (int32 Index = Receivers.Num() - 1; Index >= 0; --Index)
+	{
+		const AActor* Receiver = Receivers[Index].Get();
+
+		if (!IsValid(Receiver))
+		{
+			RemoveReceiverAt(Index);
+			continue;
+		}
+
+		const FVector Location = Receiver->GetActorLocation();
+
+		PositionsX[Index] = Location.X;
+		PositionsY[Index] = Location.Y;
+		PositionsZ[Index] = Location.Z;
+	}
+
+	Lights.RemoveAllSwap([](const TWeakObjectPtr<USpotLightComponent>& Light) { return !Light.IsValid(); });
+}
+
+void UHorrorLightExposureSubsystem::UpdateConeExposures()
+{
+	const int32 NumReceivers = Receivers.Num();
+
+	for (int32 Index = 0; Index < NumReceivers; ++Index)
+	{
+		ConeExposures[Index] = 0.0f;
+		ExposingLights[Index] = INDEX_NONE;
+	}
+
+	const float* X = PositionsX.GetData();
+	const float* Y = PositionsY.GetData();
+	const float* Z = PositionsZ.GetData();
+	float* OutDistances = DistancesSquared.GetData();
+	float* OutProjections = Projections.GetData();
+
+	for (int32 LightIndex = 0; LightIndex < Lights.Num(); ++LightIndex)
+	{
+		const USpotLightComponent* Light = Lights[LightIndex].Get();
+
+		// skip lights that are switched off
+		if (!Light->IsVisible() || Light->Intensity <= 0.0f || Light->AttenuationRadius <= 0.0f)
+		{
+			continue;
+		}
+
+		const FVector3f Origin(Light->GetComponentLocation());
+		const FVector3f Direction(Light->GetForwardVector());
+
+		const float Radius = Light->AttenuationRadius;
+		const float CosOuter = FMath::Cos(FMath::DegreesToRadians(Light->OuterConeAngle));
+		const float CosInner = FMath::Cos(FMath::DegreesToRadians(FMath::Min(Light->InnerConeAngle, Light->OuterConeAngle)));
+
+		// get the squared distance to the light and the distance along its axis, four receivers at a time
+		const VectorRegister4Float OriginX = VectorSetFloat1(Origin.X);
+		const VectorRegister4Float OriginY = VectorSetFloat1(Origin.Y);
+		const VectorRegister4Float OriginZ = VectorSetFloat1(Origin.Z);
+		const VectorRegister4Float DirectionX = VectorSetFloat1(Direction.X);
+		const VectorRegister4Float DirectionY = VectorSetFloat1(Direction.Y);
+		const VectorRegister4Float DirectionZ = VectorSetFloat1(Direction.Z);
+
+		int32 Index = 0;
+
+		for (; Index + 4 <= NumReceivers; Index += 4)
+		{
+			const VectorRegister4Float DeltaX = VectorSubtract(VectorLoad(X + Index), OriginX);
+			const VectorRegister4Float DeltaY = VectorSubtract(VectorLoad(Y + Index), OriginY);
+			const VectorRegister4Float DeltaZ = VectorSubtract(VectorLoad(Z + Index), OriginZ);
+
+			VectorStore(VectorMultiplyAdd(DeltaX, DeltaX, VectorMultiplyAdd(DeltaY, DeltaY, VectorMultiply(DeltaZ, DeltaZ))), OutDistances + Index);
+			VectorStore(VectorMultiplyAdd(DeltaX, DirectionX, VectorMultiplyAdd(DeltaY, DirectionY, VectorMultiply(DeltaZ, DirectionZ))), OutProjections + Index);
+		}
+
+		for (; Index < NumReceivers; ++Index)
+		{
+			const FVector3f Delta = FVector3f(X[Index], Y[Index], Z[Index]) - Origin;
+
+			OutDistances[Index] = Delta.SizeSquared();
+			OutProjections[Index] = Delta | Direction;
+		}
+
+		// only the few receivers inside the cone pay for the falloff
+		for (Index = 0; Index < NumReceivers; ++Index)
+		{
+			const float DistanceSquared = OutDistances[Index];
+			const float Projection = OutProjections[Index];
+
+			// behind the light, out of range, or outside the outer cone
+			if (Projection <= 0.0f || DistanceSquared > Radius * Radius || Projection * Projection < CosOuter * CosOuter * DistanceSquared)
+			{
+				continue;
+			}
+
+			const float Distance = FMath::Sqrt(DistanceSquared);
+			const float CosAngle = Distance > UE_KINDA_SMALL_NUMBER ? Projection / Distance : 1.0f;
+
+			// fade out towards the edge of the cone and the end of the light's range
+			const float ConeFalloff = FMath::SmoothStep(CosOuter, CosInner, CosAngle);
+			const float RangeFalloff = FMath::Square(1.0f - Distance / Radius);
+			const float Exposure = ConeFalloff * RangeFalloff;
+
+			if (Exposure > ConeExposures[Index])
+			{
+				ConeExposures[Index] = Exposure;
+				ExposingLights[Index] = LightIndex;
+			}
+		}
+	}
+}
+
+void UHorrorLightExposureSubsystem::UpdateOcclusion()
+{
+	const int32 NumReceivers = Receivers.Num();
+
+	if (NumReceivers == 0)
+	{
+		return;
+	}
+
+	USQTraceBatchSubsystem* Traces = USQTraceBatchSubsystem::Get(this);
+
+	if (!Traces)
+	{
+		return;
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const float CacheTime = CVarHorrorLightOcclusionCacheTime.GetValueOnGameThread();
+
+	int32 TraceBudget = CVarHorrorLightMaxTracesPerFrame.GetValueOnGameThread();
+
+	// resume where the last frame left off so every lit receiver gets its turn
+	OcclusionCursor = OcclusionCursor % NumReceivers;
+
+	for (int32 Visited = 0; Visited < NumReceivers && TraceBudget > 0; ++Visited)
+	{
+		const int32 Index = (OcclusionCursor + Visited) % NumReceivers;
+
+		// receivers in the dark don't need occlusion, and fresh results are reused
+		if (ExposingLights[Index] == INDEX_NONE || PendingTraces[Index] != 0)
+		{
+			continue;
+		}
+
+		if (OcclusionTimes[Index] >= 0.0 && Now - OcclusionTimes[Index] < CacheTime)
+		{
+			continue;
+		}
+
+		// occlusion is only confirmed against the brightest light
+		const USpotLightComponent* Light = Lights[ExposingLights[Index]].Get();
+
+		FSQTraceRequest Request;
+		Request.Source = ESQTraceSource::LightExposure;
+		Request.Type = EAsyncTraceType::Test;
+		Request.Start = Light->GetComponentLocation();
+		Request.End = FVector(PositionsX[Index], PositionsY[Index], PositionsZ[Index]);
+		Request.QueryParams.AddIgnoredActor(Light->GetOwner());
+		Request.QueryParams.AddIgnoredActor(Receivers[Index].Get());
+
+		PendingTraces[Index] = Traces->SubmitTrace(Request, [WeakThis = TWeakObjectPtr<UHorrorLightExposureSubsystem>(this), Receiver = Receivers[Index]](const TArray<FHitResult>& Hits)
+		{
+			if (UHorrorLightExposureSubsystem* This = WeakThis.Get())
+			{
+				This->OnOcclusionTraceCompleted(Receiver, Hits.Num() > 0);
+			}
+		});
+
+		INC_DWORD_STAT(STAT_HorrorLightOcclusionTraces);
+
+		--TraceBudget;
+		OcclusionCursor = Index + 1;
+	}
+}
+
+void UHorrorLightExposureSubsystem::OnOcclusionTraceCompleted(const TWeakObjectPtr<AActor>& Receiver, bool bBlocked)
+{
+	const int32* Index = ReceiverIndices.Find(Receiver);
+
+	if (!Index)
+	{
+		return;
+	}
+
+	Occluded[*Index] = bBlocked;
+	OcclusionTimes[*Index] = GetWorld()->GetTimeSeconds();
+	PendingTraces[*Index] = 0;
+}
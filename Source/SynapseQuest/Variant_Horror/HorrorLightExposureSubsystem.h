@@ -0,0 +1,119 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Stats/Stats.h"
+#include "HorrorLightExposureSubsystem.generated.h"
+
+class USpotLightComponent;
+
+DECLARE_STATS_GROUP(TEXT("HorrorLight"), STATGROUP_HorrorLight, STATCAT_Advanced);
+
+/**
+ *  Tells horror AI how brightly the player's flashlights are shining on them
+ *  Receivers are kept in flat position arrays and culled against each light's cone four at a time.
+ *  Receivers inside a cone have their occlusion confirmed with batched async traces,
+ *  a few per frame, and the result is cached so lit receivers aren't traced every frame.
+ *  Exposure goes from 0 (in the dark or occluded) to 1 (at the light, in its inner cone)
+ */
+UCLASS()
+class SYNAPSEQUEST_API UHorrorLightExposureSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Registered lights */
+	TArray<TWeakObjectPtr<USpotLightComponent>> Lights;
+
+	/** Registered receivers */
+	TArray<TWeakObjectPtr<AActor>> Receivers;
+
+	/** Receiver positions, split by axis for the cone tests */
+	TArray<float> PositionsX;
+	TArray<float> PositionsY;
+	TArray<float> PositionsZ;
+
+	/** Scratch squared distances and cone projections for the light being tested */
+	TArray<float> DistancesSquared;
+	TArray<float> Projections;
+
+	/** Unoccluded exposure to the brightest light, per receiver */
+	TArray<float> ConeExposures;
+
+	/** Brightest light per receiver, or INDEX_NONE if it's in the dark */
+	TArray<int32> ExposingLights;
+
+	/** Final exposure per receiver */
+	TArray<float> Exposures;
+
+	/** Cached occlusion state per receiver */
+	TArray<bool> Occluded;
+
+	/** World time the cached occlusion was traced at, or a negative value if it was never traced */
+	TArray<double> OcclusionTimes;
+
+	/** Occlusion trace in flight per receiver, or 0 if there's none */
+	TArray<uint32> PendingTraces;
+
+	/** Number of times each receiver was registered */
+	TArray<int32> RegistrationCounts;
+
+	/** Maps receivers to their index in the arrays. Weak keys still match once the receiver is destroyed */
+	TMap<TWeakObjectPtr<const AActor>, int32> ReceiverIndices;
+
+	/** Receiver the occlusion round-robin resumes from */
+	int32 OcclusionCursor = 0;
+
+public:
+
+	/** Only run in game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Updates the exposure of every receiver */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable */
+	virtual TStatId GetStatId() const override;
+
+	/** Cancels any occlusion traces in flight */
+	virtual void Deinitialize() override;
+
+public:
+
+	/** Returns the subsystem for the given world context */
+	static UHorrorLightExposureSubsystem* Get(const UObject* WorldContextObject);
+
+	/** Registers a spotlight receivers can be exposed to */
+	void RegisterLight(USpotLightComponent* Light);
+
+	/** Unregisters a spotlight */
+	void UnregisterLight(USpotLightComponent* Light);
+
+	/** Registers an actor to track the exposure of. Registrations are counted, so every call needs a matching unregister */
+	void RegisterReceiver(AActor* Receiver);
+
+	/** Unregisters an actor */
+	void UnregisterReceiver(AActor* Receiver);
+
+	/** Returns the exposure of a registered actor, from 0 to 1. Unregistered actors are always in the dark */
+	UFUNCTION(BlueprintPure, Category="Horror")
+	float GetExposure(const AActor* Receiver) const;
+
+protected:
+
+	/** Copies the receiver locations into the position arrays */
+	void UpdatePositions();
+
+	/** Finds the brightest light for each receiver, ignoring occlusion */
+	void UpdateConeExposures();
+
+	/** Sends occlusion traces for the lit receivers with the stalest cached results */
+	void UpdateOcclusion();
+
+	/** Handles a finished occlusion trace */
+	void OnOcclusionTraceCompleted(const TWeakObjectPtr<AActor>& Receiver, bool bBlocked);
+
+	/** Removes the receiver at the given index */
+	void RemoveReceiverAt(int32 Index);
+};
@@ -0,0 +1,86 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Horror/HorrorStateTreeUtility.h"
+#include "Variant_Horror/HorrorLightExposureSubsystem.h"
+#include "StateTreeExecutionContext.h"
+#include "ShooterNPC.h"
+
+EStateTreeRunStatus FStateTreeTrackLightExposureTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	// have we transitioned from another state?
+	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
+	{
+		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+		if (UHorrorLightExposureSubsystem* LightExposure = UHorrorLightExposureSubsystem::Get(InstanceData.Character))
+		{
+			LightExposure->RegisterReceiver(InstanceData.Character);
+		}
+
+		InstanceData.Exposure = 0.0f;
+		InstanceData.bLit = false;
+	}
+
+	return EStateTreeRunStatus::Running;
+}
+
+EStateTreeRunStatus FStateTreeTrackLightExposureTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
+{
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	if (const UHorrorLightExposureSubsystem* LightExposure = UHorrorLightExposureSubsystem::Get(InstanceData.Character))
+	{
+		InstanceData.Exposure = LightExposure->GetExposure(InstanceData.Character);
+		InstanceData.bLit = InstanceData.Exposure > 0.0f && InstanceData.Exposure >= InstanceData.LitThreshold;
+	}
+
+	return EStateTreeRunStatus::Running;
+}
+
+void FStateTreeTrackLightExposureTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	// have we transitioned to another state?
+	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
+	{
+		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+		if (UHorrorLightExposureSubsystem* LightExposure = UHorrorLightExposureSubsystem::Get(InstanceData.Character))
+		{
+			LightExposure->UnregisterReceiver(InstanceData.Character);
+		}
+	}
+}
+
+#if WITH_EDITOR
+FText FStateTreeTrackLightExposureTask::GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting /*= EStateTreeNodeFormatting::Text*/) const
+{
+	return FText::FromString("<b>Track Light Exposure</b>");
+}
+#endif // WITH_EDITOR
+
+////////////////////////////////////////////////////////////////////
+
+bool FStateTreeIsLitCondition::TestCondition(FStateTreeExecutionContext& Context) const
+{
+	const FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	const UHorrorLightExposureSubsystem* LightExposure = UHorrorLightExposureSubsystem::Get(InstanceData.Character);
+
+	if (!LightExposure)
+	{
+		return false;
+	}
+
+	// an exposure of zero is never lit, even with a zero threshold
+	const float Exposure = LightExposure->GetExposure(InstanceData.Character);
+
+	return Exposure > 0.0f && Exposure >= InstanceData.MinExposure;
+}
+
+#if WITH_EDITOR
+FText FStateTreeIsLitCondition::GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting /*= EStateTreeNodeFormatting::Text*/) const
+{
+	return FText::FromString("<b>Is Lit</b>");
+}
+#endif
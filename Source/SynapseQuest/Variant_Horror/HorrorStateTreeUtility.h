@@ -0,0 +1,117 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StateTreeTaskBase.h"
+#include "StateTreeConditionBase.h"
+
+#include "HorrorStateTreeUtility.generated.h"
+
+class AShooterNPC;
+
+/**
+ *  Instance data struct for the Track Light Exposure StateTree task
+ */
+USTRUCT()
+struct FStateTreeTrackLightExposureInstanceData
+{
+	GENERATED_BODY()
+
+	/** NPC to track the light exposure of */
+	UPROPERTY(EditAnywhere, Category = Context)
+	TObjectPtr<AShooterNPC> Character;
+
+	/** Exposure at or above this value counts as lit */
+	UPROPERTY(EditAnywhere, Category = Parameter, meta = (ClampMin = 0, ClampMax = 1))
+	float LitThreshold = 0.1f;
+
+	/** How brightly the player's flashlights are shining on the character, from 0 to 1 */
+	UPROPERTY(EditAnywhere, Category = Output)
+	float Exposure = 0.0f;
+
+	/** True if the exposure is at or above the lit threshold */
+	UPROPERTY(EditAnywhere, Category = Output)
+	bool bLit = false;
+};
+
+/**
+ *  StateTree task that tracks how brightly the player's flashlights are shining on the character
+ *  The character is registered with the light exposure subsystem while the state is active.
+ *  Keeps running until the state is exited
+ */
+USTRUCT(meta=(DisplayName="Track Light Exposure", Category="Horror"))
+struct FStateTreeTrackLightExposureTask : public FStateTreeTaskCommonBase
+{
+	GENERATED_BODY()
+
+	/* Ensure we're using the correct instance data struct */
+	using FInstanceDataType = FStateTreeTrackLightExposureInstanceData;
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+
+	/** Constructor */
+	FStateTreeTrackLightExposureTask()
+	{
+		// the exposure is read on tick
+		bShouldCallTick = true;
+	}
+
+	/** Runs when the owning state is entered */
+	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
+	/** Runs while the owning state is active */
+	virtual EStateTreeRunStatus Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const override;
+
+	/** Runs when the owning state is ended */
+	virtual void ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
+#if WITH_EDITOR
+	virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
+#endif // WITH_EDITOR
+};
+
+////////////////////////////////////////////////////////////////////
+
+/**
+ *  Instance data struct for the FStateTreeIsLitCondition condition
+ */
+USTRUCT()
+struct FStateTreeIsLitConditionInstanceData
+{
+	GENERATED_BODY()
+
+	/** Character to check the light exposure of */
+	UPROPERTY(EditAnywhere, Category = "Context")
+	TObjectPtr<AShooterNPC> Character = nullptr;
+
+	/** Min light exposure for the condition to pass */
+	UPROPERTY(EditAnywhere, Category = "Condition", meta = (ClampMin = 0, ClampMax = 1))
+	float MinExposure = 0.1f;
+};
+STATETREE_POD_INSTANCEDATA(FStateTreeIsLitConditionInstanceData);
+
+/**
+ *  StateTree condition to check if the player's flashlights are shining on the character
+ *  The character must be registered with the light exposure subsystem, usually through the Track Light Exposure task
+ */
+USTRUCT(DisplayName = "Is Lit", Category="Horror")
+struct FStateTreeIsLitCondition : public FStateTreeConditionCommonBase
+{
+	GENERATED_BODY()
+
+	/** Set the instance data type */
+	using FInstanceDataType = FStateTreeIsLitConditionInstanceData;
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+
+	/** Default constructor */
+	FStateTreeIsLitCondition() = default;
+
+	/** Tests the StateTree condition */
+	virtual bool TestCondition(FStateTreeExecutionContext& Context) const override;
+
+#if WITH_EDITOR
+	/** Provides the description string */
+	virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
+#endif
+
+};
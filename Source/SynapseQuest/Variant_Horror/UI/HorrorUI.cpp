@@ -12,12 +12,34 @@ void UHorrorUI::SetupCharacter(AHorrorCharacter* HorrorCharacter)
 
 void UHorrorUI::OnSprintMeterUpdated(float Percent)
 {
-	// call the BP handler
-	BP_SprintMeterUpdated(Percent);
+	// queue the BP handler
+	PendingSprintPercent = Percent;
+	bSprintMeterDirty = true;
+
+	MarkHUDDirty();
 }
 
 void UHorrorUI::OnSprintStateChanged(bool bSprinting)
 {
-	// call the BP handler
-	BP_SprintStateChanged(bSprinting);
+	// queue the BP handler
+	bPendingSprinting = bSprinting;
+	bSprintStateDirty = true;
+
+	MarkHUDDirty();
+}
+
+void UHorrorUI::NativeFlushHUD()
+{
+	// push the state first so the meter is drawn in the right style
+	if (bSprintStateDirty)
+	{
+		bSprintStateDirty = false;
+		BP_SprintStateChanged(bPendingSprinting);
+	}
+
+	if (bSprintMeterDirty)
+	{
+		bSprintMeterDirty = false;
+		BP_SprintMeterUpdated(PendingSprintPercent);
+	}
 }
@@ -3,7 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "Blueprint/UserWidget.h"
+#include "SQHUDWidget.h"
 #include "HorrorUI.generated.h"
 
 class AHorrorCharacter;
@@ -11,11 +11,24 @@ class AHorrorCharacter;
 /**
  *  Simple UI for a first person horror game
  *  Manages character sprint meter display
+ *  Sprint changes are coalesced into one Blueprint update per HUD flush
  */
 UCLASS(abstract)
-class SYNAPSEQUEST_API UHorrorUI : public UUserWidget
+class SYNAPSEQUEST_API UHorrorUI : public USQHUDWidget
 {
 	GENERATED_BODY()
+
+	/** Pending sprint meter percentage */
+	float PendingSprintPercent = 1.0f;
+
+	/** Pending sprint state */
+	bool bPendingSprinting = false;
+
+	/** If true, the sprint meter changed since the last flush */
+	bool bSprintMeterDirty = false;
+
+	/** If true, the sprint state changed since the last flush */
+	bool bSprintStateDirty = false;
 	
 public:
 
@@ -39,4 +52,7 @@ protected:
 	/** Passes control to Blueprint to update the sprint meter status */
 	UFUNCTION(BlueprintImplementableEvent, Category="Horror", meta = (DisplayName = "Sprint State Changed"))
 	void BP_SprintStateChanged(bool bSprinting);
+
+	/** Pushes the latest sprint state and meter to Blueprint */
+	virtual void NativeFlushHUD() override;
 };
@@ -3,6 +3,7 @@
 
 #include "Variant_Shooter/AI/ShooterAIController.h"
 #include "ShooterNPC.h"
+#include "ShooterTeamSubsystem.h"
 #include "Components/StateTreeAIComponent.h"
 #include "Perception/AIPerceptionComponent.h"
 #include "Navigation/PathFollowingComponent.h"
@@ -32,21 +33,34 @@ void AShooterAIController::OnPossess(APawn* InPawn)
 		// add the team tag to the pawn
 		NPC->Tags.Add(TeamTag);
 
+		// perception filters by our pawn's team
+		OnPawnTeamChanged();
+
 		// subscribe to the pawn's OnDeath delegate
 		NPC->OnPawnDeath.AddDynamic(this, &AShooterAIController::OnPawnDeath);
 
-		// start AI logic
-		StateTreeAI->StartLogic();
+		// pooled pawns start their logic when they're respawned
+		if (!NPC->IsDormant())
+		{
+			// start AI logic
+			StateTreeAI->StartLogic();
+		}
 	}
 }
 
 void AShooterAIController::OnPawnDeath()
 {
-	// stop movement
-	GetPathFollowingComponent()->AbortMove(*this, FPathFollowingResultFlags::UserAbort);
+	// stop moving, thinking and targeting
+	StopPawnLogic();
 
-	// stop StateTree logic
-	StateTreeAI->StopLogic(FString(""));
+	// pooled pawns keep their controller so they can be respawned
+	if (AShooterNPC* NPC = GetPawn<AShooterNPC>())
+	{
+		if (NPC->IsPooled())
+		{
+			return;
+		}
+	}
 
 	// unpossess the pawn
 	UnPossess();
@@ -55,6 +69,68 @@ void AShooterAIController::OnPawnDeath()
 	Destroy();
 }
 
+void AShooterAIController::StopPawnLogic()
+{
+	// stop movement
+	GetPathFollowingComponent()->AbortMove(*this, FPathFollowingResultFlags::UserAbort);
+
+	// stop StateTree logic
+	StateTreeAI->StopLogic(FString(""));
+
+	// clear the target
+	ClearCurrentTarget();
+	ClearFocus(EAIFocusPriority::Gameplay);
+}
+
+void AShooterAIController::OnPawnTeamChanged()
+{
+	AIPerception->RequestStimuliListenerUpdate();
+}
+
+FGenericTeamId AShooterAIController::GetGenericTeamId() const
+{
+	// the pawn owns the team
+	if (const UShooterTeamSubsystem* Teams = UShooterTeamSubsystem::Get(this))
+	{
+		if (const APawn* ControlledPawn = GetPawn())
+		{
+			return Teams->GetTeam(ControlledPawn);
+		}
+	}
+
+	return Super::GetGenericTeamId();
+}
+
+ETeamAttitude::Type AShooterAIController::GetTeamAttitudeTowards(const AActor& Other) const
+{
+	const UShooterTeamSubsystem* Teams = UShooterTeamSubsystem::Get(this);
+	const APawn* ControlledPawn = GetPawn();
+
+	if (Teams && ControlledPawn)
+	{
+		// judge controllers by their pawns
+		const APawn* OtherPawn = Cast<APawn>(&Other);
+
+		if (const AController* OtherController = Cast<AController>(&Other))
+		{
+			OtherPawn = OtherController->GetPawn();
+		}
+
+		return Teams->GetAttitude(ControlledPawn, OtherPawn ? OtherPawn : &Other);
+	}
+
+	return Super::GetTeamAttitudeTowards(Other);
+}
+
+void AShooterAIController::RestartPawnLogic()
+{
+	// forget anything sensed before the pawn died
+	AIPerception->ForgetAll();
+
+	// start AI logic
+	StateTreeAI->StartLogic();
+}
+
 void AShooterAIController::SetCurrentTarget(AActor* Target)
 {
 	TargetEnemy = Target;
@@ -67,12 +143,140 @@ void AShooterAIController::ClearCurrentTarget()
 
 void AShooterAIController::OnPerceptionUpdated(AActor* Actor, FAIStimulus Stimulus)
 {
-	// pass the data to the StateTree delegate hook
-	OnShooterPerceptionUpdated.ExecuteIfBound(Actor, Stimulus);
+	// notify any immediate listeners
+	OnShooterPerceptionUpdated.Broadcast(Actor, Stimulus);
+
+	// queue the event for the StateTree tasks
+	QueuePerceptionEvent(Actor, &Stimulus);
 }
 
 void AShooterAIController::OnPerceptionForgotten(AActor* Actor)
 {
-	// pass the data to the StateTree delegate hook
-	OnShooterPerceptionForgotten.ExecuteIfBound(Actor);
+	// notify any immediate listeners
+	OnShooterPerceptionForgotten.Broadcast(Actor);
+
+	// queue the event for the StateTree tasks
+	QueuePerceptionEvent(Actor, nullptr);
+}
+
+int32 AShooterAIController::SubscribeToPerception()
+{
+	const int32 Subscription = ++LastPerceptionSubscription;
+
+	// new subscribers only read events queued from now on
+	PerceptionCursors.Add(Subscription, NextPerceptionSerial);
+
+	return Subscription;
+}
+
+void AShooterAIController::UnsubscribeFromPerception(int32 Subscription)
+{
+	PerceptionCursors.Remove(Subscription);
+
+	// discard any events that were only waiting on this subscriber
+	TrimPerceptionEvents();
+}
+
+void AShooterAIController::DrainPerceptionEvents(int32 Subscription, TArray<FShooterPerceptionEvent>& OutEvents)
+{
+	uint64* Cursor = PerceptionCursors.Find(Subscription);
+
+	if (!Cursor)
+	{
+		return;
+	}
+
+	// copy every event the subscriber hasn't read yet
+	for (const FShooterPerceptionEvent& Event : PerceptionEvents)
+	{
+		if (Event.Serial >= *Cursor)
+		{
+			OutEvents.Add(Event);
+		}
+	}
+
+	// advance the cursor past everything we have queued
+	*Cursor = NextPerceptionSerial;
+	HighestPerceptionCursor = FMath::Max(HighestPerceptionCursor, NextPerceptionSerial);
+
+	TrimPerceptionEvents();
+}
+
+void AShooterAIController::QueuePerceptionEvent(AActor* Actor, const FAIStimulus* Stimulus)
+{
+	// no need to queue anything if nobody is listening
+	if (PerceptionCursors.IsEmpty() || !Actor)
+	{
+		return;
+	}
+
+	// reset the merge map every frame
+	if (FramePerceptionEventsFrame != GFrameCounter)
+	{
+		FramePerceptionEventsFrame = GFrameCounter;
+		FramePerceptionEvents.Reset();
+	}
+
+	// do we already have an unread event for this actor this frame?
+	if (const int32* FoundIndex = FramePerceptionEvents.Find(Actor))
+	{
+		if (PerceptionEvents.IsValidIndex(*FoundIndex))
+		{
+			FShooterPerceptionEvent& Event = PerceptionEvents[*FoundIndex];
+
+			// only merge if no subscriber has read the event yet
+			if (Event.Actor == Actor && Event.Serial >= HighestPerceptionCursor)
+			{
+				// the latest stimulus or forget supersedes the previous one
+				Event.bForgotten = Stimulus == nullptr;
+
+				if (Stimulus)
+				{
+					Event.Stimulus = *Stimulus;
+				}
+
+				return;
+			}
+		}
+	}
+
+	// add a new event
+	FShooterPerceptionEvent& Event = PerceptionEvents.AddDefaulted_GetRef();
+	Event.Actor = Actor;
+	Event.bForgotten = Stimulus == nullptr;
+	Event.Serial = NextPerceptionSerial++;
+
+	if (Stimulus)
+	{
+		Event.Stimulus = *Stimulus;
+	}
+
+	FramePerceptionEvents.Add(Actor, PerceptionEvents.Num() - 1);
+}
+
+void AShooterAIController::TrimPerceptionEvents()
+{
+	// find the oldest event still waiting to be read
+	uint64 LowestCursor = NextPerceptionSerial;
+
+	for (const TPair<int32, uint64>& Pair : PerceptionCursors)
+	{
+		LowestCursor = FMath::Min(LowestCursor, Pair.Value);
+	}
+
+	// count the events every subscriber has read
+	int32 NumRead = 0;
+
+	while (NumRead < PerceptionEvents.Num() && PerceptionEvents[NumRead].Serial < LowestCursor)
+	{
+		++NumRead;
+	}
+
+	if (NumRead > 0)
+	{
+		PerceptionEvents.RemoveAt(0, NumRead, EAllowShrinking::No);
+
+		// the merge map indices are now stale
+		FramePerceptionEvents.Reset();
+	}
 }
@@ -4,14 +4,32 @@
 
 #include "CoreMinimal.h"
 #include "AIController.h"
+#include "Perception/AIPerceptionTypes.h"
 #include "ShooterAIController.generated.h"
 
 class UStateTreeAIComponent;
 class UAIPerceptionComponent;
-struct FAIStimulus;
 
-DECLARE_DELEGATE_TwoParams(FShooterPerceptionUpdatedDelegate, AActor*, const FAIStimulus&);
-DECLARE_DELEGATE_OneParam(FShooterPerceptionForgottenDelegate, AActor*);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FShooterPerceptionUpdatedDelegate, AActor*, const FAIStimulus&);
+DECLARE_MULTICAST_DELEGATE_OneParam(FShooterPerceptionForgottenDelegate, AActor*);
+
+/**
+ *  A perception update or forget event queued for perception subscribers
+ */
+struct FShooterPerceptionEvent
+{
+	/** Perceived actor */
+	TWeakObjectPtr<AActor> Actor;
+
+	/** Latest stimulus for the actor. Unused for forget events */
+	FAIStimulus Stimulus;
+
+	/** If true, the actor has been forgotten by the perception system */
+	bool bForgotten = false;
+
+	/** Sequence number of this event in the controller's perception queue */
+	uint64 Serial = 0;
+};
 
 /**
  *  Simple AI Controller for a first person shooter enemy
@@ -31,19 +49,40 @@ class SYNAPSEQUEST_API AShooterAIController : public AAIController
 
 protected:
 
-	/** Team tag for pawn friend or foe identification */
+	/** Tag added to the possessed pawn for Blueprint and EQS use. Friend or foe checks go through the team subsystem */
 	UPROPERTY(EditAnywhere, Category="Shooter")
 	FName TeamTag = FName("Enemy");
 
 	/** Enemy currently being targeted */
 	TObjectPtr<AActor> TargetEnemy;
 
+	/** Perception events not yet read by every subscriber */
+	TArray<FShooterPerceptionEvent> PerceptionEvents;
+
+	/** Serial number the next queued perception event will get */
+	uint64 NextPerceptionSerial = 0;
+
+	/** Serial of the next event each subscriber will read, keyed by subscription ID */
+	TMap<int32, uint64> PerceptionCursors;
+
+	/** Highest serial read by any subscriber. Events below it can't be merged anymore */
+	uint64 HighestPerceptionCursor = 0;
+
+	/** Index of the unread event queued for each actor this frame, used to merge repeated stimuli */
+	TMap<TWeakObjectPtr<AActor>, int32> FramePerceptionEvents;
+
+	/** Frame number the merge map was built for */
+	uint64 FramePerceptionEventsFrame = 0;
+
+	/** Last subscription ID handed out */
+	int32 LastPerceptionSubscription = 0;
+
 public:
 
-	/** Called when an AI perception has been updated. StateTree task delegate hook */
+	/** Called right away when an AI perception has been updated */
 	FShooterPerceptionUpdatedDelegate OnShooterPerceptionUpdated;
 
-	/** Called when an AI perception has been forgotten. StateTree task delegate hook */
+	/** Called right away when an AI perception has been forgotten */
 	FShooterPerceptionForgottenDelegate OnShooterPerceptionForgotten;
 
 public:
@@ -70,9 +109,44 @@ public:
 	/** Clears the targeted enemy */
 	void ClearCurrentTarget();
 
+	/** Restarts the AI logic for a pooled pawn that has been respawned */
+	void RestartPawnLogic();
+
+	/** Stops movement, the StateTree logic and targeting without releasing the pawn */
+	void StopPawnLogic();
+
+	/** Refreshes the perception listener after the possessed pawn changes teams */
+	void OnPawnTeamChanged();
+
+	/** Returns the team of the possessed pawn */
+	virtual FGenericTeamId GetGenericTeamId() const override;
+
+	/** Returns how the possessed pawn feels about the passed actor. Used by perception affiliation filtering */
+	virtual ETeamAttitude::Type GetTeamAttitudeTowards(const AActor& Other) const override;
+
 	/** Returns the targeted enemy */
 	AActor* GetCurrentTarget() const { return TargetEnemy; };
 
+	/** Starts queuing perception events for a new subscriber. Returns the subscription ID */
+	int32 SubscribeToPerception();
+
+	/** Stops queuing perception events for the given subscriber */
+	void UnsubscribeFromPerception(int32 Subscription);
+
+	/**
+	 *  Appends every perception event the subscriber hasn't read yet to the passed array
+	 *  Repeated stimuli for the same actor within a frame are merged into a single event
+	 */
+	void DrainPerceptionEvents(int32 Subscription, TArray<FShooterPerceptionEvent>& OutEvents);
+
+protected:
+
+	/** Adds a perception event to the queue, merging it with any unread event for the same actor this frame */
+	void QueuePerceptionEvent(AActor* Actor, const FAIStimulus* Stimulus);
+
+	/** Discards the perception events every subscriber has already read */
+	void TrimPerceptionEvents();
+
 protected:
 
 	/** Called when the AI perception component updates a perception on a given actor */
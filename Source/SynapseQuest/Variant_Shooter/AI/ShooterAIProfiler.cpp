@@ -0,0 +1,85 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterAIProfiler.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/OutputDevice.h"
+
+static TAutoConsoleVariable<bool> CVarShooterAIProfile(
+	TEXT("Shooter.AI.Profile"),
+	false,
+	TEXT("If true, every shooter AI StateTree node call is timed and added to the per node cost table."),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithOutputDevice ShooterAIDumpProfileCommand(
+	TEXT("Shooter.AI.DumpProfile"),
+	TEXT("Prints the per node cost table for the shooter AI StateTree nodes. Requires Shooter.AI.Profile 1."),
+	FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& Ar)
+	{
+		FShooterAIProfiler::Get().DumpTable(Ar);
+	}));
+
+static FAutoConsoleCommand ShooterAIResetProfileCommand(
+	TEXT("Shooter.AI.ResetProfile"),
+	TEXT("Clears the per node cost table for the shooter AI StateTree nodes."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FShooterAIProfiler::Get().Reset();
+	}));
+
+FShooterAIProfiler& FShooterAIProfiler::Get()
+{
+	static FShooterAIProfiler Profiler;
+	return Profiler;
+}
+
+bool FShooterAIProfiler::IsEnabled()
+{
+	return CVarShooterAIProfile.GetValueOnGameThread();
+}
+
+void FShooterAIProfiler::SetEnabled(bool bEnabled)
+{
+	CVarShooterAIProfile->Set(bEnabled, ECVF_SetByCode);
+}
+
+void FShooterAIProfiler::AddSample(FName NodeName, double Seconds)
+{
+	check(IsInGameThread());
+
+	FNodeStats& Stats = Nodes.FindOrAdd(NodeName);
+	++Stats.Calls;
+	Stats.TotalSeconds += Seconds;
+	Stats.WorstSeconds = FMath::Max(Stats.WorstSeconds, Seconds);
+}
+
+void FShooterAIProfiler::Reset()
+{
+	Nodes.Reset();
+}
+
+void FShooterAIProfiler::DumpTable(FOutputDevice& Ar) const
+{
+	// sort the nodes by total cost
+	TArray<TPair<FName, FNodeStats>> SortedNodes;
+
+	for (const TPair<FName, FNodeStats>& Pair : Nodes)
+	{
+		SortedNodes.Add(Pair);
+	}
+
+	SortedNodes.Sort([](const TPair<FName, FNodeStats>& A, const TPair<FName, FNodeStats>& B)
+	{
+		return A.Value.TotalSeconds > B.Value.TotalSeconds;
+	});
+
+	Ar.Logf(TEXT("%-24s %12s %12s %12s %12s"), TEXT("Node"), TEXT("Calls"), TEXT("Total (ms)"), TEXT("Avg (us)"), TEXT("Worst (us)"));
+
+	for (const TPair<FName, FNodeStats>& Pair : SortedNodes)
+	{
+		const FNodeStats& Stats = Pair.Value;
+		const double AverageSeconds = Stats.Calls > 0 ? Stats.TotalSeconds / Stats.Calls : 0.0;
+
+		Ar.Logf(TEXT("%-24s %12lld %12.3f %12.3f %12.3f"), *Pair.Key.ToString(), Stats.Calls, Stats.TotalSeconds * 1000.0, AverageSeconds * 1000000.0, Stats.WorstSeconds * 1000000.0);
+	}
+}
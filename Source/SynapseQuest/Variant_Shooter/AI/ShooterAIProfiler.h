@@ -0,0 +1,102 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+DECLARE_STATS_GROUP(TEXT("ShooterAI"), STATGROUP_ShooterAI, STATCAT_Advanced);
+
+/**
+ *  Collects per call timings for the shooter AI StateTree nodes
+ *  Complements the ShooterAI stat group, which reports per frame totals, with per call averages and worst cases
+ *  Sampling is enabled with Shooter.AI.Profile, and results are printed with Shooter.AI.DumpProfile
+ */
+class SYNAPSEQUEST_API FShooterAIProfiler
+{
+public:
+
+	/** Accumulated timings for a single node */
+	struct FNodeStats
+	{
+		/** Number of sampled calls */
+		int64 Calls = 0;
+
+		/** Total time spent in the node */
+		double TotalSeconds = 0.0;
+
+		/** Slowest single call */
+		double WorstSeconds = 0.0;
+	};
+
+	/** Returns the profiler singleton */
+	static FShooterAIProfiler& Get();
+
+	/** Returns true if per call sampling is enabled */
+	static bool IsEnabled();
+
+	/** Enables or disables per call sampling */
+	static void SetEnabled(bool bEnabled);
+
+	/** Adds a timing sample for the passed node. Game thread only */
+	void AddSample(FName NodeName, double Seconds);
+
+	/** Clears all samples */
+	void Reset();
+
+	/** Prints a per node cost table, sorted by total time */
+	void DumpTable(FOutputDevice& Ar) const;
+
+	/** Returns the accumulated timings for every node */
+	const TMap<FName, FNodeStats>& GetNodeStats() const { return Nodes; }
+
+private:
+
+	/** Accumulated timings, keyed by node name */
+	TMap<FName, FNodeStats> Nodes;
+};
+
+/**
+ *  Times a scope and adds the sample to the shooter AI profiler
+ */
+class FShooterAIProfilerScope
+{
+	/** Node being timed */
+	FName NodeName;
+
+	/** Cycle count at the start of the scope, or zero if sampling is disabled */
+	uint64 StartCycles;
+
+public:
+
+	explicit FShooterAIProfilerScope(FName InNodeName)
+		: NodeName(InNodeName)
+		, StartCycles(FShooterAIProfiler::IsEnabled() ? FPlatformTime::Cycles64() : 0)
+	{
+	}
+
+	~FShooterAIProfilerScope()
+	{
+		if (StartCycles != 0)
+		{
+			FShooterAIProfiler::Get().AddSample(NodeName, FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles));
+		}
+	}
+};
+
+/**
+ *  Profiles a shooter AI node scope. Requires a STAT_ShooterAI_<NodeName> cycle stat in the ShooterAI group
+ *  Cycle counters already emit Insights events, so a plain CPU trace scope is only added when stats are compiled out
+ */
+#if STATS
+#define SHOOTER_AI_SCOPE(NodeName) \
+	SCOPE_CYCLE_COUNTER(STAT_ShooterAI_##NodeName); \
+	static const FName ShooterAIScopeName(TEXT(#NodeName)); \
+	FShooterAIProfilerScope ShooterAIProfilerScope(ShooterAIScopeName)
+#else
+#define SHOOTER_AI_SCOPE(NodeName) \
+	TRACE_CPUPROFILER_EVENT_SCOPE(ShooterAI_##NodeName); \
+	static const FName ShooterAIScopeName(TEXT(#NodeName)); \
+	FShooterAIProfilerScope ShooterAIProfilerScope(ShooterAIScopeName)
+#endif
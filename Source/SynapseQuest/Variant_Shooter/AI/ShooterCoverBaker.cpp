@@ -0,0 +1,122 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterCoverBaker.h"
+#include "SynapseQuest.h"
+#include "ShooterCoverData.h"
+#include "ShooterCoverSubsystem.h"
+#include "Components/BoxComponent.h"
+#include "Engine/World.h"
+
+AShooterCoverBaker::AShooterCoverBaker()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	// create the bounds box
+	RootComponent = BakeBounds = CreateDefaultSubobject<UBoxComponent>(TEXT("Bake Bounds"));
+
+	BakeBounds->SetBoxExtent(FVector(2000.0f, 2000.0f, 500.0f));
+	BakeBounds->SetCollisionProfileName(FName("NoCollision"));
+	BakeBounds->SetCanEverAffectNavigation(false);
+}
+
+void AShooterCoverBaker::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (CoverData)
+	{
+		if (UShooterCoverSubsystem* CoverSubsystem = GetWorld()->GetSubsystem<UShooterCoverSubsystem>())
+		{
+			CoverSubsystem->RegisterCoverData(CoverData);
+		}
+	}
+}
+
+void AShooterCoverBaker::EndPlay(EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	if (CoverData)
+	{
+		if (UShooterCoverSubsystem* CoverSubsystem = GetWorld()->GetSubsystem<UShooterCoverSubsystem>())
+		{
+			CoverSubsystem->UnregisterCoverData(CoverData);
+		}
+	}
+}
+
+#if WITH_EDITOR
+
+void AShooterCoverBaker::BakeCover()
+{
+	if (!CoverData)
+	{
+		UE_LOG(LogSynapseQuest, Warning, TEXT("%s has no cover data asset to bake into"), *GetName());
+		return;
+	}
+
+	UWorld* World = GetWorld();
+
+	CoverData->Modify();
+	CoverData->ResetPoints();
+
+	const FBox Bounds = BakeBounds->Bounds.GetBox();
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ShooterCoverBake), false, this);
+
+	// precompute the probe directions for each sector
+	FVector SectorDirections[UShooterCoverData::NumSectors];
+
+	for (int32 Sector = 0; Sector < UShooterCoverData::NumSectors; ++Sector)
+	{
+		const float Angle = UE_TWO_PI * Sector / UShooterCoverData::NumSectors;
+		SectorDirections[Sector] = FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.0f);
+	}
+
+	for (float X = Bounds.Min.X; X <= Bounds.Max.X; X += GridSpacing)
+	{
+		for (float Y = Bounds.Min.Y; Y <= Bounds.Max.Y; Y += GridSpacing)
+		{
+			// find the floor under this sample
+			FHitResult FloorHit;
+
+			if (!World->LineTraceSingleByChannel(FloorHit, FVector(X, Y, Bounds.Max.Z), FVector(X, Y, Bounds.Min.Z), ProbeChannel, QueryParams))
+			{
+				continue;
+			}
+
+			// skip floors too steep to stand on
+			if (FloorHit.ImpactNormal.Z < MinFloorNormalZ)
+			{
+				continue;
+			}
+
+			// probe around the sample at crouch height
+			const FVector ProbeStart = FloorHit.ImpactPoint + FVector(0.0f, 0.0f, ProbeHeight);
+
+			uint8 Sectors = 0;
+			int32 NumProtected = 0;
+
+			for (int32 Sector = 0; Sector < UShooterCoverData::NumSectors; ++Sector)
+			{
+				if (World->LineTraceTestByChannel(ProbeStart, ProbeStart + SectorDirections[Sector] * ProbeDistance, ProbeChannel, QueryParams))
+				{
+					Sectors |= 1 << Sector;
+					++NumProtected;
+				}
+			}
+
+			if (NumProtected >= MinProtectedSectors && NumProtected <= MaxProtectedSectors)
+			{
+				CoverData->AddPoint(FloorHit.ImpactPoint, Sectors);
+			}
+		}
+	}
+
+	CoverData->MarkPackageDirty();
+
+	UE_LOG(LogSynapseQuest, Log, TEXT("%s baked %d cover points into %s"), *GetName(), CoverData->GetNumPoints(), *CoverData->GetName());
+}
+
+#endif // WITH_EDITOR
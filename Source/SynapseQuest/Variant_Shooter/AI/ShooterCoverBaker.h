@@ -0,0 +1,79 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ShooterCoverBaker.generated.h"
+
+class UBoxComponent;
+class UShooterCoverData;
+
+/**
+ *  Bakes the cover points inside its bounds into a Shooter Cover Data asset, and registers them with the cover subsystem during play.
+ *  Baking samples the floor on a regular grid and probes around each sample at crouch height for blocking geometry.
+ */
+UCLASS()
+class SYNAPSEQUEST_API AShooterCoverBaker : public AActor
+{
+	GENERATED_BODY()
+
+	/** Area to bake cover points in */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	UBoxComponent* BakeBounds;
+
+protected:
+
+	/** Asset the cover points are baked into and loaded from */
+	UPROPERTY(EditAnywhere, Category="Cover")
+	TObjectPtr<UShooterCoverData> CoverData;
+
+	/** Distance between floor samples */
+	UPROPERTY(EditAnywhere, Category="Cover|Bake", meta = (ClampMin = 25, ClampMax = 1000, Units = "cm"))
+	float GridSpacing = 150.0f;
+
+	/** Height above the floor the cover probes are traced at */
+	UPROPERTY(EditAnywhere, Category="Cover|Bake", meta = (ClampMin = 10, ClampMax = 200, Units = "cm"))
+	float ProbeHeight = 70.0f;
+
+	/** Length of the cover probes. Geometry closer than this counts as cover in that direction */
+	UPROPERTY(EditAnywhere, Category="Cover|Bake", meta = (ClampMin = 10, ClampMax = 500, Units = "cm"))
+	float ProbeDistance = 120.0f;
+
+	/** Min number of blocked sectors for a sample to count as cover */
+	UPROPERTY(EditAnywhere, Category="Cover|Bake", meta = (ClampMin = 1, ClampMax = 7))
+	int32 MinProtectedSectors = 1;
+
+	/** Max number of blocked sectors for a sample to count as cover. Samples blocked all around are inside geometry or too cramped */
+	UPROPERTY(EditAnywhere, Category="Cover|Bake", meta = (ClampMin = 1, ClampMax = 7))
+	int32 MaxProtectedSectors = 5;
+
+	/** Min Z component of the floor normal for a sample to be walkable */
+	UPROPERTY(EditAnywhere, Category="Cover|Bake", meta = (ClampMin = 0, ClampMax = 1))
+	float MinFloorNormalZ = 0.7f;
+
+	/** Channel used by the floor and cover probes */
+	UPROPERTY(EditAnywhere, Category="Cover|Bake")
+	TEnumAsByte<ECollisionChannel> ProbeChannel = ECC_Visibility;
+
+public:
+
+	/** Constructor */
+	AShooterCoverBaker();
+
+protected:
+
+	/** Registers the baked cover points */
+	virtual void BeginPlay() override;
+
+	/** Unregisters the baked cover points */
+	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
+#if WITH_EDITOR
+
+	/** Samples the level geometry inside the bounds and overwrites the cover data asset */
+	UFUNCTION(CallInEditor, Category="Cover")
+	void BakeCover();
+
+#endif // WITH_EDITOR
+};
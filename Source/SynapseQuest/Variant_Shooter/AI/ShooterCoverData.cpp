@@ -0,0 +1,29 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterCoverData.h"
+
+void UShooterCoverData::ResetPoints()
+{
+	LocationsX.Reset();
+	LocationsY.Reset();
+	LocationsZ.Reset();
+	ProtectedSectors.Reset();
+}
+
+void UShooterCoverData::AddPoint(const FVector& Location, uint8 Sectors)
+{
+	LocationsX.Add(Location.X);
+	LocationsY.Add(Location.Y);
+	LocationsZ.Add(Location.Z);
+	ProtectedSectors.Add(Sectors);
+}
+
+int32 UShooterCoverData::GetSector(float DirectionX, float DirectionY)
+{
+	// map the angle to [0, 2PI) and offset by half a sector so sector 0 is centered on +X
+	const float SectorAngle = UE_TWO_PI / NumSectors;
+	const float Angle = FMath::Atan2(DirectionY, DirectionX) + UE_TWO_PI + SectorAngle * 0.5f;
+
+	return FMath::FloorToInt32(Angle / SectorAngle) % NumSectors;
+}
@@ -0,0 +1,63 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "ShooterCoverData.generated.h"
+
+/**
+ *  Cover points baked from level geometry by a Shooter Cover Baker
+ *  Points are stored as separate coordinate arrays so the scoring jobs can stream through them with vector math.
+ *  Each point also keeps one bit per sector around it, set if geometry blocks that direction at crouch height
+ */
+UCLASS(BlueprintType)
+class SYNAPSEQUEST_API UShooterCoverData : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Number of direction sectors tested around each cover point */
+	static constexpr int32 NumSectors = 8;
+
+protected:
+
+	/** X coordinate of each cover point */
+	UPROPERTY(VisibleAnywhere, Category="Cover")
+	TArray<float> LocationsX;
+
+	/** Y coordinate of each cover point */
+	UPROPERTY(VisibleAnywhere, Category="Cover")
+	TArray<float> LocationsY;
+
+	/** Z coordinate of each cover point, on the floor */
+	UPROPERTY(VisibleAnywhere, Category="Cover")
+	TArray<float> LocationsZ;
+
+	/** Blocked direction sectors for each cover point. Bit 0 faces +X, continuing counter clockwise seen from above */
+	UPROPERTY(VisibleAnywhere, Category="Cover")
+	TArray<uint8> ProtectedSectors;
+
+public:
+
+	/** Removes every cover point */
+	void ResetPoints();
+
+	/** Adds a cover point */
+	void AddPoint(const FVector& Location, uint8 Sectors);
+
+	/** Returns the number of cover points */
+	int32 GetNumPoints() const { return LocationsX.Num(); }
+
+	/** Returns the cover point coordinate arrays */
+	const TArray<float>& GetLocationsX() const { return LocationsX; }
+	const TArray<float>& GetLocationsY() const { return LocationsY; }
+	const TArray<float>& GetLocationsZ() const { return LocationsZ; }
+
+	/** Returns the blocked direction sectors of every cover point */
+	const TArray<uint8>& GetProtectedSectors() const { return ProtectedSectors; }
+
+	/** Returns the sector the passed horizontal direction falls into */
+	static int32 GetSector(float DirectionX, float DirectionY);
+};
@@ -0,0 +1,263 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterCoverSubsystem.h"
+#include "ShooterCoverData.h"
+#include "ShooterAIProfiler.h"
+#include "Engine/World.h"
+#include "Algo/BinarySearch.h"
+
+DECLARE_CYCLE_STAT(TEXT("Cover Scoring"), STAT_ShooterAI_CoverScoring, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Cover Queries"), STAT_ShooterAI_CoverQueries, STATGROUP_ShooterAI);
+
+bool UShooterCoverSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer))
+	{
+		return false;
+	}
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && (World->WorldType == EWorldType::Game || World->WorldType == EWorldType::PIE);
+}
+
+void UShooterCoverSubsystem::Deinitialize()
+{
+	// running tasks keep their own reference to the cover points, so there's no need to wait for them
+	PendingQueries.Reset();
+	Claims.Reset();
+	RegisteredCoverData.Reset();
+	CoverPoints.Reset();
+
+	Super::Deinitialize();
+}
+
+void UShooterCoverSubsystem::RegisterCoverData(const UShooterCoverData* CoverData)
+{
+	if (CoverData && !RegisteredCoverData.Contains(CoverData))
+	{
+		RegisteredCoverData.Add(CoverData);
+		RebuildCoverPoints();
+	}
+}
+
+void UShooterCoverSubsystem::UnregisterCoverData(const UShooterCoverData* CoverData)
+{
+	if (RegisteredCoverData.Remove(CoverData) > 0)
+	{
+		RebuildCoverPoints();
+	}
+}
+
+void UShooterCoverSubsystem::RebuildCoverPoints()
+{
+	TSharedPtr<FCoverPoints, ESPMode::ThreadSafe> NewPoints = MakeShared<FCoverPoints, ESPMode::ThreadSafe>();
+
+	for (const TWeakObjectPtr<const UShooterCoverData>& CoverData : RegisteredCoverData)
+	{
+		if (const UShooterCoverData* Data = CoverData.Get())
+		{
+			NewPoints->X.Append(Data->GetLocationsX());
+			NewPoints->Y.Append(Data->GetLocationsY());
+			NewPoints->Z.Append(Data->GetLocationsZ());
+			NewPoints->Sectors.Append(Data->GetProtectedSectors());
+		}
+	}
+
+	CoverPoints = NewPoints;
+
+	// point indices are no longer valid
+	Claims.Reset();
+}
+
+int32 UShooterCoverSubsystem::RequestCover(FShooterCoverQuery&& Query, const UObject* Querier)
+{
+	INC_DWORD_STAT(STAT_ShooterAI_CoverQueries);
+
+	const int32 QueryId = NextQueryId++;
+
+	// gather the points claimed by other live queriers
+	TArray<int32> ExcludedPoints;
+
+	for (auto It = Claims.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+
+		} else if (It.Key().Get() != Querier)
+		{
+			ExcludedPoints.Add(It.Value());
+		}
+	}
+
+	ExcludedPoints.Sort();
+
+	FPendingQuery& PendingQuery = PendingQueries.Add(QueryId);
+	PendingQuery.Querier = Querier;
+
+	if (!CoverPoints || CoverPoints->X.Num() == 0)
+	{
+		// nothing to score, so complete the query right away
+		PendingQuery.Task = UE::Tasks::MakeCompletedTask<FShooterCoverResult>();
+
+	} else {
+
+		PendingQuery.Task = UE::Tasks::Launch(UE_SOURCE_LOCATION,
+			[Points = CoverPoints, Query = MoveTemp(Query), ExcludedPoints = MoveTemp(ExcludedPoints)]()
+			{
+				return ScoreCover(*Points, Query, ExcludedPoints);
+			});
+	}
+
+	return QueryId;
+}
+
+bool UShooterCoverSubsystem::PollCover(int32 QueryId, FShooterCoverResult& OutResult)
+{
+	FPendingQuery* PendingQuery = PendingQueries.Find(QueryId);
+
+	if (!PendingQuery)
+	{
+		OutResult = FShooterCoverResult();
+		return true;
+	}
+
+	if (!PendingQuery->Task.IsCompleted())
+	{
+		return false;
+	}
+
+	OutResult = PendingQuery->Task.GetResult();
+
+	// claim the picked point, releasing the previous one
+	if (const UObject* Querier = PendingQuery->Querier.Get())
+	{
+		if (OutResult.bFound)
+		{
+			Claims.Add(Querier, OutResult.PointIndex);
+
+		} else {
+
+			Claims.Remove(Querier);
+		}
+	}
+
+	PendingQueries.Remove(QueryId);
+
+	return true;
+}
+
+void UShooterCoverSubsystem::CancelCover(int32 QueryId)
+{
+	PendingQueries.Remove(QueryId);
+}
+
+void UShooterCoverSubsystem::ReleaseClaim(const UObject* Querier)
+{
+	Claims.Remove(Querier);
+}
+
+FShooterCoverResult UShooterCoverSubsystem::ScoreCover(const FCoverPoints& Points, const FShooterCoverQuery& Query, const TArray<int32>& ExcludedPoints)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ShooterAI_CoverScoring);
+
+	const int32 Num = Points.X.Num();
+
+	// compute the squared distance from the querier to every point, four points at a time
+	TArray<float> DistancesSquared;
+	DistancesSquared.SetNumUninitialized(Num);
+
+	const float* X = Points.X.GetData();
+	const float* Y = Points.Y.GetData();
+	const float* Z = Points.Z.GetData();
+	float* OutDistances = DistancesSquared.GetData();
+
+	const VectorRegister4Float QuerierX = VectorSetFloat1(Query.QuerierLocation.X);
+	const VectorRegister4Float QuerierY = VectorSetFloat1(Query.QuerierLocation.Y);
+	const VectorRegister4Float QuerierZ = VectorSetFloat1(Query.QuerierLocation.Z);
+
+	int32 Index = 0;
+
+	for (; Index + 4 <= Num; Index += 4)
+	{
+		const VectorRegister4Float DeltaX = VectorSubtract(VectorLoad(X + Index), QuerierX);
+		const VectorRegister4Float DeltaY = VectorSubtract(VectorLoad(Y + Index), QuerierY);
+		const VectorRegister4Float DeltaZ = VectorSubtract(VectorLoad(Z + Index), QuerierZ);
+
+		VectorStore(VectorMultiplyAdd(DeltaX, DeltaX, VectorMultiplyAdd(DeltaY, DeltaY, VectorMultiply(DeltaZ, DeltaZ))), OutDistances + Index);
+	}
+
+	for (; Index < Num; ++Index)
+	{
+		OutDistances[Index] = FVector3f::DistSquared(FVector3f(X[Index], Y[Index], Z[Index]), FVector3f(Query.QuerierLocation));
+	}
+
+	// score the points within reach
+	const float MaxDistanceSquared = FMath::Square(Query.MaxDistance);
+	const float MinThreatDistanceSquared = FMath::Square(Query.MinThreatDistance);
+	const int32 NumThreats = Query.ThreatLocations.Num();
+
+	FShooterCoverResult Result;
+
+	for (int32 PointIndex = 0; PointIndex < Num; ++PointIndex)
+	{
+		if (OutDistances[PointIndex] > MaxDistanceSquared)
+		{
+			continue;
+		}
+
+		// skip points claimed by someone else
+		if (ExcludedPoints.Num() > 0 && Algo::BinarySearch(ExcludedPoints, PointIndex) != INDEX_NONE)
+		{
+			continue;
+		}
+
+		// count the threats hidden behind the point's cover
+		int32 NumProtected = 0;
+		bool bTooClose = false;
+
+		for (const FVector& Threat : Query.ThreatLocations)
+		{
+			const float ThreatX = Threat.X - X[PointIndex];
+			const float ThreatY = Threat.Y - Y[PointIndex];
+			const float ThreatZ = Threat.Z - Z[PointIndex];
+
+			if (ThreatX * ThreatX + ThreatY * ThreatY + ThreatZ * ThreatZ < MinThreatDistanceSquared)
+			{
+				bTooClose = true;
+				break;
+			}
+
+			if (Points.Sectors[PointIndex] & (1 << UShooterCoverData::GetSector(ThreatX, ThreatY)))
+			{
+				++NumProtected;
+			}
+		}
+
+		// a point that doesn't hide us from anyone isn't cover
+		if (bTooClose || (NumThreats > 0 && NumProtected == 0))
+		{
+			continue;
+		}
+
+		// favor points that hide us from more threats, then points closer to us
+		const float Protection = NumThreats > 0 ? static_cast<float>(NumProtected) / NumThreats : 0.0f;
+		const float Proximity = Query.MaxDistance > 0.0f ? 1.0f - FMath::Sqrt(OutDistances[PointIndex]) / Query.MaxDistance : 0.0f;
+		const float Score = Query.ProtectionWeight * Protection + Proximity;
+
+		if (!Result.bFound || Score > Result.Score)
+		{
+			Result.bFound = true;
+			Result.PointIndex = PointIndex;
+			Result.Score = Score;
+		}
+	}
+
+	if (Result.bFound)
+	{
+		Result.Location = FVector(X[Result.PointIndex], Y[Result.PointIndex], Z[Result.PointIndex]);
+	}
+
+	return Result;
+}
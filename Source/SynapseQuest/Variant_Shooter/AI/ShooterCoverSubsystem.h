@@ -0,0 +1,144 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
+#include "ShooterCoverSubsystem.generated.h"
+
+class UShooterCoverData;
+
+/**
+ *  Describes a request for a cover point
+ */
+struct FShooterCoverQuery
+{
+	/** Location of the NPC looking for cover */
+	FVector QuerierLocation = FVector::ZeroVector;
+
+	/** Locations to take cover from */
+	TArray<FVector, TInlineAllocator<4>> ThreatLocations;
+
+	/** Max distance from the querier to the cover point */
+	float MaxDistance = 1500.0f;
+
+	/** Min distance from every threat to the cover point */
+	float MinThreatDistance = 400.0f;
+
+	/** Weight of the protection from threats against the distance to the querier when scoring */
+	float ProtectionWeight = 2.0f;
+};
+
+/**
+ *  Outcome of a cover query
+ */
+struct FShooterCoverResult
+{
+	/** True if a cover point was found */
+	bool bFound = false;
+
+	/** Index of the picked cover point */
+	int32 PointIndex = INDEX_NONE;
+
+	/** Location of the picked cover point, on the floor */
+	FVector Location = FVector::ZeroVector;
+
+	/** Score of the picked cover point */
+	float Score = 0.0f;
+};
+
+/**
+ *  Scores the baked cover points in the world for NPCs looking for cover
+ *  Queries run as tasks on the worker threads against an immutable snapshot of the cover points,
+ *  and are polled from the game thread. Points handed out are claimed by their querier so NPCs spread out
+ */
+UCLASS()
+class SYNAPSEQUEST_API UShooterCoverSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Merged cover points from every registered cover data asset */
+	struct FCoverPoints
+	{
+		TArray<float> X;
+		TArray<float> Y;
+		TArray<float> Z;
+		TArray<uint8> Sectors;
+	};
+
+	/** A query running on the worker threads */
+	struct FPendingQuery
+	{
+		/** Scoring task */
+		UE::Tasks::TTask<FShooterCoverResult> Task;
+
+		/** Object that will claim the result */
+		TWeakObjectPtr<const UObject> Querier;
+	};
+
+	/** Registered cover data assets */
+	TArray<TWeakObjectPtr<const UShooterCoverData>> RegisteredCoverData;
+
+	/** Current cover point snapshot. Replaced, never modified, so running queries can keep reading their copy */
+	TSharedPtr<const FCoverPoints, ESPMode::ThreadSafe> CoverPoints;
+
+	/** Queries still owned by a caller, keyed by ID */
+	TMap<int32, FPendingQuery> PendingQueries;
+
+	/** Cover point claimed by each querier */
+	TMap<TWeakObjectPtr<const UObject>, int32> Claims;
+
+	/** ID for the next query */
+	int32 NextQueryId = 1;
+
+public:
+
+	/** Only score cover in game worlds */
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	/** Drops pending queries and cover points */
+	virtual void Deinitialize() override;
+
+	/** Adds the points of the passed cover data asset to the ones scored */
+	void RegisterCoverData(const UShooterCoverData* CoverData);
+
+	/** Removes the points of the passed cover data asset */
+	void UnregisterCoverData(const UShooterCoverData* CoverData);
+
+	/**
+	 *  Starts scoring the cover points on the worker threads
+	 *  @param Query Query to run
+	 *  @param Querier Object that will claim the picked point. Points claimed by others are skipped
+	 *  @return ID to poll the query with
+	 */
+	int32 RequestCover(FShooterCoverQuery&& Query, const UObject* Querier);
+
+	/**
+	 *  Checks if a query has finished. Finished queries are forgotten after being polled
+	 *  @param QueryId ID returned by RequestCover
+	 *  @param OutResult Query result, if finished
+	 *  @return true if the query has finished or doesn't exist
+	 */
+	bool PollCover(int32 QueryId, FShooterCoverResult& OutResult);
+
+	/** Forgets about a query. It will still run to completion, but its result is discarded */
+	void CancelCover(int32 QueryId);
+
+	/** Releases the cover point claimed by the passed querier */
+	void ReleaseClaim(const UObject* Querier);
+
+	/** Returns the number of cover points being scored */
+	int32 GetNumCoverPoints() const { return CoverPoints ? CoverPoints->X.Num() : 0; }
+
+	/** Returns the number of queries waiting to be polled */
+	int32 GetNumPendingQueries() const { return PendingQueries.Num(); }
+
+protected:
+
+	/** Merges the registered cover data assets into a new snapshot. Clears the claims, since point indices change */
+	void RebuildCoverPoints();
+
+	/** Scores every cover point against the query and returns the best one. Runs on the worker threads */
+	static FShooterCoverResult ScoreCover(const FCoverPoints& Points, const FShooterCoverQuery& Query, const TArray<int32>& ExcludedPoints);
+};
@@ -3,26 +3,77 @@
 
 #include "Variant_Shooter/AI/ShooterNPC.h"
 #include "ShooterWeapon.h"
+#include "ShooterAIController.h"
+#include "ShooterRagdollSubsystem.h"
+#include "ShooterBenchmarkStats.h"
+#include "ShooterRandomSubsystem.h"
+#include "ShooterSpawnPointSubsystem.h"
+#include "ShooterCoverSubsystem.h"
+#include "ShooterTeamSubsystem.h"
+#include "SQTraceBatchSubsystem.h"
+#include "Animation/AnimInstance.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Camera/CameraComponent.h"
-#include "Kismet/KismetMathLibrary.h"
 #include "Engine/World.h"
 #include "ShooterGameMode.h"
 #include "Components/CapsuleComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "TimerManager.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+
+AShooterNPC::AShooterNPC()
+{
+	// bots are numerous and only seen from a distance, so they can update less often than players
+	SetNetUpdateFrequency(30.0f);
+	SetMinNetUpdateFrequency(5.0f);
+}
+
+void AShooterNPC::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterNPC, bIsDead, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterNPC, bDormant, Params);
+}
 
 void AShooterNPC::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// spawn the weapon
-	FActorSpawnParameters SpawnParams;
-	SpawnParams.Owner = this;
-	SpawnParams.Instigator = this;
-	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	// spawn the weapon. Clients get it through replication
+	if (HasAuthority())
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Owner = this;
+		SpawnParams.Instigator = this;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		Weapon = GetWorld()->SpawnActor<AShooterWeapon>(WeaponClass, GetActorTransform(), SpawnParams);
+	}
+
+	// let the spawn point picker know about us, unless we're waiting in a pool
+	if (!bDormant)
+	{
+		if (UShooterSpawnPointSubsystem* SpawnPoints = GetWorld()->GetSubsystem<UShooterSpawnPointSubsystem>())
+		{
+			SpawnPoints->RegisterThreat(this);
+		}
+	}
+
+	// join our team. Pooled characters count as dead until they're respawned
+	if (UShooterTeamSubsystem* Teams = UShooterTeamSubsystem::Get(this))
+	{
+		Teams->RegisterMember(this, TeamByte, !bDormant);
+	}
 
-	Weapon = GetWorld()->SpawnActor<AShooterWeapon>(WeaponClass, GetActorTransform(), SpawnParams);
+	// save the state we need to restore when respawned from a pool
+	StartingHP = CurrentHP;
+	MeshCollisionProfile = GetMesh()->GetCollisionProfileName();
+	MeshRelativeTransform = GetMesh()->GetRelativeTransform();
 }
 
 void AShooterNPC::EndPlay(const EEndPlayReason::Type EndPlayReason)
@@ -31,12 +82,30 @@ void AShooterNPC::EndPlay(const EEndPlayReason::Type EndPlayReason)
 
 	// clear the death timer
 	GetWorld()->GetTimerManager().ClearTimer(DeathTimer);
+
+	// stop being a threat
+	if (UShooterSpawnPointSubsystem* SpawnPoints = GetWorld()->GetSubsystem<UShooterSpawnPointSubsystem>())
+	{
+		SpawnPoints->UnregisterThreat(this);
+	}
+
+	// free up our cover point for others
+	if (UShooterCoverSubsystem* Cover = GetWorld()->GetSubsystem<UShooterCoverSubsystem>())
+	{
+		Cover->ReleaseClaim(this);
+	}
+
+	// leave our team
+	if (UShooterTeamSubsystem* Teams = UShooterTeamSubsystem::Get(this))
+	{
+		Teams->UnregisterMember(this);
+	}
 }
 
 float AShooterNPC::TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
-	// ignore if already dead
-	if (bIsDead)
+	// damage is server authoritative. Ignore if already dead
+	if (!HasAuthority() || bIsDead)
 	{
 		return 0.0f;
 	}
@@ -85,42 +154,177 @@ FVector AShooterNPC::GetWeaponTargetLocation()
 	// start aiming from the camera location
 	const FVector AimSource = GetFirstPersonCameraComponent()->GetComponentLocation();
 
-	FVector AimDir, AimTarget = FVector::ZeroVector;
-
 	// do we have an aim target?
 	if (CurrentAimTarget)
 	{
 		// target the actor location
-		AimTarget = CurrentAimTarget->GetActorLocation();
+		FVector AimTarget = CurrentAimTarget->GetActorLocation();
+
+		// draw from this NPC's deterministic random stream
+		const FRandomStream Random = UShooterRandomSubsystem::Draw(this);
 
 		// apply a vertical offset to target head/feet
-		AimTarget.Z += FMath::RandRange(MinAimOffsetZ, MaxAimOffsetZ);
+		AimTarget.Z += Random.FRandRange(MinAimOffsetZ, MaxAimOffsetZ);
 
 		// get the aim direction and apply randomness in a cone
-		AimDir = (AimTarget - AimSource).GetSafeNormal();
-		AimDir = UKismetMathLibrary::RandomUnitVectorInConeInDegrees(AimDir, AimVarianceHalfAngle);
+		FVector AimDir = (AimTarget - AimSource).GetSafeNormal();
+		AimDir = Random.VRandCone(AimDir, FMath::DegreesToRadians(AimVarianceHalfAngle));
 
-		
-	} else {
+		const double CurrentTime = GetWorld()->GetTimeSeconds();
+
+		// do we have an obstruction test for this target?
+		if (AimCacheTarget != CurrentAimTarget)
+		{
+			// test synchronously so the first shot of a burst is accurate
+			RefreshAimCache(AimSource, false);
 
-		// no aim target, so just use the camera facing
-		AimDir = UKismetMathLibrary::RandomUnitVectorInConeInDegrees(GetFirstPersonCameraComponent()->GetForwardVector(), AimVarianceHalfAngle);
+		} else if (CurrentTime - AimCacheTime > AimCacheDuration) {
 
+			// the test is stale, keep using it while an async refresh gets batched with the rest of the world's traces
+			RefreshAimCache(AimSource, true);
+		}
+
+		return SolveCachedAimLocation(AimSource, AimDir);
 	}
 
+	// no aim target, so just use the camera facing
+	const FVector AimDir = UShooterRandomSubsystem::Draw(this).VRandCone(GetFirstPersonCameraComponent()->GetForwardVector(), FMath::DegreesToRadians(AimVarianceHalfAngle));
+
+	return TraceAimLocation(AimSource, AimDir);
+}
+
+FVector AShooterNPC::TraceAimLocation(const FVector& AimSource, const FVector& AimDir) const
+{
 	// calculate the unobstructed aim target location
-	AimTarget = AimSource + (AimDir * AimRange);
+	const FVector AimTarget = AimSource + (AimDir * AimRange);
+
+	// run a visibility trace to see if there's obstructions. The shot goes out this frame, so don't batch it
+	FSQTraceRequest Request;
+	Request.Source = ESQTraceSource::NPCAim;
+	Request.Start = AimSource;
+	Request.End = AimTarget;
+	Request.QueryParams.AddIgnoredActor(this);
+
+	FShooterBenchmarkStats::AddSceneQueries();
 
-	// run a visibility trace to see if there's obstructions
+	if (USQTraceBatchSubsystem* Traces = USQTraceBatchSubsystem::Get(this))
+	{
+		TArray<FHitResult> OutHits;
+		Traces->TraceImmediate(Request, OutHits);
+
+		// return either the impact point or the trace end
+		return OutHits[0].bBlockingHit ? OutHits[0].ImpactPoint : OutHits[0].TraceEnd;
+	}
+
+	// no trace batching in this world, so trace directly
 	FHitResult OutHit;
+	return GetWorld()->LineTraceSingleByChannel(OutHit, Request.Start, Request.End, Request.Channel, Request.QueryParams) ? OutHit.ImpactPoint : Request.End;
+}
+
+FVector AShooterNPC::SolveCachedAimLocation(const FVector& AimSource, const FVector& AimDir) const
+{
+	// is the line to the target blocked?
+	if (!bAimCacheClear)
+	{
+		// the shot lands on whatever is covering the target
+		return AimSource + AimDir * AimCacheBlockDistance;
+	}
+
+	// test the aim ray against the target's bounding sphere
+	const FBoxSphereBounds TargetBounds = CurrentAimTarget->GetRootComponent()->Bounds;
+
+	const FVector ToCenter = TargetBounds.Origin - AimSource;
+	const double Projection = FVector::DotProduct(ToCenter, AimDir);
+	const double DistSquared = ToCenter.SizeSquared() - FMath::Square(Projection);
+	const double RadiusSquared = FMath::Square(TargetBounds.SphereRadius);
+
+	if (Projection > 0.0 && DistSquared <= RadiusSquared)
+	{
+		// return the near intersection with the sphere
+		return AimSource + AimDir * (Projection - FMath::Sqrt(RadiusSquared - DistSquared));
+	}
+
+	// the shot misses the target. The projectile will collide with anything behind it on its own,
+	// so a point far along the aim ray is all the weapon needs to orient the shot
+	return AimSource + AimDir * AimRange;
+}
 
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this);
+void AShooterNPC::RefreshAimCache(const FVector& AimSource, bool bAsync)
+{
+	USQTraceBatchSubsystem* Traces = USQTraceBatchSubsystem::Get(this);
+
+	if (!Traces)
+	{
+		return;
+	}
+
+	FSQTraceRequest Request;
+	Request.Source = ESQTraceSource::NPCAim;
+	Request.Start = AimSource;
+	Request.End = CurrentAimTarget->GetActorLocation();
+	Request.QueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(ShooterNPCAim), false, this);
+	Request.QueryParams.AddIgnoredActor(CurrentAimTarget);
+
+	if (bAsync)
+	{
+		// don't queue a new test while one is in flight
+		if (Traces->IsTracePending(AimCacheTraceId))
+		{
+			return;
+		}
+
+		// tests from every NPC go out together with the rest of the frame's batched traces
+		AimCacheTraceId = Traces->SubmitTrace(Request, [WeakThis = TWeakObjectPtr<AShooterNPC>(this)](const TArray<FHitResult>& Hits)
+		{
+			if (AShooterNPC* NPC = WeakThis.Get())
+			{
+				NPC->OnAimCacheTraceCompleted(Hits);
+			}
+		});
+
+		FShooterBenchmarkStats::AddSceneQueries();
+
+	} else {
+
+		TArray<FHitResult> OutHits;
+		const bool bBlocked = Traces->TraceImmediate(Request, OutHits);
+		FShooterBenchmarkStats::AddSceneQueries();
 
-	GetWorld()->LineTraceSingleByChannel(OutHit, AimSource, AimTarget, ECC_Visibility, QueryParams);
+		StoreAimCache(CurrentAimTarget, bBlocked ? &OutHits[0] : nullptr);
+
+		// drop any batched test queued for the previous target
+		Traces->CancelTrace(AimCacheTraceId);
+		AimCacheTraceId = 0;
+	}
+}
 
-	// return either the impact point or the trace end
-	return OutHit.bBlockingHit ? OutHit.ImpactPoint : OutHit.TraceEnd;
+void AShooterNPC::StoreAimCache(AActor* Target, const FHitResult* BlockingHit)
+{
+	AimCacheTarget = Target;
+	bAimCacheClear = BlockingHit == nullptr;
+	AimCacheBlockDistance = BlockingHit ? BlockingHit->Distance : 0.0f;
+	AimCacheTime = GetWorld()->GetTimeSeconds();
+}
+
+void AShooterNPC::OnAimCacheTraceCompleted(const TArray<FHitResult>& Hits)
+{
+	AimCacheTraceId = 0;
+
+	// ignore results that come in after death
+	if (bIsDead)
+	{
+		return;
+	}
+
+	// ignore results for a target we've since switched from
+	if (AimCacheTarget != CurrentAimTarget)
+	{
+		return;
+	}
+
+	const FHitResult* BlockingHit = Hits.FindByPredicate([](const FHitResult& Hit) { return Hit.bBlockingHit; });
+
+	StoreAimCache(CurrentAimTarget, BlockingHit);
 }
 
 void AShooterNPC::AddWeaponClass(const TSubclassOf<AShooterWeapon>& InWeaponClass)
@@ -158,10 +362,29 @@ void AShooterNPC::Die()
 
 	// raise the dead flag
 	bIsDead = true;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterNPC, bIsDead, this);
 
 	// grant the death tag to the character
 	Tags.Add(DeathTag);
 
+	// stop being a threat
+	if (UShooterSpawnPointSubsystem* SpawnPoints = GetWorld()->GetSubsystem<UShooterSpawnPointSubsystem>())
+	{
+		SpawnPoints->UnregisterThreat(this);
+	}
+
+	// free up our cover point for others
+	if (UShooterCoverSubsystem* Cover = GetWorld()->GetSubsystem<UShooterCoverSubsystem>())
+	{
+		Cover->ReleaseClaim(this);
+	}
+
+	// stop being a valid target
+	if (UShooterTeamSubsystem* Teams = UShooterTeamSubsystem::Get(this))
+	{
+		Teams->SetAlive(this, false);
+	}
+
 	// call the delegate
 	OnPawnDeath.Broadcast();
 
@@ -171,24 +394,112 @@ void AShooterNPC::Die()
 		GM->IncrementTeamScore(TeamByte);
 	}
 
+	// stop any path following
+	GetCharacterMovement()->StopActiveMovement();
+
+	// clients play the effects when the dead flag replicates
+	PlayDeathEffects();
+
+	// schedule actor destruction
+	GetWorld()->GetTimerManager().SetTimer(DeathTimer, this, &AShooterNPC::DeferredDestruction, DeferredDestructionTime, false);
+}
+
+void AShooterNPC::PlayDeathEffects()
+{
 	// disable capsule collision
 	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 
 	// stop movement
 	GetCharacterMovement()->StopMovementImmediately();
-	GetCharacterMovement()->StopActiveMovement();
 
-	// enable ragdoll physics on the third person mesh
-	GetMesh()->SetCollisionProfileName(RagdollCollisionProfile);
-	GetMesh()->SetSimulatePhysics(true);
-	GetMesh()->SetPhysicsBlendWeight(1.0f);
+	// ask the ragdoll budget for a slot. Without a death animation to fall back on we always need one
+	UShooterRagdollSubsystem* Ragdolls = GetWorld()->GetSubsystem<UShooterRagdollSubsystem>();
+	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
 
-	// schedule actor destruction
-	GetWorld()->GetTimerManager().SetTimer(DeathTimer, this, &AShooterNPC::DeferredDestruction, DeferredDestructionTime, false);
+	const bool bCanPlayDeathMontage = DeathMontage && AnimInstance;
+
+	if (!Ragdolls || Ragdolls->RequestRagdoll(GetMesh(), !bCanPlayDeathMontage))
+	{
+		// enable ragdoll physics on the third person mesh
+		GetMesh()->SetCollisionProfileName(RagdollCollisionProfile);
+		GetMesh()->SetSimulatePhysics(true);
+		GetMesh()->SetPhysicsBlendWeight(1.0f);
+
+	} else {
+
+		// over budget, so play the death animation instead
+		AnimInstance->Montage_Play(DeathMontage);
+	}
+}
+
+void AShooterNPC::ResetDeathEffects()
+{
+	// turn off the ragdoll or death animation and snap the mesh back onto the capsule
+	if (UShooterRagdollSubsystem* Ragdolls = GetWorld()->GetSubsystem<UShooterRagdollSubsystem>())
+	{
+		Ragdolls->ReleaseRagdoll(GetMesh());
+	}
+
+	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+	{
+		AnimInstance->StopAllMontages(0.0f);
+	}
+
+	GetMesh()->SetSimulatePhysics(false);
+	GetMesh()->SetPhysicsBlendWeight(0.0f);
+	GetMesh()->SetCollisionProfileName(MeshCollisionProfile);
+	GetMesh()->AttachToComponent(GetCapsuleComponent(), FAttachmentTransformRules::KeepRelativeTransform);
+	GetMesh()->SetRelativeTransform(MeshRelativeTransform);
+
+	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+}
+
+void AShooterNPC::ApplyDormantState()
+{
+	if (bDormant)
+	{
+		// give back the ragdoll slot and stop any physics left over from it
+		if (UShooterRagdollSubsystem* Ragdolls = GetWorld()->GetSubsystem<UShooterRagdollSubsystem>())
+		{
+			Ragdolls->ReleaseRagdoll(GetMesh());
+		}
+
+		GetMesh()->SetSimulatePhysics(false);
+	}
+
+	// hide or show the character
+	SetActorHiddenInGame(bDormant);
+	SetActorEnableCollision(!bDormant);
+	SetActorTickEnabled(!bDormant);
+}
+
+void AShooterNPC::OnRep_IsDead()
+{
+	if (bIsDead)
+	{
+		PlayDeathEffects();
+
+	} else {
+
+		ResetDeathEffects();
+
+	}
+}
+
+void AShooterNPC::OnRep_Dormant()
+{
+	ApplyDormantState();
 }
 
 void AShooterNPC::DeferredDestruction()
 {
+	// pooled characters go back to their spawner instead
+	if (bPooled)
+	{
+		EnterDormancy();
+		return;
+	}
+
 	Destroy();
 }
 
@@ -212,3 +523,154 @@ void AShooterNPC::StopShooting()
 	// signal the weapon
 	Weapon->StopFiring();
 }
+
+void AShooterNPC::SetTeam(uint8 NewTeam)
+{
+	TeamByte = NewTeam;
+
+	// keep the team registry up to date
+	if (UShooterTeamSubsystem* Teams = UShooterTeamSubsystem::Get(this))
+	{
+		Teams->SetTeam(this, TeamByte);
+	}
+
+	// perception caches the listener team, so let the controller refresh it
+	if (AShooterAIController* AIController = GetController<AShooterAIController>())
+	{
+		AIController->OnPawnTeamChanged();
+	}
+}
+
+ETeamAttitude::Type AShooterNPC::GetTeamAttitudeTowards(const AActor& Other) const
+{
+	if (const UShooterTeamSubsystem* Teams = UShooterTeamSubsystem::Get(this))
+	{
+		return Teams->GetAttitude(this, &Other);
+	}
+
+	return IGenericTeamAgentInterface::GetTeamAttitudeTowards(Other);
+}
+
+void AShooterNPC::InitPooled()
+{
+	// the controller checks the dormant flag on possession so it doesn't start the AI logic
+	bPooled = true;
+	bDormant = true;
+}
+
+void AShooterNPC::EnterDormancy()
+{
+	bDormant = true;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterNPC, bDormant, this);
+
+	// hide the character and its weapon
+	ApplyDormantState();
+
+	if (Weapon)
+	{
+		Weapon->SetActorHiddenInGame(true);
+	}
+
+	GetCharacterMovement()->DisableMovement();
+}
+
+void AShooterNPC::Withdraw()
+{
+	// only live pooled characters can withdraw
+	if (!bPooled || bDormant || bIsDead)
+	{
+		return;
+	}
+
+	if (bIsShooting)
+	{
+		StopShooting();
+	}
+
+	// stop being a threat
+	if (UShooterSpawnPointSubsystem* SpawnPoints = GetWorld()->GetSubsystem<UShooterSpawnPointSubsystem>())
+	{
+		SpawnPoints->UnregisterThreat(this);
+	}
+
+	// free up our cover point for others
+	if (UShooterCoverSubsystem* Cover = GetWorld()->GetSubsystem<UShooterCoverSubsystem>())
+	{
+		Cover->ReleaseClaim(this);
+	}
+
+	// stop being a valid target
+	if (UShooterTeamSubsystem* Teams = UShooterTeamSubsystem::Get(this))
+	{
+		Teams->SetAlive(this, false);
+	}
+
+	// stop the AI logic until we're respawned
+	if (AShooterAIController* AIController = GetController<AShooterAIController>())
+	{
+		AIController->StopPawnLogic();
+	}
+
+	EnterDormancy();
+}
+
+void AShooterNPC::ResetForSpawn(const FTransform& SpawnTransform)
+{
+	// clear any pending death cleanup
+	GetWorld()->GetTimerManager().ClearTimer(DeathTimer);
+
+	// reset the gameplay state
+	CurrentHP = StartingHP;
+	bIsDead = false;
+	bIsShooting = false;
+	bDormant = false;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterNPC, bIsDead, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterNPC, bDormant, this);
+	CurrentAimTarget = nullptr;
+	AimCacheTarget = nullptr;
+
+	if (USQTraceBatchSubsystem* Traces = USQTraceBatchSubsystem::Get(this))
+	{
+		Traces->CancelTrace(AimCacheTraceId);
+	}
+
+	AimCacheTraceId = 0;
+
+	Tags.Remove(DeathTag);
+
+	// turn off the ragdoll or death animation
+	ResetDeathEffects();
+
+	// move to the spawn location
+	TeleportTo(SpawnTransform.GetLocation(), SpawnTransform.Rotator(), false, true);
+
+	// show the character and restore collision and movement
+	ApplyDormantState();
+
+	GetCharacterMovement()->SetDefaultMovementMode();
+
+	// restore the weapon
+	if (Weapon)
+	{
+		Weapon->SetActorHiddenInGame(false);
+		Weapon->RefillMagazine();
+	}
+
+	// become a threat again
+	if (UShooterSpawnPointSubsystem* SpawnPoints = GetWorld()->GetSubsystem<UShooterSpawnPointSubsystem>())
+	{
+		SpawnPoints->RegisterThreat(this);
+	}
+
+	// become a valid target again
+	if (UShooterTeamSubsystem* Teams = UShooterTeamSubsystem::Get(this))
+	{
+		Teams->SetAlive(this, true);
+	}
+
+	// restart the AI logic
+	if (AShooterAIController* AIController = GetController<AShooterAIController>())
+	{
+		AIController->RestartPawnLogic();
+	}
+}
@@ -5,11 +5,13 @@
 #include "CoreMinimal.h"
 #include "SynapseQuestCharacter.h"
 #include "ShooterWeaponHolder.h"
+#include "GenericTeamAgentInterface.h"
 #include "ShooterNPC.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FPawnDeathDelegate);
 
 class AShooterWeapon;
+class UAnimMontage;
 
 /**
  *  A simple AI-controlled shooter game NPC
@@ -17,7 +19,7 @@ class AShooterWeapon;
  *  Holds and manages a weapon
  */
 UCLASS(abstract)
-class SYNAPSEQUEST_API AShooterNPC : public ASynapseQuestCharacter, public IShooterWeaponHolder
+class SYNAPSEQUEST_API AShooterNPC : public ASynapseQuestCharacter, public IShooterWeaponHolder, public IGenericTeamAgentInterface
 {
 	GENERATED_BODY()
 
@@ -33,6 +35,10 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Damage")
 	FName RagdollCollisionProfile = FName("Ragdoll");
 
+	/** Death animation played when the ragdoll budget is full. Should have auto blend out disabled so the character stays down */
+	UPROPERTY(EditAnywhere, Category="Damage")
+	TObjectPtr<UAnimMontage> DeathMontage;
+
 	/** Time to wait after death before destroying this actor */
 	UPROPERTY(EditAnywhere, Category="Damage")
 	float DeferredDestructionTime = 5.0f;
@@ -76,15 +82,51 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Aim")
 	float MaxAimOffsetZ = -60.0f;
 
+	/** Time to reuse the obstruction test against the aim target before refreshing it */
+	UPROPERTY(EditAnywhere, Category="Aim", meta = (ClampMin = 0, ClampMax = 2, Units = "s"))
+	float AimCacheDuration = 0.25f;
+
 	/** Actor currently being targeted */
 	TObjectPtr<AActor> CurrentAimTarget;
 
+	/** Target the cached obstruction test belongs to */
+	TWeakObjectPtr<AActor> AimCacheTarget;
+
+	/** If true, the cached line from the aim source to the target is unobstructed */
+	bool bAimCacheClear = false;
+
+	/** Distance to the obstruction when the cached line is blocked */
+	float AimCacheBlockDistance = 0.0f;
+
+	/** World time the obstruction test was last refreshed */
+	double AimCacheTime = -1.0;
+
+	/** Id of the pending batched obstruction test, or 0 if there's none */
+	uint32 AimCacheTraceId = 0;
+
 	/** If true, this character is currently shooting its weapon */
 	bool bIsShooting = false;
 
 	/** If true, this character has already died */
+	UPROPERTY(ReplicatedUsing=OnRep_IsDead)
 	bool bIsDead = false;
 
+	/** If true, this character is owned by a spawner pool and goes dormant on death instead of being destroyed */
+	bool bPooled = false;
+
+	/** If true, this character is waiting in a spawner pool. It's hidden, without collision and its AI logic is stopped */
+	UPROPERTY(ReplicatedUsing=OnRep_Dormant)
+	bool bDormant = false;
+
+	/** HP to restore when respawned from a pool */
+	float StartingHP = 0.0f;
+
+	/** Third person mesh collision profile to restore when respawned from a pool */
+	FName MeshCollisionProfile;
+
+	/** Third person mesh relative transform to restore when respawned from a pool */
+	FTransform MeshRelativeTransform;
+
 	/** Deferred destruction on death timer */
 	FTimerHandle DeathTimer;
 
@@ -93,6 +135,14 @@ public:
 	/** Delegate called when this NPC dies */
 	FPawnDeathDelegate OnPawnDeath;
 
+public:
+
+	/** Constructor */
+	AShooterNPC();
+
+	/** Sets up push model replication */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 protected:
 
 	/** Gameplay initialization */
@@ -139,6 +189,21 @@ public:
 
 	//~End IShooterWeaponHolder interface
 
+public:
+
+	//~Begin IGenericTeamAgentInterface
+
+	/** Assigns this character to a team */
+	virtual void SetGenericTeamId(const FGenericTeamId& NewTeamID) override { SetTeam(NewTeamID.GetId()); }
+
+	/** Returns the team this character belongs to */
+	virtual FGenericTeamId GetGenericTeamId() const override { return FGenericTeamId(TeamByte); }
+
+	/** Returns how this character feels about the passed actor */
+	virtual ETeamAttitude::Type GetTeamAttitudeTowards(const AActor& Other) const override;
+
+	//~End IGenericTeamAgentInterface
+
 protected:
 
 	/** Called when HP is depleted and the character should die */
@@ -147,6 +212,38 @@ protected:
 	/** Called after death to destroy the actor */
 	void DeferredDestruction();
 
+	/** Stops the capsule and plays the ragdoll or death animation. Runs on the server and every client */
+	void PlayDeathEffects();
+
+	/** Undoes the death effects and snaps the mesh back onto the capsule */
+	void ResetDeathEffects();
+
+	/** Shows or hides this character according to its dormant flag */
+	void ApplyDormantState();
+
+	/** Plays or resets the death on clients */
+	UFUNCTION()
+	void OnRep_IsDead();
+
+	/** Hides or shows this character on clients */
+	UFUNCTION()
+	void OnRep_Dormant();
+
+	/** Runs a full range aim trace along the passed direction. Used when there's no target to aim at */
+	FVector TraceAimLocation(const FVector& AimSource, const FVector& AimDir) const;
+
+	/** Resolves the aim location against the target using the cached obstruction test, without tracing */
+	FVector SolveCachedAimLocation(const FVector& AimSource, const FVector& AimDir) const;
+
+	/** Refreshes the cached obstruction test against the current aim target */
+	void RefreshAimCache(const FVector& AimSource, bool bAsync);
+
+	/** Stores the result of an obstruction test against the aim target */
+	void StoreAimCache(AActor* Target, const FHitResult* BlockingHit);
+
+	/** Handles batched obstruction test results */
+	void OnAimCacheTraceCompleted(const TArray<FHitResult>& Hits);
+
 public:
 
 	/** Signals this character to start shooting at the passed actor */
@@ -154,4 +251,31 @@ public:
 
 	/** Signals this character to stop shooting */
 	void StopShooting();
+
+	/** Marks this character as owned by a spawner pool. Must be called before it finishes spawning */
+	void InitPooled();
+
+	/** Hides and disables a pooled character so it can wait for its next spawn */
+	void EnterDormancy();
+
+	/** Resets and activates a dormant pooled character at the passed transform */
+	void ResetForSpawn(const FTransform& SpawnTransform);
+
+	/** Sends a live pooled character back to dormancy without dying */
+	void Withdraw();
+
+	/** Assigns this character to a team */
+	void SetTeam(uint8 NewTeam);
+
+	/** Returns the team this character belongs to */
+	uint8 GetTeam() const { return TeamByte; }
+
+	/** Returns true if this character is owned by a spawner pool */
+	bool IsPooled() const { return bPooled; }
+
+	/** Returns true if this character is waiting in a spawner pool */
+	bool IsDormant() const { return bDormant; }
+
+	/** Returns true if this character has died */
+	bool IsDead() const { return bIsDead; }
 };
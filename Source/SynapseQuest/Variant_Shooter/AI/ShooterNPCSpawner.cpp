@@ -38,6 +38,12 @@ void AShooterNPCSpawner::BeginPlay()
 	{
 		// schedule the first NPC spawn
 		GetWorld()->GetTimerManager().SetTimer(SpawnTimer, this, &AShooterNPCSpawner::SpawnNPC, InitialSpawnDelay);
+
+		// pre-warm the pool while we wait
+		if (GetTargetPoolSize() > 0)
+		{
+			PrewarmTimer = GetWorld()->GetTimerManager().SetTimerForNextTick(this, &AShooterNPCSpawner::PrewarmPool);
+		}
 	}
 }
 
@@ -45,28 +51,172 @@ void AShooterNPCSpawner::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
-	// clear the spawn timer
+	// clear the timers
 	GetWorld()->GetTimerManager().ClearTimer(SpawnTimer);
+	GetWorld()->GetTimerManager().ClearTimer(PrewarmTimer);
+}
+
+void AShooterNPCSpawner::ConfigureSpawner(TSubclassOf<AShooterNPC> InNPCClass, int32 InSpawnCount, float InInitialSpawnDelay, float InRespawnDelay, int32 InTeam)
+{
+	NPCClass = InNPCClass;
+	SpawnCount = InSpawnCount;
+	InitialSpawnDelay = InInitialSpawnDelay;
+	RespawnDelay = InRespawnDelay;
+
+	bOverrideTeam = InTeam != INDEX_NONE;
+
+	if (bOverrideTeam)
+	{
+		TeamOverride = static_cast<uint8>(InTeam);
+	}
+}
+
+int32 AShooterNPCSpawner::SpawnTeamSpawners(UWorld* World, TSubclassOf<AShooterNPC> InNPCClass, const TArray<FTransform>& SpawnPoints, int32 NPCsPerTeam)
+{
+	if (!World || !InNPCClass || SpawnPoints.Num() == 0)
+	{
+		return 0;
+	}
+
+	// split the spawn points between the two teams, so they start on opposite sides of the map where possible
+	const int32 HalfPoints = FMath::Max(1, SpawnPoints.Num() / 2);
+	int32 NumSpawned = 0;
+
+	for (int32 Team = 1; Team <= 2; ++Team)
+	{
+		for (int32 i = 0; i < NPCsPerTeam; ++i)
+		{
+			const int32 PointIndex = Team == 1 ? i % HalfPoints : (HalfPoints + i % HalfPoints) % SpawnPoints.Num();
+
+			// stagger the spawns so they don't all land on the same frame
+			const float InitialDelay = 0.1f * i;
+
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.bDeferConstruction = true;
+
+			AShooterNPCSpawner* Spawner = World->SpawnActor<AShooterNPCSpawner>(AShooterNPCSpawner::StaticClass(), SpawnPoints[PointIndex], SpawnParams);
+
+			if (Spawner)
+			{
+				// keep respawning for as long as the world runs
+				Spawner->ConfigureSpawner(InNPCClass, MAX_int32, InitialDelay, 1.0f, Team);
+
+				// these respawn constantly, so reuse their NPCs instead of creating new ones
+				Spawner->PoolSize = 2;
+				Spawner->FinishSpawning(SpawnPoints[PointIndex]);
+
+				++NumSpawned;
+			}
+		}
+	}
+
+	return NumSpawned;
 }
 
 void AShooterNPCSpawner::SpawnNPC()
 {
 	// ensure the NPC class is valid
-	if (IsValid(NPCClass))
+	if (!IsValid(NPCClass))
+	{
+		return;
+	}
+
+	// are we pooling NPCs?
+	if (GetTargetPoolSize() > 0)
 	{
-		// spawn the NPC at the reference capsule's transform
-		FActorSpawnParameters SpawnParams;
-		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+		// find a dormant NPC
+		AShooterNPC* PooledNPC = nullptr;
+
+		for (AShooterNPC* CurrentNPC : Pool)
+		{
+			if (IsValid(CurrentNPC) && CurrentNPC->IsDormant())
+			{
+				PooledNPC = CurrentNPC;
+				break;
+			}
+		}
+
+		// the pool may not be warm yet, or every NPC may still be waiting on its death timer
+		if (!PooledNPC)
+		{
+			PooledNPC = CreatePooledNPC();
+		}
+
+		// reset and activate the NPC
+		if (PooledNPC)
+		{
+			PooledNPC->ResetForSpawn(SpawnCapsule->GetComponentTransform());
+		}
+
+		return;
+	}
+
+	// spawn the NPC at the reference capsule's transform
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
 
-		AShooterNPC* SpawnedNPC = GetWorld()->SpawnActor<AShooterNPC>(NPCClass, SpawnCapsule->GetComponentTransform(), SpawnParams);
+	AShooterNPC* SpawnedNPC = GetWorld()->SpawnActor<AShooterNPC>(NPCClass, SpawnCapsule->GetComponentTransform(), SpawnParams);
 
-		// was the NPC successfully created?
-		if (SpawnedNPC)
+	// was the NPC successfully created?
+	if (SpawnedNPC)
+	{
+		// assign the team
+		if (bOverrideTeam)
 		{
-			// subscribe to the death delegate
-			SpawnedNPC->OnPawnDeath.AddDynamic(this, &AShooterNPCSpawner::OnNPCDied);
+			SpawnedNPC->SetTeam(TeamOverride);
 		}
+
+		// subscribe to the death delegate
+		SpawnedNPC->OnPawnDeath.AddDynamic(this, &AShooterNPCSpawner::OnNPCDied);
+	}
+}
+
+void AShooterNPCSpawner::PrewarmPool()
+{
+	// stop once the pool is full
+	if (!IsValid(NPCClass) || Pool.Num() >= GetTargetPoolSize())
+	{
+		return;
+	}
+
+	CreatePooledNPC();
+
+	// spread the rest of the spawns across frames
+	if (Pool.Num() < GetTargetPoolSize())
+	{
+		PrewarmTimer = GetWorld()->GetTimerManager().SetTimerForNextTick(this, &AShooterNPCSpawner::PrewarmPool);
+	}
+}
+
+AShooterNPC* AShooterNPCSpawner::CreatePooledNPC()
+{
+	// defer the spawn so the NPC is flagged as dormant before its controller possesses it
+	AShooterNPC* PooledNPC = GetWorld()->SpawnActorDeferred<AShooterNPC>(NPCClass, SpawnCapsule->GetComponentTransform(), nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+
+	if (!PooledNPC)
+	{
+		return nullptr;
 	}
+
+	PooledNPC->InitPooled();
+
+	// assign the team
+	if (bOverrideTeam)
+	{
+		PooledNPC->SetTeam(TeamOverride);
+	}
+
+	PooledNPC->FinishSpawning(SpawnCapsule->GetComponentTransform());
+
+	// hide it until it's needed
+	PooledNPC->EnterDormancy();
+
+	// subscribe to the death delegate once for the lifetime of the NPC
+	PooledNPC->OnPawnDeath.AddDynamic(this, &AShooterNPCSpawner::OnNPCDied);
+
+	Pool.Add(PooledNPC);
+
+	return PooledNPC;
 }
 
 void AShooterNPCSpawner::OnNPCDied()
@@ -13,6 +13,7 @@ class AShooterNPC;
 /**
  *  A basic Actor in charge of spawning Shooter NPCs and monitoring their deaths.
  *  NPCs will be spawned one by one, and the spawner will wait until it dies before spawning a new one.
+ *  NPCs are pre-spawned dormant while waiting for the first spawn, and return to the pool when they die.
  */
 UCLASS()
 class SYNAPSEQUEST_API AShooterNPCSpawner : public AActor
@@ -43,9 +44,28 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="NPC Spawner", meta = (ClampMin = 0, ClampMax = 10))
 	float RespawnDelay = 5.0f;
 
+	/** If true, spawned NPCs are assigned to the team below instead of their class default */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="NPC Spawner|Team", meta = (InlineEditConditionToggle))
+	bool bOverrideTeam = false;
+
+	/** Team to assign to spawned NPCs */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="NPC Spawner|Team", meta = (EditCondition = "bOverrideTeam"))
+	uint8 TeamOverride = 1;
+
+	/** Number of NPCs to pre-spawn dormant so respawns don't need to create new actors. Capped to the spawn count. Zero turns pooling off */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="NPC Spawner|Pool", meta = (ClampMin = 0, ClampMax = 10))
+	int32 PoolSize = 0;
+
+	/** Pooled NPCs, both dormant and active */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<AShooterNPC>> Pool;
+
 	/** Timer to spawn NPCs after a delay */
 	FTimerHandle SpawnTimer;
 
+	/** Timer to pre-warm the pool one NPC per frame */
+	FTimerHandle PrewarmTimer;
+
 public:	
 	
 	/** Constructor */
@@ -59,11 +79,44 @@ public:
 	/** Cleanup */
 	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
 
+	/**
+	 *  Sets up a spawner created at runtime. Must be called before it finishes spawning
+	 *  @param InNPCClass Type of NPC to spawn
+	 *  @param InSpawnCount Number of NPCs to spawn
+	 *  @param InInitialSpawnDelay Time to wait before spawning the first NPC
+	 *  @param InRespawnDelay Time to wait before spawning the next NPC after the current one dies
+	 *  @param InTeam Team to assign to spawned NPCs, or INDEX_NONE to keep the class default
+	 */
+	void ConfigureSpawner(TSubclassOf<AShooterNPC> InNPCClass, int32 InSpawnCount, float InInitialSpawnDelay, float InRespawnDelay, int32 InTeam = INDEX_NONE);
+
+	/**
+	 *  Creates endlessly respawning, pooled spawners for teams 1 and 2, used by the benchmarks
+	 *  The first half of the spawn points goes to team 1 and the second half to team 2, so the teams start apart where possible
+	 *  @param World World to spawn in
+	 *  @param InNPCClass Type of NPC to spawn
+	 *  @param SpawnPoints Transforms to place the spawners at. Must not be empty
+	 *  @param NPCsPerTeam Number of spawners to create for each team
+	 *  @return Number of spawners created
+	 */
+	static int32 SpawnTeamSpawners(UWorld* World, TSubclassOf<AShooterNPC> InNPCClass, const TArray<FTransform>& SpawnPoints, int32 NPCsPerTeam);
+
+	/** Returns the type of NPC this spawner creates */
+	TSubclassOf<AShooterNPC> GetNPCClass() const { return NPCClass; }
+
 protected:
 
 	/** Spawn an NPC and subscribe to its death event */
 	void SpawnNPC();
 
+	/** Adds a dormant NPC to the pool. Schedules itself for the next frame until the pool is full */
+	void PrewarmPool();
+
+	/** Creates a dormant NPC, adds it to the pool and returns it */
+	AShooterNPC* CreatePooledNPC();
+
+	/** Returns the number of pooled NPCs to keep */
+	int32 GetTargetPoolSize() const { return FMath::Min(PoolSize, SpawnCount); }
+
 	/** Called when the spawned NPC has died */
 	UFUNCTION()
 	void OnNPCDied();
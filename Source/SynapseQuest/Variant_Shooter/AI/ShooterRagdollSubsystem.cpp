@@ -0,0 +1,212 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterRagdollSubsystem.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Ragdoll Budget Tick"), STAT_ShooterRagdollTick, STATGROUP_ShooterRagdolls);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active Ragdolls"), STAT_ShooterActiveRagdolls, STATGROUP_ShooterRagdolls);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Simulated Ragdoll Bodies"), STAT_ShooterRagdollBodies, STATGROUP_ShooterRagdolls);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Ragdolls Frozen"), STAT_ShooterRagdollsFrozen, STATGROUP_ShooterRagdolls);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Ragdolls Denied"), STAT_ShooterRagdollsDenied, STATGROUP_ShooterRagdolls);
+
+static TAutoConsoleVariable<int32> CVarShooterMaxActiveRagdolls(
+	TEXT("Shooter.Ragdolls.MaxActive"),
+	6,
+	TEXT("Max number of death ragdolls simulating physics at the same time."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarShooterRagdollMaxSimulationTime(
+	TEXT("Shooter.Ragdolls.MaxSimulationTime"),
+	3.0f,
+	TEXT("Seconds a ragdoll may simulate before it's frozen in its current pose."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarShooterRagdollMinSimulationTime(
+	TEXT("Shooter.Ragdolls.MinSimulationTime"),
+	0.5f,
+	TEXT("Seconds a ragdoll must simulate before it can be frozen to make room for a new one, or frozen because its bodies went to sleep."),
+	ECVF_Default);
+
+/** Distance that weighs the same as one second of age when picking a ragdoll to freeze */
+static constexpr float RagdollEvictionDistancePerSecond = 1000.0f;
+
+bool UShooterRagdollSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UShooterRagdollSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterRagdollSubsystem, STATGROUP_Tickables);
+}
+
+bool UShooterRagdollSubsystem::RequestRagdoll(USkeletalMeshComponent* Mesh, bool bForce)
+{
+	if (!Mesh)
+	{
+		return false;
+	}
+
+	// is the budget full?
+	if (ActiveRagdolls.Num() >= CVarShooterMaxActiveRagdolls.GetValueOnGameThread())
+	{
+		const int32 Candidate = FindEvictionCandidate(bForce);
+
+		if (Candidate == INDEX_NONE)
+		{
+			++TotalDenied;
+			INC_DWORD_STAT(STAT_ShooterRagdollsDenied);
+			return false;
+		}
+
+		FreezeRagdoll(Candidate);
+	}
+
+	FActiveRagdoll& Ragdoll = ActiveRagdolls.AddDefaulted_GetRef();
+	Ragdoll.Mesh = Mesh;
+	Ragdoll.StartTime = GetWorld()->GetTimeSeconds();
+
+	return true;
+}
+
+void UShooterRagdollSubsystem::ReleaseRagdoll(USkeletalMeshComponent* Mesh)
+{
+	if (!Mesh)
+	{
+		return;
+	}
+
+	ActiveRagdolls.RemoveAllSwap([Mesh](const FActiveRagdoll& Ragdoll) { return Ragdoll.Mesh == Mesh; });
+
+	// let the skeleton update again
+	Mesh->bNoSkeletonUpdate = false;
+}
+
+void UShooterRagdollSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_ShooterRagdollTick);
+
+	const double CurrentTime = GetWorld()->GetTimeSeconds();
+	const float MaxSimulationTime = CVarShooterRagdollMaxSimulationTime.GetValueOnGameThread();
+	const float MinSimulationTime = CVarShooterRagdollMinSimulationTime.GetValueOnGameThread();
+
+	int32 NumBodies = 0;
+
+	// iterate back to front so we can remove while iterating
+	for (int32 i = ActiveRagdolls.Num() - 1; i >= 0; --i)
+	{
+		USkeletalMeshComponent* Mesh = ActiveRagdolls[i].Mesh.Get();
+
+		// drop ragdolls whose owner was destroyed or that stopped simulating on their own
+		if (!IsValid(Mesh) || !Mesh->IsSimulatingPhysics())
+		{
+			ActiveRagdolls.RemoveAtSwap(i, EAllowShrinking::No);
+			continue;
+		}
+
+		const double Age = CurrentTime - ActiveRagdolls[i].StartTime;
+
+		// freeze ragdolls that ran out of time or came to rest
+		if (Age >= MaxSimulationTime || (Age >= MinSimulationTime && !Mesh->IsAnyRigidBodyAwake()))
+		{
+			FreezeRagdoll(i);
+			continue;
+		}
+
+		NumBodies += Mesh->Bodies.Num();
+	}
+
+	SET_DWORD_STAT(STAT_ShooterActiveRagdolls, ActiveRagdolls.Num());
+	SET_DWORD_STAT(STAT_ShooterRagdollBodies, NumBodies);
+}
+
+int32 UShooterRagdollSubsystem::FindEvictionCandidate(bool bForce) const
+{
+	// gather the player view locations
+	TArray<FVector, TInlineAllocator<4>> ViewLocations;
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* PC = It->Get())
+		{
+			if (PC->PlayerCameraManager)
+			{
+				ViewLocations.Add(PC->PlayerCameraManager->GetCameraLocation());
+			}
+		}
+	}
+
+	const double CurrentTime = GetWorld()->GetTimeSeconds();
+	const float MinSimulationTime = CVarShooterRagdollMinSimulationTime.GetValueOnGameThread();
+
+	int32 BestIndex = INDEX_NONE;
+	double BestScore = -1.0;
+
+	for (int32 i = 0; i < ActiveRagdolls.Num(); ++i)
+	{
+		const USkeletalMeshComponent* Mesh = ActiveRagdolls[i].Mesh.Get();
+
+		if (!IsValid(Mesh))
+		{
+			// a stale entry is always the best candidate
+			return i;
+		}
+
+		const double Age = CurrentTime - ActiveRagdolls[i].StartTime;
+
+		// give new ragdolls some time to fall, unless forced
+		if (!bForce && Age < MinSimulationTime)
+		{
+			continue;
+		}
+
+		// distance to the closest player view
+		double ClosestDistance = 0.0;
+
+		if (ViewLocations.Num() > 0)
+		{
+			ClosestDistance = UE_BIG_NUMBER;
+
+			for (const FVector& ViewLocation : ViewLocations)
+			{
+				ClosestDistance = FMath::Min(ClosestDistance, FVector::Dist(ViewLocation, Mesh->GetComponentLocation()));
+			}
+		}
+
+		// older and farther ragdolls are frozen first
+		const double Score = Age + ClosestDistance / RagdollEvictionDistancePerSecond;
+
+		if (Score > BestScore)
+		{
+			BestScore = Score;
+			BestIndex = i;
+		}
+	}
+
+	return BestIndex;
+}
+
+void UShooterRagdollSubsystem::FreezeRagdoll(int32 Index)
+{
+	if (USkeletalMeshComponent* Mesh = ActiveRagdolls[Index].Mesh.Get())
+	{
+		// stop refreshing the skeleton so the bones keep the last simulated pose
+		Mesh->bNoSkeletonUpdate = true;
+
+		// stop simulating and colliding
+		Mesh->SetSimulatePhysics(false);
+		Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+		++TotalFrozen;
+		INC_DWORD_STAT(STAT_ShooterRagdollsFrozen);
+	}
+
+	ActiveRagdolls.RemoveAtSwap(Index, EAllowShrinking::No);
+}
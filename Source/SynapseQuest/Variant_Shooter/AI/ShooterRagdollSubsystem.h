@@ -0,0 +1,85 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Stats/Stats.h"
+#include "ShooterRagdollSubsystem.generated.h"
+
+class USkeletalMeshComponent;
+
+DECLARE_STATS_GROUP(TEXT("ShooterRagdolls"), STATGROUP_ShooterRagdolls, STATCAT_Advanced);
+
+/**
+ *  Keeps the number of simulated death ragdolls in the world under a budget
+ *  Ragdolls that settle down or run out of simulation time are frozen in their current pose.
+ *  When the budget is full, the oldest or farthest ragdoll is frozen to make room,
+ *  or the request is denied so the character can fall back to a death animation
+ */
+UCLASS()
+class SYNAPSEQUEST_API UShooterRagdollSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** A ragdoll currently simulating physics */
+	struct FActiveRagdoll
+	{
+		/** Simulating mesh */
+		TWeakObjectPtr<USkeletalMeshComponent> Mesh;
+
+		/** World time the ragdoll started simulating */
+		double StartTime = 0.0;
+	};
+
+	/** Ragdolls currently simulating physics */
+	TArray<FActiveRagdoll> ActiveRagdolls;
+
+	/** Total number of ragdolls frozen since the world started */
+	int32 TotalFrozen = 0;
+
+	/** Total number of ragdoll requests denied since the world started */
+	int32 TotalDenied = 0;
+
+public:
+
+	/** Only manage ragdolls in game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Freezes settled and expired ragdolls and updates the stats */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/**
+	 *  Asks for a slot to simulate the passed mesh as a ragdoll. The caller enables the physics simulation if granted
+	 *  If the budget is full, the best eviction candidate is frozen if it has simulated for long enough.
+	 *  @param Mesh Mesh that wants to ragdoll
+	 *  @param bForce If true, a slot is always made, even if it means freezing a ragdoll that just started
+	 *  @return true if the mesh can ragdoll
+	 */
+	bool RequestRagdoll(USkeletalMeshComponent* Mesh, bool bForce);
+
+	/** Stops tracking the passed mesh and undoes any freeze, e.g. when its owner is reused from a pool */
+	void ReleaseRagdoll(USkeletalMeshComponent* Mesh);
+
+	/** Returns the number of ragdolls currently simulating */
+	int32 GetNumActiveRagdolls() const { return ActiveRagdolls.Num(); }
+
+	/** Returns the number of ragdolls frozen since the world started */
+	int32 GetTotalFrozen() const { return TotalFrozen; }
+
+	/** Returns the number of ragdoll requests denied since the world started */
+	int32 GetTotalDenied() const { return TotalDenied; }
+
+protected:
+
+	/** Returns the index of the ragdoll that should be frozen first, or INDEX_NONE */
+	int32 FindEvictionCandidate(bool bForce) const;
+
+	/** Freezes the ragdoll at the passed index in its current pose and stops tracking it */
+	void FreezeRagdoll(int32 Index);
+};
@@ -8,10 +8,25 @@
 #include "AIController.h"
 #include "Perception/AIPerceptionComponent.h"
 #include "ShooterAIController.h"
-#include "StateTreeAsyncExecutionContext.h"
+#include "ShooterAIProfiler.h"
+#include "ShooterBenchmarkStats.h"
+#include "ShooterRandomSubsystem.h"
+#include "ShooterCoverSubsystem.h"
+#include "ShooterVisibilitySubsystem.h"
+#include "ShooterTeamSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Line Of Sight"), STAT_ShooterAI_LineOfSight, STATGROUP_ShooterAI);
+DECLARE_CYCLE_STAT(TEXT("Face Actor"), STAT_ShooterAI_FaceActor, STATGROUP_ShooterAI);
+DECLARE_CYCLE_STAT(TEXT("Face Location"), STAT_ShooterAI_FaceLocation, STATGROUP_ShooterAI);
+DECLARE_CYCLE_STAT(TEXT("Set Random Float"), STAT_ShooterAI_SetRandomFloat, STATGROUP_ShooterAI);
+DECLARE_CYCLE_STAT(TEXT("Shoot At Target"), STAT_ShooterAI_ShootAtTarget, STATGROUP_ShooterAI);
+DECLARE_CYCLE_STAT(TEXT("Sense Enemies"), STAT_ShooterAI_SenseEnemies, STATGROUP_ShooterAI);
+DECLARE_CYCLE_STAT(TEXT("Find Cover"), STAT_ShooterAI_FindCover, STATGROUP_ShooterAI);
 
 bool FStateTreeLineOfSightToTargetCondition::TestCondition(FStateTreeExecutionContext& Context) const
 {
+	SHOOTER_AI_SCOPE(LineOfSight);
+
 	const FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
 	// ensure the target is valid
@@ -42,6 +57,27 @@ bool FStateTreeLineOfSightToTargetCondition::TestCondition(FStateTreeExecutionCo
 	// get the character's camera location as the source for the line checks
 	const FVector Start = InstanceData.Character->GetFirstPersonCameraComponent()->GetComponentLocation();
 
+	// skip the traces if the baked visibility cells say none of the trace endpoints can be seen from here.
+	// The target's bounds may span several cells, so every endpoint is looked up
+	if (const UShooterVisibilitySubsystem* Visibility = InstanceData.Character->GetWorld()->GetSubsystem<UShooterVisibilitySubsystem>())
+	{
+		bool bAnyPotentiallyVisible = false;
+
+		for (int32 i = 0; i < InstanceData.NumberOfVerticalLineOfSightChecks - 1; ++i)
+		{
+			if (Visibility->ArePotentiallyVisible(Start, CenterOfMass + FVector(0.0f, 0.0f, Extent.Z - ExtentZOffset * i)))
+			{
+				bAnyPotentiallyVisible = true;
+				break;
+			}
+		}
+
+		if (!bAnyPotentiallyVisible)
+		{
+			return !InstanceData.bMustHaveLineOfSight;
+		}
+	}
+
 	// ignore the character and target. We want to ensure there's an unobstructed trace not counting them
 	FCollisionQueryParams QueryParams;
 	QueryParams.AddIgnoredActor(InstanceData.Character);
@@ -56,6 +92,7 @@ bool FStateTreeLineOfSightToTargetCondition::TestCondition(FStateTreeExecutionCo
 		const FVector End = CenterOfMass + FVector(0.0f, 0.0f, Extent.Z - ExtentZOffset * i);
 
 		InstanceData.Character->GetWorld()->LineTraceSingleByChannel(OutHit, Start, End, ECC_Visibility, QueryParams);
+		FShooterBenchmarkStats::AddSceneQueries();
 
 		// is the trace unobstructed?
 		if (!OutHit.bBlockingHit)
@@ -80,6 +117,8 @@ FText FStateTreeLineOfSightToTargetCondition::GetDescription(const FGuid& ID, FS
 
 EStateTreeRunStatus FStateTreeFaceActorTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
 {
+	SHOOTER_AI_SCOPE(FaceActor);
+
 	// have we transitioned from another state?
 	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
 	{
@@ -95,6 +134,8 @@ EStateTreeRunStatus FStateTreeFaceActorTask::EnterState(FStateTreeExecutionConte
 
 void FStateTreeFaceActorTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
 {
+	SHOOTER_AI_SCOPE(FaceActor);
+
 	// have we transitioned to another state?
 	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
 	{
@@ -117,6 +158,8 @@ FText FStateTreeFaceActorTask::GetDescription(const FGuid& ID, FStateTreeDataVie
 
 EStateTreeRunStatus FStateTreeFaceLocationTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
 {
+	SHOOTER_AI_SCOPE(FaceLocation);
+
 	// have we transitioned from another state?
 	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
 	{
@@ -132,6 +175,8 @@ EStateTreeRunStatus FStateTreeFaceLocationTask::EnterState(FStateTreeExecutionCo
 
 void FStateTreeFaceLocationTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
 {
+	SHOOTER_AI_SCOPE(FaceLocation);
+
 	// have we transitioned to another state?
 	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
 	{
@@ -154,6 +199,8 @@ FText FStateTreeFaceLocationTask::GetDescription(const FGuid& ID, FStateTreeData
 
 EStateTreeRunStatus FStateTreeSetRandomFloatTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
 {
+	SHOOTER_AI_SCOPE(SetRandomFloat);
+
 	// have we transitioned to another state?
 	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
 	{
@@ -161,7 +208,7 @@ EStateTreeRunStatus FStateTreeSetRandomFloatTask::EnterState(FStateTreeExecution
 		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
 		// calculate the output value
-		InstanceData.OutValue = FMath::RandRange(InstanceData.MinValue, InstanceData.MaxValue);
+		InstanceData.OutValue = UShooterRandomSubsystem::Draw(Context.GetOwner()).FRandRange(InstanceData.MinValue, InstanceData.MaxValue);
 	}
 
 	return EStateTreeRunStatus::Running;
@@ -178,6 +225,8 @@ FText FStateTreeSetRandomFloatTask::GetDescription(const FGuid& ID, FStateTreeDa
 
 EStateTreeRunStatus FStateTreeShootAtTargetTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
 {
+	SHOOTER_AI_SCOPE(ShootAtTarget);
+
 	// have we transitioned from another state?
 	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
 	{
@@ -193,6 +242,8 @@ EStateTreeRunStatus FStateTreeShootAtTargetTask::EnterState(FStateTreeExecutionC
 
 void FStateTreeShootAtTargetTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
 {
+	SHOOTER_AI_SCOPE(ShootAtTarget);
+
 	// have we transitioned to another state?
 	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
 	{
@@ -213,127 +264,56 @@ FText FStateTreeShootAtTargetTask::GetDescription(const FGuid& ID, FStateTreeDat
 
 EStateTreeRunStatus FStateTreeSenseEnemiesTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
 {
+	SHOOTER_AI_SCOPE(SenseEnemies);
+
 	// have we transitioned from another state?
 	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
 	{
 		// get the instance data
 		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-		// bind the perception updated delegate on the controller
-		InstanceData.Controller->OnShooterPerceptionUpdated.BindLambda(
-			[WeakContext = Context.MakeWeakExecutionContext()](AActor* SensedActor, const FAIStimulus& Stimulus)
-			{
-				// get the instance data inside the lambda
-				const FStateTreeStrongExecutionContext StrongContext = WeakContext.MakeStrongExecutionContext();
-				if (FInstanceDataType* LambdaInstanceData = StrongContext.GetInstanceDataPtr<FInstanceDataType>())
-				{
-					if (SensedActor->ActorHasTag(LambdaInstanceData->SenseTag))
-					{
-						bool bDirectLOS = false;
-
-						// calculate the direction of the stimulus
-						const FVector StimulusDir = (Stimulus.StimulusLocation - LambdaInstanceData->Character->GetActorLocation()).GetSafeNormal();
-
-						// infer the angle from the dot product between the character facing and the stimulus direction
-						const float DirDot = FVector::DotProduct(StimulusDir, LambdaInstanceData->Character->GetActorForwardVector());
-						const float MaxDot = FMath::Cos(FMath::DegreesToRadians(LambdaInstanceData->DirectLineOfSightCone));
-
-						// is the direction within our perception cone?
-						if (DirDot >= MaxDot)
-						{
-							// run a line trace between the character and the sensed actor
-							FCollisionQueryParams QueryParams;
-							QueryParams.AddIgnoredActor(LambdaInstanceData->Character);
-							QueryParams.AddIgnoredActor(SensedActor);
-
-							FHitResult OutHit;
-
-							// we have direct line of sight if this trace is unobstructed
-							bDirectLOS = !LambdaInstanceData->Character->GetWorld()->LineTraceSingleByChannel(OutHit, LambdaInstanceData->Character->GetActorLocation(), SensedActor->GetActorLocation(), ECC_Visibility, QueryParams);
-
-						}
-
-						// check if we have a direct line of sight to the stimulus
-						if (bDirectLOS)
-						{
-							// set the controller's target
-							LambdaInstanceData->Controller->SetCurrentTarget(SensedActor);
-
-							// set the task output
-							LambdaInstanceData->TargetActor = SensedActor;
-
-							// set the flags
-							LambdaInstanceData->bHasTarget = true;
-							LambdaInstanceData->bHasInvestigateLocation = false;
-
-						// no direct line of sight to target
-						} else {
-
-							// if we already have a target, ignore the partial sense and keep on them
-							if (!IsValid(LambdaInstanceData->TargetActor))
-							{
-								// is this stimulus stronger than the last one we had?
-								if (Stimulus.Strength > LambdaInstanceData->LastStimulusStrength)
-								{
-									// update the stimulus strength
-									LambdaInstanceData->LastStimulusStrength = Stimulus.Strength;
-
-									// set the investigate location
-									LambdaInstanceData->InvestigateLocation = Stimulus.StimulusLocation;
-
-									// set the investigate flag
-									LambdaInstanceData->bHasInvestigateLocation = true;
-								}
-							}
-						}
-					}
-				}
-			}
-		);
+		// subscribe to the perception event queue on the controller
+		InstanceData.PerceptionSubscription = InstanceData.Controller->SubscribeToPerception();
+	}
 
-		// bind the perception forgotten delegate on the controller
-		InstanceData.Controller->OnShooterPerceptionForgotten.BindLambda(
-			[WeakContext = Context.MakeWeakExecutionContext()](AActor* SensedActor)
-			{
-				// get the instance data inside the lambda
-				const FStateTreeStrongExecutionContext StrongContext = WeakContext.MakeStrongExecutionContext();
-				if (FInstanceDataType* LambdaInstanceData = StrongContext.GetInstanceDataPtr<FInstanceDataType>())
-				{
-					bool bForget = false;
-
-					// are we forgetting the current target?
-					if (SensedActor == LambdaInstanceData->TargetActor)
-					{
-						bForget = true;
-					}
-					else 
-					{
-						// are we forgetting about a partial sense?
-						if (!IsValid(LambdaInstanceData->TargetActor))
-						{
-							bForget = true;
-						}
-					}
-
-					if (bForget)
-					{
-						// clear the target
-						LambdaInstanceData->TargetActor = nullptr;
-
-						// clear the flags
-						LambdaInstanceData->bHasInvestigateLocation = false;
-						LambdaInstanceData->bHasTarget = false;
-
-						// reset the stimulus strength
-						LambdaInstanceData->LastStimulusStrength = 0.0f;
-
-						// clear the target on the controller
-						LambdaInstanceData->Controller->ClearCurrentTarget();
-						LambdaInstanceData->Controller->ClearFocus(EAIFocusPriority::Gameplay);
-					}
-				}
-			}
-		);
+	return EStateTreeRunStatus::Running;
+}
+
+EStateTreeRunStatus FStateTreeSenseEnemiesTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
+{
+	SHOOTER_AI_SCOPE(SenseEnemies);
+
+	// get the instance data
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	if (InstanceData.PerceptionSubscription == INDEX_NONE)
+	{
+		return EStateTreeRunStatus::Running;
+	}
+
+	// grab every perception event queued since our last tick.
+	// repeated stimuli for the same actor in a frame have already been merged by the controller
+	TArray<FShooterPerceptionEvent> Events;
+	InstanceData.Controller->DrainPerceptionEvents(InstanceData.PerceptionSubscription, Events);
+
+	for (const FShooterPerceptionEvent& Event : Events)
+	{
+		// skip actors destroyed since the event was queued
+		AActor* SensedActor = Event.Actor.Get();
+
+		if (!SensedActor)
+		{
+			continue;
+		}
+
+		if (Event.bForgotten)
+		{
+			HandlePerceptionForgotten(InstanceData, SensedActor);
+
+		} else {
+
+			HandlePerceptionUpdated(InstanceData, SensedActor, Event.Stimulus);
+		}
 	}
 
 	return EStateTreeRunStatus::Running;
@@ -341,15 +321,124 @@ EStateTreeRunStatus FStateTreeSenseEnemiesTask::EnterState(FStateTreeExecutionCo
 
 void FStateTreeSenseEnemiesTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
 {
+	SHOOTER_AI_SCOPE(SenseEnemies);
+
 	// have we transitioned to another state?
 	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
 	{
 		// get the instance data
 		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-		// unbind the perception delegates
-		InstanceData.Controller->OnShooterPerceptionUpdated.Unbind();
-		InstanceData.Controller->OnShooterPerceptionForgotten.Unbind();
+		// unsubscribe from the perception event queue
+		InstanceData.Controller->UnsubscribeFromPerception(InstanceData.PerceptionSubscription);
+		InstanceData.PerceptionSubscription = INDEX_NONE;
+	}
+}
+
+void FStateTreeSenseEnemiesTask::HandlePerceptionUpdated(FInstanceDataType& InstanceData, AActor* SensedActor, const FAIStimulus& Stimulus) const
+{
+	// only react to live enemies
+	const UShooterTeamSubsystem* Teams = UShooterTeamSubsystem::Get(InstanceData.Character);
+
+	if (!Teams || !Teams->IsHostile(InstanceData.Character, SensedActor))
+	{
+		return;
+	}
+
+	bool bDirectLOS = false;
+
+	// calculate the direction of the stimulus
+	const FVector StimulusDir = (Stimulus.StimulusLocation - InstanceData.Character->GetActorLocation()).GetSafeNormal();
+
+	// infer the angle from the dot product between the character facing and the stimulus direction
+	const float DirDot = FVector::DotProduct(StimulusDir, InstanceData.Character->GetActorForwardVector());
+	const float MaxDot = FMath::Cos(FMath::DegreesToRadians(InstanceData.DirectLineOfSightCone));
+
+	// is the direction within our perception cone, and could the sensed actor be seen from here at all?
+	const UShooterVisibilitySubsystem* Visibility = InstanceData.Character->GetWorld()->GetSubsystem<UShooterVisibilitySubsystem>();
+
+	if (DirDot >= MaxDot && (!Visibility || Visibility->ArePotentiallyVisible(InstanceData.Character->GetActorLocation(), SensedActor->GetActorLocation())))
+	{
+		// run a line trace between the character and the sensed actor
+		FCollisionQueryParams QueryParams;
+		QueryParams.AddIgnoredActor(InstanceData.Character);
+		QueryParams.AddIgnoredActor(SensedActor);
+
+		FHitResult OutHit;
+
+		// we have direct line of sight if this trace is unobstructed
+		bDirectLOS = !InstanceData.Character->GetWorld()->LineTraceSingleByChannel(OutHit, InstanceData.Character->GetActorLocation(), SensedActor->GetActorLocation(), ECC_Visibility, QueryParams);
+		FShooterBenchmarkStats::AddSceneQueries();
+	}
+
+	// check if we have a direct line of sight to the stimulus
+	if (bDirectLOS)
+	{
+		// set the controller's target
+		InstanceData.Controller->SetCurrentTarget(SensedActor);
+
+		// set the task output
+		InstanceData.TargetActor = SensedActor;
+
+		// set the flags
+		InstanceData.bHasTarget = true;
+		InstanceData.bHasInvestigateLocation = false;
+
+	// no direct line of sight to target
+	} else {
+
+		// if we already have a target, ignore the partial sense and keep on them
+		if (!IsValid(InstanceData.TargetActor))
+		{
+			// is this stimulus stronger than the last one we had?
+			if (Stimulus.Strength > InstanceData.LastStimulusStrength)
+			{
+				// update the stimulus strength
+				InstanceData.LastStimulusStrength = Stimulus.Strength;
+
+				// set the investigate location
+				InstanceData.InvestigateLocation = Stimulus.StimulusLocation;
+
+				// set the investigate flag
+				InstanceData.bHasInvestigateLocation = true;
+			}
+		}
+	}
+}
+
+void FStateTreeSenseEnemiesTask::HandlePerceptionForgotten(FInstanceDataType& InstanceData, AActor* SensedActor) const
+{
+	bool bForget = false;
+
+	// are we forgetting the current target?
+	if (SensedActor == InstanceData.TargetActor)
+	{
+		bForget = true;
+	}
+	else 
+	{
+		// are we forgetting about a partial sense?
+		if (!IsValid(InstanceData.TargetActor))
+		{
+			bForget = true;
+		}
+	}
+
+	if (bForget)
+	{
+		// clear the target
+		InstanceData.TargetActor = nullptr;
+
+		// clear the flags
+		InstanceData.bHasInvestigateLocation = false;
+		InstanceData.bHasTarget = false;
+
+		// reset the stimulus strength
+		InstanceData.LastStimulusStrength = 0.0f;
+
+		// clear the target on the controller
+		InstanceData.Controller->ClearCurrentTarget();
+		InstanceData.Controller->ClearFocus(EAIFocusPriority::Gameplay);
 	}
 }
 
@@ -358,4 +447,108 @@ FText FStateTreeSenseEnemiesTask::GetDescription(const FGuid& ID, FStateTreeData
 {
 	return FText::FromString("<b>Sense Enemies</b>");
 }
+#endif // WITH_EDITOR
+
+////////////////////////////////////////////////////////////////////
+
+EStateTreeRunStatus FStateTreeFindCoverTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	SHOOTER_AI_SCOPE(FindCover);
+
+	// have we transitioned from another state?
+	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
+	{
+		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+		UShooterCoverSubsystem* CoverSubsystem = InstanceData.Character ? InstanceData.Character->GetWorld()->GetSubsystem<UShooterCoverSubsystem>() : nullptr;
+
+		if (!CoverSubsystem)
+		{
+			return EStateTreeRunStatus::Failed;
+		}
+
+		// build the query
+		FShooterCoverQuery Query;
+		Query.QuerierLocation = InstanceData.Character->GetActorLocation();
+		Query.MaxDistance = InstanceData.MaxDistance;
+		Query.MinThreatDistance = InstanceData.MinThreatDistance;
+
+		if (IsValid(InstanceData.Threat))
+		{
+			Query.ThreatLocations.Add(InstanceData.Threat->GetActorLocation());
+		}
+
+		// start scoring on the worker threads
+		InstanceData.QueryId = CoverSubsystem->RequestCover(MoveTemp(Query), InstanceData.Character);
+	}
+
+	return EStateTreeRunStatus::Running;
+}
+
+EStateTreeRunStatus FStateTreeFindCoverTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
+{
+	SHOOTER_AI_SCOPE(FindCover);
+
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	UShooterCoverSubsystem* CoverSubsystem = InstanceData.Character ? InstanceData.Character->GetWorld()->GetSubsystem<UShooterCoverSubsystem>() : nullptr;
+
+	if (!CoverSubsystem)
+	{
+		return EStateTreeRunStatus::Failed;
+	}
+
+	// is the result ready?
+	FShooterCoverResult Result;
+
+	if (!CoverSubsystem->PollCover(InstanceData.QueryId, Result))
+	{
+		return EStateTreeRunStatus::Running;
+	}
+
+	InstanceData.QueryId = INDEX_NONE;
+
+	if (!Result.bFound)
+	{
+		return EStateTreeRunStatus::Failed;
+	}
+
+	InstanceData.CoverLocation = Result.Location;
+
+	return EStateTreeRunStatus::Succeeded;
+}
+
+void FStateTreeFindCoverTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	SHOOTER_AI_SCOPE(FindCover);
+
+	// have we transitioned to another state?
+	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
+	{
+		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+		if (InstanceData.Character)
+		{
+			if (UShooterCoverSubsystem* CoverSubsystem = InstanceData.Character->GetWorld()->GetSubsystem<UShooterCoverSubsystem>())
+			{
+				// drop the query if it's still running
+				if (InstanceData.QueryId != INDEX_NONE)
+				{
+					CoverSubsystem->CancelCover(InstanceData.QueryId);
+				}
+
+				// free the cover point for other NPCs
+				CoverSubsystem->ReleaseClaim(InstanceData.Character);
+			}
+		}
+
+		InstanceData.QueryId = INDEX_NONE;
+	}
+}
+
+#if WITH_EDITOR
+FText FStateTreeFindCoverTask::GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting /*= EStateTreeNodeFormatting::Text*/) const
+{
+	return FText::FromString("<b>Find Cover</b>");
+}
 #endif // WITH_EDITOR
\ No newline at end of file
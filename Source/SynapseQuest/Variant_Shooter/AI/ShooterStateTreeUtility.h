@@ -11,6 +11,7 @@
 class AShooterNPC;
 class AAIController;
 class AShooterAIController;
+struct FAIStimulus;
 
 /**
  *  Instance data struct for the FStateTreeLineOfSightToTargetCondition condition
@@ -270,10 +271,6 @@ struct FStateTreeSenseEnemiesInstanceData
 	UPROPERTY(EditAnywhere, Category = Output)
 	bool bHasInvestigateLocation = false;
 
-	/** Tag required on sensed actors */
-	UPROPERTY(EditAnywhere, Category = Parameter)
-	FName SenseTag = FName("Player");
-
 	/** Line of sight cone half angle to consider a full sense */
 	UPROPERTY(EditAnywhere, Category = Parameter)
 	float DirectLineOfSightCone = 85.0f;
@@ -281,6 +278,10 @@ struct FStateTreeSenseEnemiesInstanceData
 	/** Strength of the last processed stimulus */
 	UPROPERTY(EditAnywhere)
 	float LastStimulusStrength = 0.0f;
+
+	/** Perception queue subscription on the controller */
+	UPROPERTY()
+	int32 PerceptionSubscription = INDEX_NONE;
 };
 
 /**
@@ -295,9 +296,100 @@ struct FStateTreeSenseEnemiesTask : public FStateTreeTaskCommonBase
 	using FInstanceDataType = FStateTreeSenseEnemiesInstanceData;
 	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
 
+	/** Constructor */
+	FStateTreeSenseEnemiesTask()
+	{
+		// perception events are drained from the controller queue on tick
+		bShouldCallTick = true;
+	}
+
 	/** Runs when the owning state is entered */
 	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
 
+	/** Runs while the owning state is active */
+	virtual EStateTreeRunStatus Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const override;
+
+	/** Runs when the owning state is ended */
+	virtual void ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
+protected:
+
+	/** Processes a perception update on a sensed actor */
+	void HandlePerceptionUpdated(FInstanceDataType& InstanceData, AActor* SensedActor, const FAIStimulus& Stimulus) const;
+
+	/** Processes a sensed actor being forgotten */
+	void HandlePerceptionForgotten(FInstanceDataType& InstanceData, AActor* SensedActor) const;
+
+public:
+
+#if WITH_EDITOR
+	virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
+#endif // WITH_EDITOR
+};
+
+////////////////////////////////////////////////////////////////////
+
+/**
+ *  Instance data struct for the Find Cover StateTree task
+ */
+USTRUCT()
+struct FStateTreeFindCoverInstanceData
+{
+	GENERATED_BODY()
+
+	/** NPC looking for cover */
+	UPROPERTY(EditAnywhere, Category = Context)
+	TObjectPtr<AShooterNPC> Character;
+
+	/** Actor to take cover from */
+	UPROPERTY(EditAnywhere, Category = Input)
+	TObjectPtr<AActor> Threat;
+
+	/** Max distance from the NPC to the cover point */
+	UPROPERTY(EditAnywhere, Category = Parameter)
+	float MaxDistance = 1500.0f;
+
+	/** Min distance from the threat to the cover point */
+	UPROPERTY(EditAnywhere, Category = Parameter)
+	float MinThreatDistance = 400.0f;
+
+	/** Location of the cover point found */
+	UPROPERTY(EditAnywhere, Category = Output)
+	FVector CoverLocation = FVector::ZeroVector;
+
+	/** Cover query running on the cover subsystem */
+	UPROPERTY()
+	int32 QueryId = INDEX_NONE;
+};
+
+/**
+ *  StateTree task to find a cover point from a threat using the baked cover points
+ *  The query is scored on the worker threads, and the task keeps running until the result is ready.
+ *  The cover point stays claimed until the owning state is exited, so put the move to cover in the same state or a child state.
+ *  Succeeds if cover was found, fails otherwise
+ */
+USTRUCT(meta=(DisplayName="Find Cover", Category="Shooter"))
+struct FStateTreeFindCoverTask : public FStateTreeTaskCommonBase
+{
+	GENERATED_BODY()
+
+	/* Ensure we're using the correct instance data struct */
+	using FInstanceDataType = FStateTreeFindCoverInstanceData;
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+
+	/** Constructor */
+	FStateTreeFindCoverTask()
+	{
+		// the cover query is polled on tick
+		bShouldCallTick = true;
+	}
+
+	/** Runs when the owning state is entered */
+	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
+	/** Runs while the owning state is active */
+	virtual EStateTreeRunStatus Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const override;
+
 	/** Runs when the owning state is ended */
 	virtual void ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
 
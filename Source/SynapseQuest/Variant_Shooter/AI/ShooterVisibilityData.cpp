@@ -0,0 +1,101 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterVisibilityData.h"
+#include "SynapseQuest.h"
+#include "Misc/Compression.h"
+
+void UShooterVisibilityData::PostLoad()
+{
+	Super::PostLoad();
+
+	DecompressVisibility();
+}
+
+void UShooterVisibilityData::SetVisibility(const FVector& InGridOrigin, float InCellSize, const FIntVector& InGridSize, const TArray<uint8>& PairVisibility)
+{
+	GridOrigin = InGridOrigin;
+	CellSize = InCellSize;
+	GridSize = InGridSize;
+
+	// pack one bit per pair
+	const int32 NumPairs = static_cast<int32>(GetNumPairs(GetNumCells()));
+	check(PairVisibility.Num() == NumPairs);
+
+	VisibilityWords.Reset();
+	VisibilityWords.SetNumZeroed(FMath::Max(1, (NumPairs + 31) / 32));
+
+	for (int32 Pair = 0; Pair < NumPairs; ++Pair)
+	{
+		if (PairVisibility[Pair])
+		{
+			VisibilityWords[Pair >> 5] |= 1u << (Pair & 31);
+		}
+	}
+
+	// compress for saving
+	UncompressedSize = VisibilityWords.Num() * sizeof(uint32);
+
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, UncompressedSize);
+	CompressedVisibility.SetNumUninitialized(CompressedSize);
+
+	if (FCompression::CompressMemory(NAME_Zlib, CompressedVisibility.GetData(), CompressedSize, VisibilityWords.GetData(), UncompressedSize))
+	{
+		CompressedVisibility.SetNum(CompressedSize);
+
+	} else {
+
+		UE_LOG(LogSynapseQuest, Error, TEXT("Failed to compress the visibility of %s"), *GetName());
+		CompressedVisibility.Reset();
+	}
+}
+
+void UShooterVisibilityData::DecompressVisibility()
+{
+	VisibilityWords.Reset();
+
+	if (UncompressedSize <= 0 || CompressedVisibility.Num() == 0)
+	{
+		return;
+	}
+
+	VisibilityWords.SetNumUninitialized(UncompressedSize / sizeof(uint32));
+
+	if (!FCompression::UncompressMemory(NAME_Zlib, VisibilityWords.GetData(), UncompressedSize, CompressedVisibility.GetData(), CompressedVisibility.Num()))
+	{
+		UE_LOG(LogSynapseQuest, Error, TEXT("Failed to decompress the visibility of %s"), *GetName());
+		VisibilityWords.Reset();
+	}
+}
+
+int32 UShooterVisibilityData::GetCellIndex(const FVector& Location) const
+{
+	const FVector Local = (Location - GridOrigin) / CellSize;
+
+	const int32 X = FMath::FloorToInt32(Local.X);
+	const int32 Y = FMath::FloorToInt32(Local.Y);
+	const int32 Z = FMath::FloorToInt32(Local.Z);
+
+	if (X < 0 || Y < 0 || Z < 0 || X >= GridSize.X || Y >= GridSize.Y || Z >= GridSize.Z)
+	{
+		return INDEX_NONE;
+	}
+
+	return (Z * GridSize.Y + Y) * GridSize.X + X;
+}
+
+bool UShooterVisibilityData::AreCellsPotentiallyVisible(int32 CellA, int32 CellB) const
+{
+	if (CellA == CellB)
+	{
+		return true;
+	}
+
+	if (CellA > CellB)
+	{
+		Swap(CellA, CellB);
+	}
+
+	const int64 Pair = GetPairIndex(CellA, CellB, GetNumCells());
+	return (VisibilityWords[static_cast<int32>(Pair >> 5)] & (1u << (Pair & 31))) != 0;
+}
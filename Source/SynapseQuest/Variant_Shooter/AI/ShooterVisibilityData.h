@@ -0,0 +1,84 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "ShooterVisibilityData.generated.h"
+
+/**
+ *  Potential visibility between the cells of a regular grid, baked by a Shooter Visibility Volume
+ *  Visibility is symmetric, so only one bit is kept per pair of distinct cells. The bits are saved zlib compressed
+ *  and expanded once on load, so lookups are a single bit test.
+ *  Pairs involving a cell that couldn't be sampled are always reported as potentially visible
+ */
+UCLASS(BlueprintType)
+class SYNAPSEQUEST_API UShooterVisibilityData : public UDataAsset
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** World location of the grid's min corner */
+	UPROPERTY(VisibleAnywhere, Category="Visibility")
+	FVector GridOrigin = FVector::ZeroVector;
+
+	/** Size of each cell */
+	UPROPERTY(VisibleAnywhere, Category="Visibility", meta = (Units = "cm"))
+	float CellSize = 500.0f;
+
+	/** Number of cells along each axis */
+	UPROPERTY(VisibleAnywhere, Category="Visibility")
+	FIntVector GridSize = FIntVector::ZeroValue;
+
+	/** Size of the expanded pair bits, in bytes */
+	UPROPERTY(VisibleAnywhere, Category="Visibility")
+	int32 UncompressedSize = 0;
+
+	/** Compressed pair bits */
+	UPROPERTY()
+	TArray<uint8> CompressedVisibility;
+
+	/** Expanded pair bits. Built on load */
+	TArray<uint32> VisibilityWords;
+
+public:
+
+	/** Expands the pair bits */
+	virtual void PostLoad() override;
+
+	/**
+	 *  Replaces the baked visibility
+	 *  @param InGridOrigin World location of the grid's min corner
+	 *  @param InCellSize Size of each cell
+	 *  @param InGridSize Number of cells along each axis
+	 *  @param PairVisibility One entry per pair of distinct cells, in the order given by GetPairIndex. Non zero if potentially visible
+	 */
+	void SetVisibility(const FVector& InGridOrigin, float InCellSize, const FIntVector& InGridSize, const TArray<uint8>& PairVisibility);
+
+	/** Returns true if the pair bits are loaded and lookups can be made */
+	bool HasVisibility() const { return VisibilityWords.Num() > 0; }
+
+	/** Returns the total number of cells */
+	int32 GetNumCells() const { return GridSize.X * GridSize.Y * GridSize.Z; }
+
+	/** Returns the index of the cell containing the passed location, or INDEX_NONE if outside the grid */
+	int32 GetCellIndex(const FVector& Location) const;
+
+	/** Returns true if the two cells may see each other */
+	bool AreCellsPotentiallyVisible(int32 CellA, int32 CellB) const;
+
+	/** Returns the number of pairs of distinct cells in a grid of the passed size */
+	static int64 GetNumPairs(int32 NumCells) { return static_cast<int64>(NumCells) * (NumCells - 1) / 2; }
+
+	/** Returns the index of the pair of distinct cells A and B, with A lower than B */
+	static int64 GetPairIndex(int32 CellA, int32 CellB, int32 NumCells)
+	{
+		return static_cast<int64>(CellA) * NumCells - static_cast<int64>(CellA) * (CellA + 1) / 2 + (CellB - CellA - 1);
+	}
+
+protected:
+
+	/** Expands the compressed pair bits */
+	void DecompressVisibility();
+};
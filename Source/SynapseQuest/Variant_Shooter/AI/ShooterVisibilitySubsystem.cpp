@@ -0,0 +1,78 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterVisibilitySubsystem.h"
+#include "ShooterVisibilityData.h"
+#include "ShooterAIProfiler.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Visibility Lookups"), STAT_ShooterAI_VisibilityLookups, STATGROUP_ShooterAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Visibility Culled"), STAT_ShooterAI_VisibilityCulled, STATGROUP_ShooterAI);
+
+static TAutoConsoleVariable<bool> CVarShooterUseVisibilityCells(
+	TEXT("Shooter.AI.UseVisibilityCells"),
+	true,
+	TEXT("If true, AI line of sight checks skip their traces when the baked visibility cells say the target can't be seen."),
+	ECVF_Default);
+
+bool UShooterVisibilitySubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer))
+	{
+		return false;
+	}
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && (World->WorldType == EWorldType::Game || World->WorldType == EWorldType::PIE);
+}
+
+void UShooterVisibilitySubsystem::RegisterVisibilityData(const UShooterVisibilityData* VisibilityData)
+{
+	if (VisibilityData && VisibilityData->HasVisibility())
+	{
+		RegisteredData.AddUnique(VisibilityData);
+	}
+}
+
+void UShooterVisibilitySubsystem::UnregisterVisibilityData(const UShooterVisibilityData* VisibilityData)
+{
+	RegisteredData.Remove(VisibilityData);
+}
+
+bool UShooterVisibilitySubsystem::ArePotentiallyVisible(const FVector& From, const FVector& To) const
+{
+	if (RegisteredData.Num() == 0 || !CVarShooterUseVisibilityCells.GetValueOnGameThread())
+	{
+		return true;
+	}
+
+	INC_DWORD_STAT(STAT_ShooterAI_VisibilityLookups);
+
+	for (const TWeakObjectPtr<const UShooterVisibilityData>& WeakData : RegisteredData)
+	{
+		const UShooterVisibilityData* Data = WeakData.Get();
+
+		if (!Data)
+		{
+			continue;
+		}
+
+		const int32 FromCell = Data->GetCellIndex(From);
+		const int32 ToCell = Data->GetCellIndex(To);
+
+		// only grids containing both locations can answer
+		if (FromCell != INDEX_NONE && ToCell != INDEX_NONE)
+		{
+			if (Data->AreCellsPotentiallyVisible(FromCell, ToCell))
+			{
+				return true;
+			}
+
+			INC_DWORD_STAT(STAT_ShooterAI_VisibilityCulled);
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,40 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterVisibilitySubsystem.generated.h"
+
+class UShooterVisibilityData;
+
+/**
+ *  Answers coarse visibility questions from the baked visibility cells, so AI line of sight checks can skip traces
+ *  that can't possibly succeed. Locations outside every baked grid are always reported as potentially visible.
+ *  The lookup can be disabled with Shooter.AI.UseVisibilityCells
+ */
+UCLASS()
+class SYNAPSEQUEST_API UShooterVisibilitySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Registered visibility data assets */
+	TArray<TWeakObjectPtr<const UShooterVisibilityData>> RegisteredData;
+
+public:
+
+	/** Only cull visibility in game worlds */
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	/** Adds a visibility data asset to the lookups */
+	void RegisterVisibilityData(const UShooterVisibilityData* VisibilityData);
+
+	/** Removes a visibility data asset from the lookups */
+	void UnregisterVisibilityData(const UShooterVisibilityData* VisibilityData);
+
+	/**
+	 *  Checks if two locations may be able to see each other
+	 *  @return false only if both locations are in the same baked grid and their cells can't see each other
+	 */
+	bool ArePotentiallyVisible(const FVector& From, const FVector& To) const;
+};
@@ -0,0 +1,167 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/AI/ShooterVisibilityVolume.h"
+#include "SynapseQuest.h"
+#include "ShooterVisibilityData.h"
+#include "ShooterVisibilitySubsystem.h"
+#include "Components/BoxComponent.h"
+#include "Engine/World.h"
+#include "Async/ParallelFor.h"
+
+AShooterVisibilityVolume::AShooterVisibilityVolume()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	// create the bounds box
+	RootComponent = BakeBounds = CreateDefaultSubobject<UBoxComponent>(TEXT("Bake Bounds"));
+
+	BakeBounds->SetBoxExtent(FVector(4000.0f, 4000.0f, 500.0f));
+	BakeBounds->SetCollisionProfileName(FName("NoCollision"));
+	BakeBounds->SetCanEverAffectNavigation(false);
+}
+
+void AShooterVisibilityVolume::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (VisibilityData)
+	{
+		if (UShooterVisibilitySubsystem* VisibilitySubsystem = GetWorld()->GetSubsystem<UShooterVisibilitySubsystem>())
+		{
+			VisibilitySubsystem->RegisterVisibilityData(VisibilityData);
+		}
+	}
+}
+
+void AShooterVisibilityVolume::EndPlay(EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	if (VisibilityData)
+	{
+		if (UShooterVisibilitySubsystem* VisibilitySubsystem = GetWorld()->GetSubsystem<UShooterVisibilitySubsystem>())
+		{
+			VisibilitySubsystem->UnregisterVisibilityData(VisibilityData);
+		}
+	}
+}
+
+#if WITH_EDITOR
+
+void AShooterVisibilityVolume::BakeVisibility()
+{
+	if (!VisibilityData)
+	{
+		UE_LOG(LogSynapseQuest, Warning, TEXT("%s has no visibility data asset to bake into"), *GetName());
+		return;
+	}
+
+	const FBox Bounds = BakeBounds->Bounds.GetBox();
+	const FVector BoundsSize = Bounds.GetSize();
+
+	const FIntVector GridSize(
+		FMath::Max(1, FMath::CeilToInt32(BoundsSize.X / CellSize)),
+		FMath::Max(1, FMath::CeilToInt32(BoundsSize.Y / CellSize)),
+		FMath::Max(1, FMath::CeilToInt32(BoundsSize.Z / CellSize)));
+
+	const int32 NumCells = GridSize.X * GridSize.Y * GridSize.Z;
+
+	if (NumCells > MaxCells)
+	{
+		UE_LOG(LogSynapseQuest, Warning, TEXT("%s needs %d cells, over the max of %d. Increase the cell size or shrink the bounds"), *GetName(), NumCells, MaxCells);
+		return;
+	}
+
+	UWorld* World = GetWorld();
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ShooterVisibilityBake), false, this);
+
+	// sample the center of each cell and its eight corners, pulled in so they stay inside the cell. Corners cover the
+	// floor and top heights of the cell, so a pair is only culled if no line between those heights is clear either.
+	// Samples inside geometry are dropped
+	const float Offset = FMath::Max(CellSize * 0.5f - SampleRadius, 0.0f);
+	const FVector SampleOffsets[] = {
+		FVector::ZeroVector,
+		FVector(Offset, Offset, Offset),
+		FVector(-Offset, Offset, Offset),
+		FVector(Offset, -Offset, Offset),
+		FVector(-Offset, -Offset, Offset),
+		FVector(Offset, Offset, -Offset),
+		FVector(-Offset, Offset, -Offset),
+		FVector(Offset, -Offset, -Offset),
+		FVector(-Offset, -Offset, -Offset)
+	};
+
+	TArray<TArray<FVector, TInlineAllocator<9>>> CellSamples;
+	CellSamples.SetNum(NumCells);
+
+	for (int32 Z = 0; Z < GridSize.Z; ++Z)
+	{
+		for (int32 Y = 0; Y < GridSize.Y; ++Y)
+		{
+			for (int32 X = 0; X < GridSize.X; ++X)
+			{
+				const FVector CellCenter = Bounds.Min + (FVector(X, Y, Z) + 0.5f) * CellSize;
+				TArray<FVector, TInlineAllocator<9>>& Samples = CellSamples[(Z * GridSize.Y + Y) * GridSize.X + X];
+
+				for (const FVector& SampleOffset : SampleOffsets)
+				{
+					const FVector Sample = CellCenter + SampleOffset;
+
+					if (!World->OverlapBlockingTestByChannel(Sample, FQuat::Identity, TraceChannel, FCollisionShape::MakeSphere(SampleRadius), QueryParams))
+					{
+						Samples.Add(Sample);
+					}
+				}
+			}
+		}
+	}
+
+	// trace every pair of cells. Each pair is only written by the row of its lower cell, so rows can run in parallel
+	TArray<uint8> PairVisibility;
+	PairVisibility.SetNumZeroed(static_cast<int32>(UShooterVisibilityData::GetNumPairs(NumCells)));
+
+	ParallelFor(NumCells, [&](int32 CellA)
+	{
+		const TArray<FVector, TInlineAllocator<9>>& SamplesA = CellSamples[CellA];
+
+		for (int32 CellB = CellA + 1; CellB < NumCells; ++CellB)
+		{
+			const TArray<FVector, TInlineAllocator<9>>& SamplesB = CellSamples[CellB];
+			const int32 Pair = static_cast<int32>(UShooterVisibilityData::GetPairIndex(CellA, CellB, NumCells));
+
+			// cells buried in geometry can't be judged, so stay conservative
+			if (SamplesA.Num() == 0 || SamplesB.Num() == 0)
+			{
+				PairVisibility[Pair] = 1;
+				continue;
+			}
+
+			for (const FVector& SampleA : SamplesA)
+			{
+				for (const FVector& SampleB : SamplesB)
+				{
+					if (!World->LineTraceTestByChannel(SampleA, SampleB, TraceChannel, QueryParams))
+					{
+						PairVisibility[Pair] = 1;
+						break;
+					}
+				}
+
+				if (PairVisibility[Pair])
+				{
+					break;
+				}
+			}
+		}
+	});
+
+	VisibilityData->Modify();
+	VisibilityData->SetVisibility(Bounds.Min, CellSize, GridSize, PairVisibility);
+	VisibilityData->MarkPackageDirty();
+
+	UE_LOG(LogSynapseQuest, Log, TEXT("%s baked visibility for %d cells into %s"), *GetName(), NumCells, *VisibilityData->GetName());
+}
+
+#endif // WITH_EDITOR
@@ -0,0 +1,68 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ShooterVisibilityVolume.generated.h"
+
+class UBoxComponent;
+class UShooterVisibilityData;
+
+/**
+ *  Bakes the potential visibility between the cells inside its bounds into a Shooter Visibility Data asset,
+ *  and registers it with the visibility subsystem during play.
+ *  Each cell is sampled at its free center and corners, and two cells are potentially visible if any pair of their samples can see each other.
+ */
+UCLASS()
+class SYNAPSEQUEST_API AShooterVisibilityVolume : public AActor
+{
+	GENERATED_BODY()
+
+	/** Area to bake visibility for */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	UBoxComponent* BakeBounds;
+
+protected:
+
+	/** Asset the visibility is baked into and loaded from */
+	UPROPERTY(EditAnywhere, Category="Visibility")
+	TObjectPtr<UShooterVisibilityData> VisibilityData;
+
+	/** Size of each visibility cell. Should be small compared to the occluders in the level */
+	UPROPERTY(EditAnywhere, Category="Visibility|Bake", meta = (ClampMin = 100, ClampMax = 5000, Units = "cm"))
+	float CellSize = 500.0f;
+
+	/** Max number of cells to bake. Memory grows with the square of the cell count */
+	UPROPERTY(EditAnywhere, Category="Visibility|Bake", meta = (ClampMin = 1, ClampMax = 16384))
+	int32 MaxCells = 4096;
+
+	/** Radius used to check if a sample point is inside geometry */
+	UPROPERTY(EditAnywhere, Category="Visibility|Bake", meta = (ClampMin = 1, ClampMax = 100, Units = "cm"))
+	float SampleRadius = 20.0f;
+
+	/** Channel used by the visibility traces */
+	UPROPERTY(EditAnywhere, Category="Visibility|Bake")
+	TEnumAsByte<ECollisionChannel> TraceChannel = ECC_Visibility;
+
+public:
+
+	/** Constructor */
+	AShooterVisibilityVolume();
+
+protected:
+
+	/** Registers the baked visibility */
+	virtual void BeginPlay() override;
+
+	/** Unregisters the baked visibility */
+	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
+#if WITH_EDITOR
+
+	/** Samples the level geometry inside the bounds and overwrites the visibility data asset */
+	UFUNCTION(CallInEditor, Category="Visibility")
+	void BakeVisibility();
+
+#endif // WITH_EDITOR
+};
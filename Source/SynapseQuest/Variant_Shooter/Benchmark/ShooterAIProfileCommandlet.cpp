@@ -0,0 +1,65 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/Benchmark/ShooterAIProfileCommandlet.h"
+#include "ShooterHeadlessWorld.h"
+#include "ShooterAIProfiler.h"
+#include "SynapseQuest.h"
+#include "Misc/Parse.h"
+
+UShooterAIProfileCommandlet::UShooterAIProfileCommandlet()
+{
+	IsClient = false;
+	IsServer = true;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UShooterAIProfileCommandlet::Main(const FString& Params)
+{
+	// read the parameters
+	FString MapName = FShooterHeadlessWorld::GetDefaultMap();
+	FParse::Value(*Params, TEXT("Map="), MapName);
+
+	float Seconds = 30.0f;
+	FParse::Value(*Params, TEXT("Seconds="), Seconds);
+
+	float FPS = 30.0f;
+	FParse::Value(*Params, TEXT("FPS="), FPS);
+
+	if (Seconds <= 0.0f || FPS <= 0.0f)
+	{
+		UE_LOG(LogSynapseQuest, Error, TEXT("ShooterAIProfile: Seconds and FPS must be positive"));
+		return 1;
+	}
+
+	// start sampling from a clean table
+	FShooterAIProfiler::SetEnabled(true);
+	FShooterAIProfiler::Get().Reset();
+
+	FShooterHeadlessWorld HeadlessWorld;
+
+	if (!HeadlessWorld.Load(MapName))
+	{
+		return 1;
+	}
+
+	// run the map at a fixed step
+	const float DeltaSeconds = 1.0f / FPS;
+	const int32 NumFrames = FMath::CeilToInt(Seconds * FPS);
+
+	UE_LOG(LogSynapseQuest, Display, TEXT("ShooterAIProfile: running %s for %d frames"), *MapName, NumFrames);
+
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		HeadlessWorld.Tick(DeltaSeconds);
+	}
+
+	// print the results
+	FShooterAIProfiler::Get().DumpTable(*GLog);
+
+	HeadlessWorld.Shutdown();
+	FShooterAIProfiler::SetEnabled(false);
+
+	return 0;
+}
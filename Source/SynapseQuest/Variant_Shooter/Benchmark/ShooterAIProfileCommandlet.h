@@ -0,0 +1,25 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ShooterAIProfileCommandlet.generated.h"
+
+/**
+ *  Runs a shooter map headless for a fixed amount of time and prints the per node cost of the shooter AI StateTree nodes
+ *  Usage: -run=ShooterAIProfile -nullrhi [-Map=/Game/Variant_Shooter/Lvl_Shooter] [-Seconds=30] [-FPS=30]
+ */
+UCLASS()
+class SYNAPSEQUEST_API UShooterAIProfileCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Constructor */
+	UShooterAIProfileCommandlet();
+
+	/** Runs the profile */
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,278 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/Benchmark/ShooterBenchmarkCommandlet.h"
+#include "ShooterHeadlessWorld.h"
+#include "ShooterBenchmarkStats.h"
+#include "ShooterNPCSpawner.h"
+#include "ShooterNPC.h"
+#include "SynapseQuest.h"
+#include "GameFramework/PlayerStart.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectGlobals.h"
+
+UShooterBenchmarkCommandlet::UShooterBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = true;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UShooterBenchmarkCommandlet::Main(const FString& Params)
+{
+	// read the parameters
+	FString MapName = FShooterHeadlessWorld::GetDefaultMap();
+	FParse::Value(*Params, TEXT("Map="), MapName);
+
+	FString NPCClassPath;
+	FParse::Value(*Params, TEXT("NPCClass="), NPCClassPath);
+
+	int32 NPCsPerTeam = 4;
+	FParse::Value(*Params, TEXT("NPCsPerTeam="), NPCsPerTeam);
+
+	int32 NumFrames = 1800;
+	FParse::Value(*Params, TEXT("Frames="), NumFrames);
+
+	int32 WarmupFrames = 60;
+	FParse::Value(*Params, TEXT("WarmupFrames="), WarmupFrames);
+
+	float FPS = 30.0f;
+	FParse::Value(*Params, TEXT("FPS="), FPS);
+
+	int32 Seed = 1234;
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+
+	FString Label;
+	FParse::Value(*Params, TEXT("Label="), Label);
+
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmark") / TEXT("ShooterBenchmark.json");
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	if (NumFrames <= 0 || FPS <= 0.0f || NPCsPerTeam < 0)
+	{
+		UE_LOG(LogSynapseQuest, Error, TEXT("ShooterBenchmark: Frames and FPS must be positive"));
+		return 1;
+	}
+
+	// seed the gameplay random streams so every run makes the same choices.
+	// the global streams are seeded too for any engine code that draws from them
+	IConsoleManager::Get().FindConsoleVariable(TEXT("Shooter.Random.Seed"))->Set(Seed, ECVF_SetByCode);
+	FMath::RandInit(Seed);
+	FMath::SRandInit(Seed);
+
+	FShooterHeadlessWorld HeadlessWorld;
+
+	if (!HeadlessWorld.Load(MapName))
+	{
+		return 1;
+	}
+
+	UWorld* World = HeadlessWorld.GetWorld();
+
+	// use the requested NPC class, or the one from the first spawner in the map
+	TSubclassOf<AShooterNPC> NPCClass;
+
+	if (!NPCClassPath.IsEmpty())
+	{
+		NPCClass = LoadClass<AShooterNPC>(nullptr, *NPCClassPath);
+
+	} else {
+
+		for (TActorIterator<AShooterNPCSpawner> It(World); It; ++It)
+		{
+			if (It->GetNPCClass())
+			{
+				NPCClass = It->GetNPCClass();
+				break;
+			}
+		}
+	}
+
+	if (!SetupSpawners(World, NPCClass, NPCsPerTeam))
+	{
+		UE_LOG(LogSynapseQuest, Error, TEXT("ShooterBenchmark: no NPC class to spawn. Pass one with -NPCClass="));
+		return 1;
+	}
+
+	// count actor spawns and destroys
+	int32 NumSpawned = 0;
+	int32 NumDestroyed = 0;
+	bool bMeasuring = false;
+
+	const FDelegateHandle SpawnedHandle = World->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateLambda([&NumSpawned, &bMeasuring](AActor*)
+	{
+		NumSpawned += bMeasuring ? 1 : 0;
+	}));
+
+	const FDelegateHandle DestroyedHandle = World->AddOnActorDestroyedHandler(FOnActorDestroyed::FDelegate::CreateLambda([&NumDestroyed, &bMeasuring](AActor*)
+	{
+		NumDestroyed += bMeasuring ? 1 : 0;
+	}));
+
+	// time garbage collection
+	int32 NumGCs = 0;
+	double GCStartTime = 0.0;
+	double TotalGCSeconds = 0.0;
+	double WorstGCSeconds = 0.0;
+
+	const FDelegateHandle PreGCHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddLambda([&GCStartTime]()
+	{
+		GCStartTime = FPlatformTime::Seconds();
+	});
+
+	const FDelegateHandle PostGCHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddLambda([&]()
+	{
+		if (bMeasuring && GCStartTime > 0.0)
+		{
+			const double GCSeconds = FPlatformTime::Seconds() - GCStartTime;
+
+			++NumGCs;
+			TotalGCSeconds += GCSeconds;
+			WorstGCSeconds = FMath::Max(WorstGCSeconds, GCSeconds);
+		}
+	});
+
+	// run the benchmark
+	const float DeltaSeconds = 1.0f / FPS;
+
+	TArray<double> FrameTimes;
+	FrameTimes.Reserve(NumFrames);
+
+	UE_LOG(LogSynapseQuest, Display, TEXT("ShooterBenchmark: running %s with %d NPCs per team for %d frames after %d warmup frames"), *MapName, NPCsPerTeam, NumFrames, WarmupFrames);
+
+	for (int32 Frame = 0; Frame < WarmupFrames + NumFrames; ++Frame)
+	{
+		// start measuring after the warmup
+		if (Frame == WarmupFrames)
+		{
+			bMeasuring = true;
+			FShooterBenchmarkStats::Reset();
+		}
+
+		const double FrameStart = FPlatformTime::Seconds();
+
+		HeadlessWorld.Tick(DeltaSeconds);
+
+		if (bMeasuring)
+		{
+			FrameTimes.Add(FPlatformTime::Seconds() - FrameStart);
+		}
+	}
+
+	const int64 NumSceneQueries = FShooterBenchmarkStats::GetSceneQueries();
+
+	// unsubscribe before the world goes away
+	World->RemoveOnActorSpawnedHandler(SpawnedHandle);
+	World->RemoveOnActorDestroyedHandler(DestroyedHandle);
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(PreGCHandle);
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGCHandle);
+
+	HeadlessWorld.Shutdown();
+
+	// summarize the frame times
+	TArray<double> SortedFrameTimes = FrameTimes;
+	SortedFrameTimes.Sort();
+
+	double TotalSeconds = 0.0;
+
+	for (double FrameTime : FrameTimes)
+	{
+		TotalSeconds += FrameTime;
+	}
+
+	const auto Percentile = [&SortedFrameTimes](double Alpha)
+	{
+		return SortedFrameTimes[FMath::Clamp(FMath::FloorToInt(Alpha * (SortedFrameTimes.Num() - 1)), 0, SortedFrameTimes.Num() - 1)];
+	};
+
+	// write the results
+	TSharedRef<FJsonObject> Results = MakeShared<FJsonObject>();
+	Results->SetStringField(TEXT("label"), Label);
+	Results->SetStringField(TEXT("map"), MapName);
+	Results->SetNumberField(TEXT("seed"), Seed);
+	Results->SetNumberField(TEXT("npcsPerTeam"), NPCsPerTeam);
+	Results->SetNumberField(TEXT("frames"), NumFrames);
+	Results->SetNumberField(TEXT("fixedDeltaSeconds"), DeltaSeconds);
+
+	TSharedRef<FJsonObject> GameThread = MakeShared<FJsonObject>();
+	GameThread->SetNumberField(TEXT("totalMs"), TotalSeconds * 1000.0);
+	GameThread->SetNumberField(TEXT("averageMs"), TotalSeconds * 1000.0 / NumFrames);
+	GameThread->SetNumberField(TEXT("medianMs"), Percentile(0.5) * 1000.0);
+	GameThread->SetNumberField(TEXT("p95Ms"), Percentile(0.95) * 1000.0);
+	GameThread->SetNumberField(TEXT("worstMs"), SortedFrameTimes.Last() * 1000.0);
+	Results->SetObjectField(TEXT("gameThread"), GameThread);
+
+	TSharedRef<FJsonObject> SceneQueries = MakeShared<FJsonObject>();
+	SceneQueries->SetNumberField(TEXT("total"), static_cast<double>(NumSceneQueries));
+	SceneQueries->SetNumberField(TEXT("perFrame"), static_cast<double>(NumSceneQueries) / NumFrames);
+	Results->SetObjectField(TEXT("sceneQueries"), SceneQueries);
+
+	TSharedRef<FJsonObject> Actors = MakeShared<FJsonObject>();
+	Actors->SetNumberField(TEXT("spawned"), NumSpawned);
+	Actors->SetNumberField(TEXT("destroyed"), NumDestroyed);
+	Results->SetObjectField(TEXT("actors"), Actors);
+
+	TSharedRef<FJsonObject> GC = MakeShared<FJsonObject>();
+	GC->SetNumberField(TEXT("count"), NumGCs);
+	GC->SetNumberField(TEXT("totalMs"), TotalGCSeconds * 1000.0);
+	GC->SetNumberField(TEXT("worstMs"), WorstGCSeconds * 1000.0);
+	Results->SetObjectField(TEXT("gc"), GC);
+
+	FString Json;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Results, Writer);
+
+	if (!FFileHelper::SaveStringToFile(Json, *OutputPath))
+	{
+		UE_LOG(LogSynapseQuest, Error, TEXT("ShooterBenchmark: couldn't write %s"), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(LogSynapseQuest, Display, TEXT("ShooterBenchmark: average %.3f ms, p95 %.3f ms, %lld scene queries. Results written to %s"),
+		TotalSeconds * 1000.0 / NumFrames, Percentile(0.95) * 1000.0, NumSceneQueries, *OutputPath);
+
+	return 0;
+}
+
+bool UShooterBenchmarkCommandlet::SetupSpawners(UWorld* World, TSubclassOf<AShooterNPC> NPCClass, int32 NPCsPerTeam) const
+{
+	if (!NPCClass)
+	{
+		return false;
+	}
+
+	// use the placed spawners and player starts as spawn points
+	TArray<FTransform> SpawnPoints;
+
+	for (TActorIterator<AShooterNPCSpawner> It(World); It; ++It)
+	{
+		SpawnPoints.Add(It->GetActorTransform());
+
+		// remove the placed spawner so only the benchmark spawners run. It hasn't spawned anything yet
+		It->Destroy();
+	}
+
+	for (TActorIterator<APlayerStart> It(World); It; ++It)
+	{
+		SpawnPoints.Add(It->GetActorTransform());
+	}
+
+	if (SpawnPoints.Num() == 0)
+	{
+		SpawnPoints.Add(FTransform::Identity);
+	}
+
+	// create the benchmark spawners, split between the two teams
+	AShooterNPCSpawner::SpawnTeamSpawners(World, NPCClass, SpawnPoints, NPCsPerTeam);
+
+	return true;
+}
@@ -0,0 +1,36 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ShooterBenchmarkCommandlet.generated.h"
+
+class UWorld;
+class AShooterNPC;
+
+/**
+ *  Deterministic headless combat benchmark for the shooter variant
+ *  Loads a shooter map, replaces its NPC spawners with a configurable number of spawners per team,
+ *  runs a fixed number of frames at a fixed step with a fixed random seed, and writes the results to JSON
+ *  Usage: -run=ShooterBenchmark -nullrhi [-Map=] [-NPCClass=] [-NPCsPerTeam=4] [-Frames=1800] [-WarmupFrames=60]
+ *         [-FPS=30] [-Seed=1234] [-Label=] [-Output=]
+ */
+UCLASS()
+class SYNAPSEQUEST_API UShooterBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Constructor */
+	UShooterBenchmarkCommandlet();
+
+	/** Runs the benchmark */
+	virtual int32 Main(const FString& Params) override;
+
+protected:
+
+	/** Removes the spawners placed in the map and creates the benchmark spawners. Returns false if there's no NPC class to spawn */
+	bool SetupSpawners(UWorld* World, TSubclassOf<AShooterNPC> NPCClass, int32 NPCsPerTeam) const;
+};
@@ -0,0 +1,6 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/Benchmark/ShooterBenchmarkStats.h"
+
+std::atomic<int64> FShooterBenchmarkStats::NumSceneQueries(0);
@@ -0,0 +1,28 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/**
+ *  Global counters sampled by the shooter benchmark
+ *  Gameplay code bumps these next to the scene queries it runs. Each bump is a single relaxed atomic add,
+ *  so it's safe to call from the worker threads used by the batched weapon subsystems
+ */
+class SYNAPSEQUEST_API FShooterBenchmarkStats
+{
+	/** Scene queries issued by shooter gameplay code since the last reset */
+	static std::atomic<int64> NumSceneQueries;
+
+public:
+
+	/** Counts scene queries issued by gameplay code */
+	static void AddSceneQueries(int64 Count = 1) { NumSceneQueries.fetch_add(Count, std::memory_order_relaxed); }
+
+	/** Returns the number of scene queries issued since the last reset */
+	static int64 GetSceneQueries() { return NumSceneQueries.load(std::memory_order_relaxed); }
+
+	/** Resets every counter */
+	static void Reset() { NumSceneQueries.store(0, std::memory_order_relaxed); }
+};
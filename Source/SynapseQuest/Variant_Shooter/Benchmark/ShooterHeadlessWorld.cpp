@@ -0,0 +1,107 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/Benchmark/ShooterHeadlessWorld.h"
+#include "SynapseQuest.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Misc/App.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectGlobals.h"
+
+FShooterHeadlessWorld::~FShooterHeadlessWorld()
+{
+	Shutdown();
+}
+
+bool FShooterHeadlessWorld::Load(const FString& MapPackageName)
+{
+	Shutdown();
+
+	// load the map package
+	UPackage* MapPackage = LoadPackage(nullptr, *MapPackageName, LOAD_None);
+
+	if (!MapPackage)
+	{
+		UE_LOG(LogSynapseQuest, Error, TEXT("Headless world: couldn't load map package %s"), *MapPackageName);
+		return false;
+	}
+
+	World = UWorld::FindWorldInPackage(MapPackage);
+
+	if (!World)
+	{
+		UE_LOG(LogSynapseQuest, Error, TEXT("Headless world: %s doesn't contain a world"), *MapPackageName);
+		return false;
+	}
+
+	// set the world up as a game world
+	World->AddToRoot();
+	World->WorldType = EWorldType::Game;
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	GWorld = World;
+
+	World->InitWorld(UWorld::InitializationValues()
+		.AllowAudioPlayback(false)
+		.RequiresHitProxies(false)
+		.CreatePhysicsScene(true)
+		.CreateNavigation(true)
+		.CreateAISystem(true)
+		.ShouldSimulatePhysics(true)
+		.EnableTraceCollision(true)
+		.SetTransactional(false)
+		.CreateFXSystem(false));
+
+	World->UpdateWorldComponents(true, false);
+
+	// spawn the game mode and begin play
+	FURL URL;
+	World->SetGameMode(URL);
+	World->InitializeActorsForPlay(URL);
+	World->BeginPlay();
+
+	return true;
+}
+
+void FShooterHeadlessWorld::Tick(float DeltaSeconds)
+{
+	if (!World)
+	{
+		return;
+	}
+
+	// advance the global clocks the same way the engine loop does
+	++GFrameCounter;
+	FApp::SetDeltaTime(DeltaSeconds);
+	FApp::SetCurrentTime(FApp::GetCurrentTime() + DeltaSeconds);
+
+	World->Tick(LEVELTICK_All, DeltaSeconds);
+
+	// give the garbage collector a chance to run, same as the game engine tick
+	GEngine->ConditionalCollectGarbage();
+}
+
+void FShooterHeadlessWorld::Shutdown()
+{
+	if (!World)
+	{
+		return;
+	}
+
+	World->BeginTearingDown();
+	World->DestroyWorld(false);
+
+	GEngine->DestroyWorldContext(World);
+	World->RemoveFromRoot();
+
+	if (GWorld == World)
+	{
+		GWorld = nullptr;
+	}
+
+	World = nullptr;
+
+	CollectGarbage(RF_NoFlags);
+}
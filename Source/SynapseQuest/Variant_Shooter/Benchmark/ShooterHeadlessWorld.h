@@ -0,0 +1,43 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+
+/**
+ *  Loads a map into a standalone game world and ticks it at a fixed rate, without a viewport or local player
+ *  Used by the shooter commandlets to run levels headless. Run them with -nullrhi
+ */
+class SYNAPSEQUEST_API FShooterHeadlessWorld
+{
+public:
+
+	/** Tears down the world if it's still loaded */
+	~FShooterHeadlessWorld();
+
+	/**
+	 *  Loads the passed map and begins play on it
+	 *  @param MapPackageName Long package name of the map, e.g. /Game/Variant_Shooter/Lvl_Shooter
+	 *  @return true if the world is ready to tick
+	 */
+	bool Load(const FString& MapPackageName);
+
+	/** Advances the world by a single fixed step */
+	void Tick(float DeltaSeconds);
+
+	/** Ends play and destroys the world */
+	void Shutdown();
+
+	/** Returns the loaded world, or nullptr */
+	UWorld* GetWorld() const { return World; }
+
+	/** Returns the default map used by the shooter commandlets */
+	static const TCHAR* GetDefaultMap() { return TEXT("/Game/Variant_Shooter/Lvl_Shooter"); }
+
+private:
+
+	/** Loaded world */
+	UWorld* World = nullptr;
+};
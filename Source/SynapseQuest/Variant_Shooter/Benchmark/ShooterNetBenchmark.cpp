@@ -0,0 +1,117 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/Benchmark/ShooterNetBenchmark.h"
+#include "ShooterNPCSpawner.h"
+#include "ShooterNPC.h"
+#include "Engine/World.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetworkObjectList.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/OutputDevice.h"
+#include "CoreGlobals.h"
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice ShooterNetSpawnBotsCommand(
+	TEXT("Shooter.Net.SpawnBots"),
+	TEXT("Spawns respawning NPCs for both teams at the placed spawners. Usage: Shooter.Net.SpawnBots <BotsPerTeam>. Server only."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		const int32 BotsPerTeam = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 8;
+		const int32 NumSpawned = FShooterNetBenchmark::SpawnBots(World, BotsPerTeam);
+
+		Ar.Logf(TEXT("Shooter.Net.SpawnBots: %d bots spawned"), NumSpawned);
+	}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice ShooterNetReportCommand(
+	TEXT("Shooter.Net.Report"),
+	TEXT("Prints the current bandwidth, per connection stats and frame times."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		FShooterNetBenchmark::Report(World, Ar);
+	}));
+
+int32 FShooterNetBenchmark::SpawnBots(UWorld* World, int32 BotsPerTeam)
+{
+	// only the server can spawn bots
+	if (!World || World->GetNetMode() == NM_Client || BotsPerTeam <= 0)
+	{
+		return 0;
+	}
+
+	// reuse the NPC class and locations of the placed spawners
+	TSubclassOf<AShooterNPC> NPCClass;
+	TArray<FTransform> SpawnPoints;
+
+	for (TActorIterator<AShooterNPCSpawner> It(World); It; ++It)
+	{
+		if (!NPCClass)
+		{
+			NPCClass = It->GetNPCClass();
+		}
+
+		SpawnPoints.Add(It->GetActorTransform());
+	}
+
+	return AShooterNPCSpawner::SpawnTeamSpawners(World, NPCClass, SpawnPoints, BotsPerTeam);
+}
+
+void FShooterNetBenchmark::Report(UWorld* World, FOutputDevice& Ar)
+{
+	UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+
+	if (!NetDriver)
+	{
+		Ar.Logf(TEXT("Shooter.Net.Report: not running a network game"));
+		return;
+	}
+
+	// count the live bots
+	int32 NumBots = 0;
+
+	for (TActorIterator<AShooterNPC> It(World); It; ++It)
+	{
+		if (!It->IsDormant() && !It->IsDead())
+		{
+			++NumBots;
+		}
+	}
+
+	const bool bClient = World->GetNetMode() == NM_Client;
+
+	Ar.Logf(TEXT("Shooter.Net.Report: %s, %d live bots, %d client connections"),
+		bClient ? TEXT("client") : TEXT("server"), NumBots, NetDriver->ClientConnections.Num());
+
+	Ar.Logf(TEXT("  total: in %u B/s, out %u B/s, in %u packets/s, out %u packets/s"),
+		NetDriver->InBytesPerSecond, NetDriver->OutBytesPerSecond, NetDriver->InPacketsPerSecond, NetDriver->OutPacketsPerSecond);
+
+	if (!bClient)
+	{
+		const FNetworkObjectList& NetworkObjects = NetDriver->GetNetworkObjectList();
+
+		Ar.Logf(TEXT("  actors: %d active, %d dormant on all connections"),
+			NetworkObjects.GetActiveObjects().Num(), NetworkObjects.GetDormantObjectsOnAllConnections().Num());
+	}
+
+	Ar.Logf(TEXT("  game thread %.2f ms, frame %.2f ms"), FPlatformTime::ToMilliseconds(GGameThreadTime), FApp::GetDeltaTime() * 1000.0);
+
+	// per connection stats. Clients only have the server connection
+	TArray<UNetConnection*> Connections(NetDriver->ClientConnections);
+
+	if (NetDriver->ServerConnection)
+	{
+		Connections.Add(NetDriver->ServerConnection);
+	}
+
+	for (UNetConnection* Connection : Connections)
+	{
+		Ar.Logf(TEXT("  %s: in %d B/s, out %d B/s, ping %.0f ms, %d open channels"),
+			*Connection->LowLevelGetRemoteAddress(true),
+			static_cast<int32>(Connection->InBytesPerSecond),
+			static_cast<int32>(Connection->OutBytesPerSecond),
+			Connection->AvgLag * 1000.0,
+			Connection->OpenChannels.Num());
+	}
+}
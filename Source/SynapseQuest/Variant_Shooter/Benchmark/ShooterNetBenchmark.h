@@ -0,0 +1,24 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+class FOutputDevice;
+
+/**
+ *  Helpers to measure the shooter game over the network
+ *  Bots are spawned on the server with Shooter.Net.SpawnBots, and bandwidth and game thread time
+ *  are printed with Shooter.Net.Report on either the server or a client
+ */
+class SYNAPSEQUEST_API FShooterNetBenchmark
+{
+public:
+
+	/** Spawns respawning NPCs for both teams at the placed spawners. Server only. Returns the number of spawners created */
+	static int32 SpawnBots(UWorld* World, int32 BotsPerTeam);
+
+	/** Prints the current bandwidth, per connection stats and frame times */
+	static void Report(UWorld* World, FOutputDevice& Ar);
+};
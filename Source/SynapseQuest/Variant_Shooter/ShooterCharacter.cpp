@@ -3,6 +3,9 @@
 
 #include "ShooterCharacter.h"
 #include "ShooterWeapon.h"
+#include "ShooterBenchmarkStats.h"
+#include "ShooterTeamSubsystem.h"
+#include "SQTraceBatchSubsystem.h"
 #include "EnhancedInputComponent.h"
 #include "Components/InputComponent.h"
 #include "Components/PawnNoiseEmitterComponent.h"
@@ -12,6 +15,8 @@
 #include "Camera/CameraComponent.h"
 #include "TimerManager.h"
 #include "ShooterGameMode.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
 
 AShooterCharacter::AShooterCharacter()
 {
@@ -26,11 +31,21 @@ void AShooterCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// reset HP to max
-	CurrentHP = MaxHP;
+	// reset HP to max. Clients already have the replicated HP, which may be lower if we joined late
+	if (HasAuthority())
+	{
+		CurrentHP = MaxHP;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AShooterCharacter, CurrentHP, this);
+	}
+
+	// join our team. We're not a valid target until possessed, so pre-spawned characters waiting to respawn are ignored
+	if (UShooterTeamSubsystem* Teams = UShooterTeamSubsystem::Get(this))
+	{
+		Teams->RegisterMember(this, TeamByte, false);
+	}
 
 	// update the HUD
-	OnDamaged.Broadcast(1.0f);
+	OnDamaged.Broadcast(FMath::Max(0.0f, CurrentHP / MaxHP));
 }
 
 void AShooterCharacter::EndPlay(EEndPlayReason::Type EndPlayReason)
@@ -39,6 +54,12 @@ void AShooterCharacter::EndPlay(EEndPlayReason::Type EndPlayReason)
 
 	// clear the respawn timer
 	GetWorld()->GetTimerManager().ClearTimer(RespawnTimer);
+
+	// leave our team
+	if (UShooterTeamSubsystem* Teams = UShooterTeamSubsystem::Get(this))
+	{
+		Teams->UnregisterMember(this);
+	}
 }
 
 void AShooterCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
@@ -59,16 +80,44 @@ void AShooterCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCo
 
 }
 
+void AShooterCharacter::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+
+	// start being a valid target
+	if (UShooterTeamSubsystem* Teams = UShooterTeamSubsystem::Get(this))
+	{
+		Teams->SetAlive(this, !IsDead());
+	}
+}
+
+void AShooterCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterCharacter, CurrentHP, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterCharacter, CurrentWeapon, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterCharacter, bDormant, Params);
+
+	// only the owner needs the full inventory to switch weapons
+	Params.Condition = COND_OwnerOnly;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterCharacter, OwnedWeapons, Params);
+}
+
 float AShooterCharacter::TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
-	// ignore if already dead
-	if (CurrentHP <= 0.0f)
+	// damage is server authoritative. Ignore if already dead
+	if (!HasAuthority() || CurrentHP <= 0.0f)
 	{
 		return 0.0f;
 	}
 
 	// Reduce HP
 	CurrentHP -= Damage;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterCharacter, CurrentHP, this);
 
 	// Have we depleted HP?
 	if (CurrentHP <= 0.0f)
@@ -123,7 +172,13 @@ void AShooterCharacter::DoStartFiring()
 	// fire the current weapon
 	if (CurrentWeapon && !IsDead())
 	{
+		// clients predict the shot locally and have the server fire it for real
 		CurrentWeapon->StartFiring();
+
+		if (!HasAuthority())
+		{
+			ServerStartFiring();
+		}
 	}
 }
 
@@ -133,10 +188,50 @@ void AShooterCharacter::DoStopFiring()
 	if (CurrentWeapon && !IsDead())
 	{
 		CurrentWeapon->StopFiring();
+
+		if (!HasAuthority())
+		{
+			ServerStopFiring();
+		}
 	}
 }
 
 void AShooterCharacter::DoSwitchWeapon()
+{
+	// clients wait for the server to replicate the new weapon
+	if (HasAuthority())
+	{
+		SwitchToNextWeapon();
+
+	} else {
+
+		ServerSwitchWeapon();
+
+	}
+}
+
+void AShooterCharacter::ServerStartFiring_Implementation()
+{
+	if (CurrentWeapon && !IsDead())
+	{
+		CurrentWeapon->StartFiring();
+	}
+}
+
+void AShooterCharacter::ServerStopFiring_Implementation()
+{
+	if (CurrentWeapon && !IsDead())
+	{
+		CurrentWeapon->StopFiring();
+	}
+}
+
+void AShooterCharacter::ServerSwitchWeapon_Implementation()
+{
+	SwitchToNextWeapon();
+}
+
+void AShooterCharacter::SwitchToNextWeapon()
 {
 	// ensure we have at least two weapons two switch between
 	if (OwnedWeapons.Num() > 1 && !IsDead())
@@ -160,12 +255,71 @@ void AShooterCharacter::DoSwitchWeapon()
 
 		// set the new weapon as current
 		CurrentWeapon = OwnedWeapons[WeaponIndex];
+		MARK_PROPERTY_DIRTY_FROM_NAME(AShooterCharacter, CurrentWeapon, this);
 
 		// activate the new weapon
 		CurrentWeapon->ActivateWeapon();
 	}
 }
 
+void AShooterCharacter::OnRep_CurrentHP()
+{
+	// update the HUD
+	OnDamaged.Broadcast(FMath::Max(0.0f, CurrentHP / MaxHP));
+
+	// play the death the server already went through
+	if (CurrentHP <= 0.0f)
+	{
+		PlayDeathEffects();
+	}
+}
+
+void AShooterCharacter::SetDormant(bool bNewDormant)
+{
+	bDormant = bNewDormant;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterCharacter, bDormant, this);
+
+	ApplyDormantState();
+}
+
+void AShooterCharacter::ApplyDormantState()
+{
+	// hide or show the character. Collision and tick don't replicate, so every machine applies them
+	SetActorHiddenInGame(bDormant);
+	SetActorEnableCollision(!bDormant);
+	SetActorTickEnabled(!bDormant);
+
+	if (bDormant)
+	{
+		GetCharacterMovement()->DisableMovement();
+
+	} else {
+
+		GetCharacterMovement()->SetDefaultMovementMode();
+
+	}
+}
+
+void AShooterCharacter::OnRep_Dormant()
+{
+	ApplyDormantState();
+}
+
+void AShooterCharacter::OnRep_CurrentWeapon(AShooterWeapon* OldWeapon)
+{
+	// stop any shots predicted with the old weapon
+	if (IsValid(OldWeapon))
+	{
+		OldWeapon->StopFiring();
+	}
+
+	// set up the meshes and HUD for the new weapon. The server already replicates its visibility
+	if (IsValid(CurrentWeapon))
+	{
+		OnWeaponActivated(CurrentWeapon);
+	}
+}
+
 void AShooterCharacter::AttachWeaponMeshes(AShooterWeapon* Weapon)
 {
 	const FAttachmentTransformRules AttachmentRule(EAttachmentRule::SnapToTarget, false);
@@ -197,19 +351,31 @@ void AShooterCharacter::UpdateWeaponHUD(int32 CurrentAmmo, int32 MagazineSize)
 
 FVector AShooterCharacter::GetWeaponTargetLocation()
 {
-	// trace ahead from the camera viewpoint
-	FHitResult OutHit;
-
+	// trace ahead from the camera viewpoint. Aim with the control rotation so the server sees the same shot as the owning client
 	const FVector Start = GetFirstPersonCameraComponent()->GetComponentLocation();
-	const FVector End = Start + (GetFirstPersonCameraComponent()->GetForwardVector() * MaxAimDistance);
+	const FVector End = Start + (GetBaseAimRotation().Vector() * MaxAimDistance);
 
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this);
+	FSQTraceRequest Request;
+	Request.Source = ESQTraceSource::PlayerAim;
+	Request.Start = Start;
+	Request.End = End;
+	Request.QueryParams.AddIgnoredActor(this);
 
-	GetWorld()->LineTraceSingleByChannel(OutHit, Start, End, ECC_Visibility, QueryParams);
+	FShooterBenchmarkStats::AddSceneQueries();
+
+	// the shot goes out this frame, so don't wait for the batch
+	if (USQTraceBatchSubsystem* Traces = USQTraceBatchSubsystem::Get(this))
+	{
+		TArray<FHitResult> OutHits;
+		Traces->TraceImmediate(Request, OutHits);
 
-	// return either the impact point or the trace end
-	return OutHit.bBlockingHit ? OutHit.ImpactPoint : OutHit.TraceEnd;
+		// return either the impact point or the trace end
+		return OutHits[0].bBlockingHit ? OutHits[0].ImpactPoint : OutHits[0].TraceEnd;
+	}
+
+	// no trace batching in this world, so trace directly
+	FHitResult OutHit;
+	return GetWorld()->LineTraceSingleByChannel(OutHit, Request.Start, Request.End, Request.Channel, Request.QueryParams) ? OutHit.ImpactPoint : Request.End;
 }
 
 void AShooterCharacter::AddWeaponClass(const TSubclassOf<AShooterWeapon>& WeaponClass)
@@ -232,6 +398,7 @@ void AShooterCharacter::AddWeaponClass(const TSubclassOf<AShooterWeapon>& Weapon
 		{
 			// add the weapon to the owned list
 			OwnedWeapons.Add(AddedWeapon);
+			MARK_PROPERTY_DIRTY_FROM_NAME(AShooterCharacter, OwnedWeapons, this);
 
 			// if we have an existing weapon, deactivate it
 			if (CurrentWeapon)
@@ -241,6 +408,8 @@ void AShooterCharacter::AddWeaponClass(const TSubclassOf<AShooterWeapon>& Weapon
 
 			// switch to the new weapon
 			CurrentWeapon = AddedWeapon;
+			MARK_PROPERTY_DIRTY_FROM_NAME(AShooterCharacter, CurrentWeapon, this);
+
 			CurrentWeapon->ActivateWeapon();
 		}
 	}
@@ -282,6 +451,27 @@ AShooterWeapon* AShooterCharacter::FindWeaponOfType(TSubclassOf<AShooterWeapon>
 
 }
 
+void AShooterCharacter::SetGenericTeamId(const FGenericTeamId& NewTeamID)
+{
+	TeamByte = NewTeamID.GetId();
+
+	// keep the team registry up to date
+	if (UShooterTeamSubsystem* Teams = UShooterTeamSubsystem::Get(this))
+	{
+		Teams->SetTeam(this, TeamByte);
+	}
+}
+
+ETeamAttitude::Type AShooterCharacter::GetTeamAttitudeTowards(const AActor& Other) const
+{
+	if (const UShooterTeamSubsystem* Teams = UShooterTeamSubsystem::Get(this))
+	{
+		return Teams->GetAttitude(this, &Other);
+	}
+
+	return IGenericTeamAgentInterface::GetTeamAttitudeTowards(Other);
+}
+
 void AShooterCharacter::Die()
 {
 	// deactivate the weapon
@@ -298,21 +488,36 @@ void AShooterCharacter::Die()
 
 	// grant the death tag to the character
 	Tags.Add(DeathTag);
-		
-	// stop character movement
-	GetCharacterMovement()->StopMovementImmediately();
+
+	// stop being a valid target
+	if (UShooterTeamSubsystem* Teams = UShooterTeamSubsystem::Get(this))
+	{
+		Teams->SetAlive(this, false);
+	}
 
 	// disable controls
 	DisableInput(nullptr);
 
+	// clients play the effects when the depleted HP replicates
+	PlayDeathEffects();
+
+	// notify the controller so it can prepare the respawn
+	OnDeath.Broadcast(RespawnTime);
+
+	// schedule character respawn
+	GetWorld()->GetTimerManager().SetTimer(RespawnTimer, this, &AShooterCharacter::OnRespawn, RespawnTime, false);
+}
+
+void AShooterCharacter::PlayDeathEffects()
+{
+	// stop character movement
+	GetCharacterMovement()->StopMovementImmediately();
+
 	// reset the bullet counter UI
 	OnBulletCountUpdated.Broadcast(0, 0);
 
 	// call the BP handler
 	BP_OnDeath();
-
-	// schedule character respawn
-	GetWorld()->GetTimerManager().SetTimer(RespawnTimer, this, &AShooterCharacter::OnRespawn, RespawnTime, false);
 }
 
 void AShooterCharacter::OnRespawn()
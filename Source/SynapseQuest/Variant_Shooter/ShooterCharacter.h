@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "SynapseQuestCharacter.h"
 #include "ShooterWeaponHolder.h"
+#include "GenericTeamAgentInterface.h"
 #include "ShooterCharacter.generated.h"
 
 class AShooterWeapon;
@@ -14,6 +15,7 @@ class UPawnNoiseEmitterComponent;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FBulletCountUpdatedDelegate, int32, MagazineSize, int32, Bullets);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FDamagedDelegate, float, LifePercent);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FShooterDeathDelegate, float, RespawnDelay);
 
 /**
  *  A player controllable first person shooter character
@@ -21,7 +23,7 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FDamagedDelegate, float, LifePercent
  *  Manages health and death
  */
 UCLASS(abstract)
-class SYNAPSEQUEST_API AShooterCharacter : public ASynapseQuestCharacter, public IShooterWeaponHolder
+class SYNAPSEQUEST_API AShooterCharacter : public ASynapseQuestCharacter, public IShooterWeaponHolder, public IGenericTeamAgentInterface
 {
 	GENERATED_BODY()
 	
@@ -55,7 +57,8 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Health")
 	float MaxHP = 500.0f;
 
-	/** Current HP remaining to this character */
+	/** Current HP remaining to this character. Only changed by the server */
+	UPROPERTY(ReplicatedUsing=OnRep_CurrentHP)
 	float CurrentHP = 0.0f;
 
 	/** Team ID for this character*/
@@ -66,12 +69,18 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Team")
 	FName DeathTag = FName("Dead");
 
-	/** List of weapons picked up by the character */
-	TArray<AShooterWeapon*> OwnedWeapons;
+	/** List of weapons picked up by the character. Only replicated to the owning client */
+	UPROPERTY(Replicated)
+	TArray<TObjectPtr<AShooterWeapon>> OwnedWeapons;
 
 	/** Weapon currently equipped and ready to shoot with */
+	UPROPERTY(ReplicatedUsing=OnRep_CurrentWeapon)
 	TObjectPtr<AShooterWeapon> CurrentWeapon;
 
+	/** If true, this character was spawned ahead of time and is waiting to be possessed. It's hidden, without collision and doesn't tick */
+	UPROPERTY(ReplicatedUsing=OnRep_Dormant)
+	bool bDormant = false;
+
 	UPROPERTY(EditAnywhere, Category ="Destruction", meta = (ClampMin = 0, ClampMax = 10, Units = "s"))
 	float RespawnTime = 5.0f;
 
@@ -85,6 +94,9 @@ public:
 	/** Damaged delegate */
 	FDamagedDelegate OnDamaged;
 
+	/** Death delegate. Passes the time left until the character is destroyed and the player respawns */
+	FShooterDeathDelegate OnDeath;
+
 public:
 
 	/** Constructor */
@@ -101,8 +113,14 @@ protected:
 	/** Set up input action bindings */
 	virtual void SetupPlayerInputComponent(UInputComponent* InputComponent) override;
 
+	/** Becomes a valid target once a controller takes over */
+	virtual void PossessedBy(AController* NewController) override;
+
 public:
 
+	/** Sets up push model replication */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 	/** Handle incoming damage */
 	virtual float TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
 
@@ -132,6 +150,38 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Input")
 	void DoSwitchWeapon();
 
+protected:
+
+	/** Fires the current weapon on the server. The owning client has already predicted the shot */
+	UFUNCTION(Server, Reliable)
+	void ServerStartFiring();
+
+	/** Stops firing the current weapon on the server */
+	UFUNCTION(Server, Reliable)
+	void ServerStopFiring();
+
+	/** Switches weapons on the server */
+	UFUNCTION(Server, Reliable)
+	void ServerSwitchWeapon();
+
+	/** Deactivates the current weapon and activates the next owned one */
+	void SwitchToNextWeapon();
+
+	/** Updates the HUD and plays the death on clients */
+	UFUNCTION()
+	void OnRep_CurrentHP();
+
+	/** Updates the meshes and HUD on clients when the equipped weapon changes */
+	UFUNCTION()
+	void OnRep_CurrentWeapon(AShooterWeapon* OldWeapon);
+
+	/** Shows or hides this character according to its dormant flag */
+	void ApplyDormantState();
+
+	/** Hides or shows this character on clients */
+	UFUNCTION()
+	void OnRep_Dormant();
+
 public:
 
 	//~Begin IShooterWeaponHolder interface
@@ -165,6 +215,21 @@ public:
 
 	//~End IShooterWeaponHolder interface
 
+public:
+
+	//~Begin IGenericTeamAgentInterface
+
+	/** Assigns this character to a team */
+	virtual void SetGenericTeamId(const FGenericTeamId& NewTeamID) override;
+
+	/** Returns the team this character belongs to */
+	virtual FGenericTeamId GetGenericTeamId() const override { return FGenericTeamId(TeamByte); }
+
+	/** Returns how this character feels about the passed actor */
+	virtual ETeamAttitude::Type GetTeamAttitudeTowards(const AActor& Other) const override;
+
+	//~End IGenericTeamAgentInterface
+
 protected:
 
 	/** Returns true if the character already owns a weapon of the given class */
@@ -173,6 +238,9 @@ protected:
 	/** Called when this character's HP is depleted */
 	void Die();
 
+	/** Plays the death on this machine. Runs on the server and every client */
+	void PlayDeathEffects();
+
 	/** Called to allow Blueprint code to react to this character's death */
 	UFUNCTION(BlueprintImplementableEvent, Category="Shooter", meta = (DisplayName = "On Death"))
 	void BP_OnDeath();
@@ -184,4 +252,7 @@ public:
 
 	/** Returns true if the character is dead */
 	bool IsDead() const;
+
+	/** Puts this character to sleep while it waits to be possessed, or wakes it up. Server only */
+	void SetDormant(bool bNewDormant);
 };
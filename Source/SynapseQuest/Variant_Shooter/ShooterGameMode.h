@@ -10,8 +10,8 @@ class UShooterUI;
 
 /**
  *  Simple GameMode for a first person shooter game
- *  Manages game UI
- *  Keeps track of team scores
+ *  Sets up the game UI class
+ *  Keeps track of team scores through the Shooter GameState
  */
 UCLASS(abstract)
 class SYNAPSEQUEST_API AShooterGameMode : public AGameModeBase
@@ -20,22 +20,17 @@ class SYNAPSEQUEST_API AShooterGameMode : public AGameModeBase
 	
 protected:
 
-	/** Type of UI widget to spawn */
+	/** Type of UI widget to spawn. Created by the GameState for each local player */
 	UPROPERTY(EditAnywhere, Category="Shooter")
 	TSubclassOf<UShooterUI> ShooterUIClass;
 
-	/** Pointer to the UI widget */
-	TObjectPtr<UShooterUI> ShooterUI;
-
-	/** Map of scores by team ID */
-	TMap<uint8, int32> TeamScores;
-
-protected:
+public:
 
-	/** Gameplay initialization */
-	virtual void BeginPlay() override;
+	/** Constructor */
+	AShooterGameMode();
 
-public:
+	/** Returns the type of UI widget to spawn */
+	const TSubclassOf<UShooterUI>& GetShooterUIClass() const { return ShooterUIClass; }
 
 	/** Increases the score for the given team */
 	void IncrementTeamScore(uint8 TeamByte);
@@ -0,0 +1,115 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/ShooterGameState.h"
+#include "ShooterGameMode.h"
+#include "ShooterUI.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+
+void FShooterTeamScore::PostReplicatedAdd(const FShooterTeamScoreArray& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnTeamScoreChanged(*this);
+	}
+}
+
+void FShooterTeamScore::PostReplicatedChange(const FShooterTeamScoreArray& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnTeamScoreChanged(*this);
+	}
+}
+
+AShooterGameState::AShooterGameState()
+{
+	TeamScores.Owner = this;
+}
+
+void AShooterGameState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterGameState, TeamScores, Params);
+}
+
+void AShooterGameState::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// create the UI. There's no local player to own it when running headless or as a dedicated server,
+	// and on clients the player controller may replicate after us, in which case it creates the UI itself
+	CreateScoreboardUI(GetWorld()->GetFirstPlayerController());
+}
+
+void AShooterGameState::CreateScoreboardUI(APlayerController* OwningPlayer)
+{
+	if (ShooterUI || !OwningPlayer || !OwningPlayer->IsLocalController())
+	{
+		return;
+	}
+
+	// the UI class is set on the game mode, which clients only know by its defaults
+	const AShooterGameMode* GameModeDefaults = GetDefaultGameMode<AShooterGameMode>();
+
+	if (!GameModeDefaults)
+	{
+		return;
+	}
+
+	ShooterUI = CreateWidget<UShooterUI>(OwningPlayer, GameModeDefaults->GetShooterUIClass());
+
+	if (ShooterUI)
+	{
+		ShooterUI->AddToViewport(0);
+
+		// catch up on the scores from before we joined
+		for (const FShooterTeamScore& TeamScore : TeamScores.Items)
+		{
+			ShooterUI->SetTeamScore(TeamScore.Team, TeamScore.Score);
+		}
+	}
+}
+
+void AShooterGameState::IncrementTeamScore(uint8 TeamByte)
+{
+	// find the team's entry, adding it if needed
+	FShooterTeamScore* TeamScore = TeamScores.Items.FindByPredicate([TeamByte](const FShooterTeamScore& Item) { return Item.Team == TeamByte; });
+
+	if (!TeamScore)
+	{
+		TeamScore = &TeamScores.Items.AddDefaulted_GetRef();
+		TeamScore->Team = TeamByte;
+	}
+
+	// increment the score and replicate only this team
+	++TeamScore->Score;
+
+	TeamScores.MarkItemDirty(*TeamScore);
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterGameState, TeamScores, this);
+
+	// update the local UI, if any
+	OnTeamScoreChanged(*TeamScore);
+}
+
+int32 AShooterGameState::GetTeamScore(uint8 TeamByte) const
+{
+	const FShooterTeamScore* TeamScore = TeamScores.Items.FindByPredicate([TeamByte](const FShooterTeamScore& Item) { return Item.Team == TeamByte; });
+
+	return TeamScore ? TeamScore->Score : 0;
+}
+
+void AShooterGameState::OnTeamScoreChanged(const FShooterTeamScore& TeamScore)
+{
+	if (ShooterUI)
+	{
+		ShooterUI->SetTeamScore(TeamScore.Team, TeamScore.Score);
+	}
+}
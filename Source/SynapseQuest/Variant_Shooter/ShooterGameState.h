@@ -0,0 +1,115 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/GameStateBase.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "ShooterGameState.generated.h"
+
+class AShooterGameState;
+class APlayerController;
+class UShooterUI;
+
+/**
+ *  Score of a single team on the replicated scoreboard
+ */
+USTRUCT()
+struct FShooterTeamScore : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	/** Team ID */
+	UPROPERTY()
+	uint8 Team = 0;
+
+	/** Current score for the team */
+	UPROPERTY()
+	int32 Score = 0;
+
+	/** Pushes a newly replicated team to the UI */
+	void PostReplicatedAdd(const struct FShooterTeamScoreArray& InArraySerializer);
+
+	/** Pushes a replicated score change to the UI */
+	void PostReplicatedChange(const struct FShooterTeamScoreArray& InArraySerializer);
+};
+
+/**
+ *  Replicated team scoreboard
+ *  Only the teams whose score changed are sent to clients
+ */
+USTRUCT()
+struct FShooterTeamScoreArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	/** Scores by team */
+	UPROPERTY()
+	TArray<FShooterTeamScore> Items;
+
+	/** Game state owning this scoreboard */
+	UPROPERTY(NotReplicated)
+	TObjectPtr<AShooterGameState> Owner;
+
+	/** Delta serializes the changed teams */
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FShooterTeamScore, FShooterTeamScoreArray>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FShooterTeamScoreArray> : public TStructOpsTypeTraitsBase2<FShooterTeamScoreArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+/**
+ *  Simple GameState for a first person shooter game
+ *  Replicates team scores to clients
+ *  Manages the scoreboard UI for the local player
+ */
+UCLASS()
+class SYNAPSEQUEST_API AShooterGameState : public AGameStateBase
+{
+	GENERATED_BODY()
+
+	/** Replicated team scores */
+	UPROPERTY(Replicated)
+	FShooterTeamScoreArray TeamScores;
+
+	/** Pointer to the scoreboard UI widget, if there's a local player to own it */
+	UPROPERTY()
+	TObjectPtr<UShooterUI> ShooterUI;
+
+public:
+
+	/** Constructor */
+	AShooterGameState();
+
+	/** Sets up push model replication */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+protected:
+
+	/** Gameplay initialization */
+	virtual void BeginPlay() override;
+
+public:
+
+	/** Creates the scoreboard UI for a local player. Does nothing if it already exists */
+	void CreateScoreboardUI(APlayerController* OwningPlayer);
+
+	/** Increases the score for the given team. Server only */
+	void IncrementTeamScore(uint8 TeamByte);
+
+	/** Returns the score for the given team */
+	UFUNCTION(BlueprintPure, Category="Shooter")
+	int32 GetTeamScore(uint8 TeamByte) const;
+
+	/** Pushes a team score to the UI */
+	void OnTeamScoreChanged(const FShooterTeamScore& TeamScore);
+};
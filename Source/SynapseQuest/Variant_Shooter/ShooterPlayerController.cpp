@@ -5,13 +5,21 @@
 #include "EnhancedInputSubsystems.h"
 #include "Engine/LocalPlayer.h"
 #include "InputMappingContext.h"
-#include "Kismet/GameplayStatics.h"
-#include "GameFramework/PlayerStart.h"
+#include "TimerManager.h"
 #include "ShooterCharacter.h"
 #include "ShooterBulletCounterUI.h"
+#include "ShooterGameState.h"
+#include "ShooterSpawnPointSubsystem.h"
+#include "Dialogue/SQDialogueRelayComponent.h"
 #include "SynapseQuest.h"
 #include "Widgets/Input/SVirtualJoystick.h"
 
+AShooterPlayerController::AShooterPlayerController()
+{
+	// create the dialogue relay
+	DialogueRelay = CreateDefaultSubobject<USQDialogueRelayComponent>(TEXT("Dialogue Relay"));
+}
+
 void AShooterPlayerController::BeginPlay()
 {
 	Super::BeginPlay();
@@ -48,8 +56,28 @@ void AShooterPlayerController::BeginPlay()
 			UE_LOG(LogSynapseQuest, Error, TEXT("Could not spawn bullet counter widget."));
 
 		}
-		
+
+		// create the scoreboard if the GameState replicated before us
+		if (AShooterGameState* ShooterGameState = GetWorld()->GetGameState<AShooterGameState>())
+		{
+			ShooterGameState->CreateScoreboardUI(this);
+		}
+	}
+}
+
+void AShooterPlayerController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	GetWorld()->GetTimerManager().ClearTimer(PreSpawnTimer);
+
+	// clean up the character we had waiting
+	if (IsValid(PendingRespawnCharacter))
+	{
+		PendingRespawnCharacter->Destroy();
 	}
+
+	PendingRespawnCharacter = nullptr;
 }
 
 void AShooterPlayerController::SetupInputComponent()
@@ -92,9 +120,27 @@ void AShooterPlayerController::OnPossess(APawn* InPawn)
 		// add the player tag
 		ShooterCharacter->Tags.Add(PlayerPawnTag);
 
-		// subscribe to the pawn's delegates
-		ShooterCharacter->OnBulletCountUpdated.AddDynamic(this, &AShooterPlayerController::OnBulletCountUpdated);
-		ShooterCharacter->OnDamaged.AddDynamic(this, &AShooterPlayerController::OnPawnDamaged);
+		// subscribe to the pawn's death so we can prepare the respawn
+		ShooterCharacter->OnDeath.AddDynamic(this, &AShooterPlayerController::OnPawnDied);
+	}
+}
+
+void AShooterPlayerController::SetPawn(APawn* InPawn)
+{
+	Super::SetPawn(InPawn);
+
+	// only local players have a HUD to update
+	if (!IsLocalPlayerController())
+	{
+		return;
+	}
+
+	// is this a shooter character?
+	if (AShooterCharacter* ShooterCharacter = Cast<AShooterCharacter>(InPawn))
+	{
+		// subscribe to the pawn's HUD delegates
+		ShooterCharacter->OnBulletCountUpdated.AddUniqueDynamic(this, &AShooterPlayerController::OnBulletCountUpdated);
+		ShooterCharacter->OnDamaged.AddUniqueDynamic(this, &AShooterPlayerController::OnPawnDamaged);
 
 		// force update the life bar
 		ShooterCharacter->OnDamaged.Broadcast(1.0f);
@@ -106,26 +152,79 @@ void AShooterPlayerController::OnPawnDestroyed(AActor* DestroyedActor)
 	// reset the bullet counter HUD
 	if (IsValid(BulletCounterUI))
 	{
-		BulletCounterUI->BP_UpdateBulletCounter(0, 0);
+		BulletCounterUI->SetBulletCount(0, 0);
+	}
+
+	GetWorld()->GetTimerManager().ClearTimer(PreSpawnTimer);
+
+	// pick the safest player start
+	UShooterSpawnPointSubsystem* SpawnPoints = GetWorld()->GetSubsystem<UShooterSpawnPointSubsystem>();
+
+	FTransform SpawnTransform;
+
+	if (!SpawnPoints || !SpawnPoints->PickSpawnTransform(this, SpawnTransform))
+	{
+		return;
 	}
 
-	// find the player start
-	TArray<AActor*> ActorList;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), APlayerStart::StaticClass(), ActorList);
+	AShooterCharacter* RespawnedCharacter = PendingRespawnCharacter;
+	PendingRespawnCharacter = nullptr;
 
-	if (ActorList.Num() > 0)
+	// do we have a character ready?
+	if (IsValid(RespawnedCharacter))
 	{
-		// select a random player start
-		AActor* RandomPlayerStart = ActorList[FMath::RandRange(0, ActorList.Num() - 1)];
+		// move it to the spawn point and wake it up
+		RespawnedCharacter->TeleportTo(SpawnTransform.GetLocation(), SpawnTransform.Rotator(), false, true);
+		RespawnedCharacter->SetDormant(false);
+
+	} else {
 
 		// spawn a character at the player start
-		const FTransform SpawnTransform = RandomPlayerStart->GetActorTransform();
+		RespawnedCharacter = GetWorld()->SpawnActor<AShooterCharacter>(CharacterClass, SpawnTransform);
+	}
 
-		if (AShooterCharacter* RespawnedCharacter = GetWorld()->SpawnActor<AShooterCharacter>(CharacterClass, SpawnTransform))
-		{
-			// possess the character
-			Possess(RespawnedCharacter);
-		}
+	if (RespawnedCharacter)
+	{
+		// possess the character
+		Possess(RespawnedCharacter);
+	}
+}
+
+void AShooterPlayerController::OnPawnDied(float RespawnDelay)
+{
+	// spawn the next character on the next frame, spreading the cost away from the death frame
+	if (!IsValid(PendingRespawnCharacter))
+	{
+		PreSpawnTimer = GetWorld()->GetTimerManager().SetTimerForNextTick(this, &AShooterPlayerController::PreSpawnCharacter);
+	}
+}
+
+void AShooterPlayerController::PreSpawnCharacter()
+{
+	if (IsValid(PendingRespawnCharacter) || !CharacterClass)
+	{
+		return;
+	}
+
+	// spawn at the current safest point. It will be moved to the safest point at respawn time
+	UShooterSpawnPointSubsystem* SpawnPoints = GetWorld()->GetSubsystem<UShooterSpawnPointSubsystem>();
+
+	FTransform SpawnTransform;
+
+	if (!SpawnPoints || !SpawnPoints->PickSpawnTransform(this, SpawnTransform))
+	{
+		return;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	PendingRespawnCharacter = GetWorld()->SpawnActor<AShooterCharacter>(CharacterClass, SpawnTransform, SpawnParams);
+
+	if (PendingRespawnCharacter)
+	{
+		// keep it hidden and inactive until it's possessed, on clients too
+		PendingRespawnCharacter->SetDormant(true);
 	}
 }
 
@@ -134,7 +233,7 @@ void AShooterPlayerController::OnBulletCountUpdated(int32 MagazineSize, int32 Bu
 	// update the UI
 	if (BulletCounterUI)
 	{
-		BulletCounterUI->BP_UpdateBulletCounter(MagazineSize, Bullets);
+		BulletCounterUI->SetBulletCount(MagazineSize, Bullets);
 	}
 }
 
@@ -142,7 +241,7 @@ void AShooterPlayerController::OnPawnDamaged(float LifePercent)
 {
 	if (IsValid(BulletCounterUI))
 	{
-		BulletCounterUI->BP_Damaged(LifePercent);
+		BulletCounterUI->SetDamaged(LifePercent);
 	}
 }
 
@@ -9,16 +9,27 @@
 class UInputMappingContext;
 class AShooterCharacter;
 class UShooterBulletCounterUI;
+class USQDialogueRelayComponent;
 
 /**
  *  Simple PlayerController for a first person shooter game
  *  Manages input mappings
  *  Respawns the player pawn when it's destroyed
+ *  Relays NPC dialogue in multiplayer
  */
 UCLASS(abstract, config="Game")
 class SYNAPSEQUEST_API AShooterPlayerController : public APlayerController
 {
 	GENERATED_BODY()
+
+	/** Relays server-owned NPC dialogue to this player */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	USQDialogueRelayComponent* DialogueRelay;
+
+public:
+
+	/** Constructor */
+	AShooterPlayerController();
 	
 protected:
 
@@ -58,21 +69,41 @@ protected:
 	UPROPERTY()
 	TObjectPtr<UShooterBulletCounterUI> BulletCounterUI;
 
+	/** Character spawned ahead of time while the current one waits to respawn. Hidden and inactive until possessed */
+	UPROPERTY(Transient)
+	TObjectPtr<AShooterCharacter> PendingRespawnCharacter;
+
+	/** Timer to pre-spawn the next character after death */
+	FTimerHandle PreSpawnTimer;
+
 protected:
 
 	/** Gameplay Initialization */
 	virtual void BeginPlay() override;
 
+	/** Gameplay cleanup */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/** Initialize input bindings */
 	virtual void SetupInputComponent() override;
 
 	/** Pawn initialization */
 	virtual void OnPossess(APawn* InPawn) override;
 
+	/** Binds the HUD to the new pawn. Runs on clients as well as the server */
+	virtual void SetPawn(APawn* InPawn) override;
+
 	/** Called if the possessed pawn is destroyed */
 	UFUNCTION()
 	void OnPawnDestroyed(AActor* DestroyedActor);
 
+	/** Called when the possessed pawn dies, before it's destroyed */
+	UFUNCTION()
+	void OnPawnDied(float RespawnDelay);
+
+	/** Spawns the next character hidden and inactive, so the respawn only needs to move and possess it */
+	void PreSpawnCharacter();
+
 	/** Called when the bullet count on the possessed pawn is updated */
 	UFUNCTION()
 	void OnBulletCountUpdated(int32 MagazineSize, int32 Bullets);
@@ -0,0 +1,107 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/ShooterRandomSubsystem.h"
+#include "Engine/World.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "Misc/Crc.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarShooterRandomSeed(
+	TEXT("Shooter.Random.Seed"),
+	0,
+	TEXT("Seed for the deterministic shooter gameplay random streams. Read when a world starts.\n")
+	TEXT("0 picks a different seed every run. -ShooterSeed= on the command line takes precedence."),
+	ECVF_Default);
+
+/** SplitMix64 finalizer. Spreads every input bit across the whole output */
+static uint64 ShooterMixBits(uint64 Value)
+{
+	Value ^= Value >> 30;
+	Value *= 0xbf58476d1ce4e5b9ull;
+	Value ^= Value >> 27;
+	Value *= 0x94d049bb133111ebull;
+	Value ^= Value >> 31;
+	return Value;
+}
+
+bool UShooterRandomSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer))
+	{
+		return false;
+	}
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && (World->WorldType == EWorldType::Game || World->WorldType == EWorldType::PIE);
+}
+
+void UShooterRandomSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// the command line takes precedence over the cvar
+	uint64 NewSeed = static_cast<uint32>(CVarShooterRandomSeed.GetValueOnGameThread());
+	FParse::Value(FCommandLine::Get(), TEXT("ShooterSeed="), NewSeed);
+
+	// pick a random seed if none was requested
+	if (NewSeed == 0)
+	{
+		NewSeed = FPlatformTime::Cycles64();
+	}
+
+	SetSeed(NewSeed);
+}
+
+FRandomStream UShooterRandomSubsystem::Draw(const UObject* Owner)
+{
+	if (const UWorld* World = Owner ? Owner->GetWorld() : nullptr)
+	{
+		if (UShooterRandomSubsystem* RandomSubsystem = World->GetSubsystem<UShooterRandomSubsystem>())
+		{
+			return RandomSubsystem->NextDraw(Owner);
+		}
+	}
+
+	// no deterministic stream available
+	return FRandomStream(FMath::Rand());
+}
+
+FRandomStream UShooterRandomSubsystem::NextDraw(const UObject* Owner)
+{
+	check(IsInGameThread());
+
+	FSubstream* Substream = &GlobalSubstream;
+
+	if (Owner)
+	{
+		Substream = Substreams.Find(Owner);
+
+		if (!Substream)
+		{
+			// key the substream by path name, which is stable across runs as long as objects are created in the same order
+			Substream = &Substreams.Add(Owner);
+			Substream->Key = ShooterMixBits(FCrc::StrCrc32(*Owner->GetPathName()));
+		}
+	}
+
+	return FRandomStream(HashDraw(Substream->Key, Substream->Counter++));
+}
+
+void UShooterRandomSubsystem::SetSeed(uint64 NewSeed)
+{
+	Seed = NewSeed;
+
+	// restart every substream
+	Substreams.Reset();
+	GlobalSubstream = FSubstream();
+}
+
+int32 UShooterRandomSubsystem::HashDraw(uint64 Key, uint64 Counter) const
+{
+	// counter based: each draw only depends on the seed, the substream and its position in the substream
+	const uint64 Mixed = ShooterMixBits(Seed ^ ShooterMixBits(Key + ShooterMixBits(Counter)));
+
+	return static_cast<int32>(Mixed >> 32);
+}
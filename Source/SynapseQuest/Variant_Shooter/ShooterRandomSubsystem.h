@@ -0,0 +1,69 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Math/RandomStream.h"
+#include "UObject/ObjectKey.h"
+#include "ShooterRandomSubsystem.generated.h"
+
+/**
+ *  Deterministic random number service for shooter gameplay
+ *  Every object that needs randomness gets its own substream, keyed by a hash of its path name.
+ *  Each draw is derived from the world seed, the substream key and a per substream counter, so an object's
+ *  random sequence doesn't depend on how many numbers other objects drew before it.
+ *  The seed comes from -ShooterSeed= on the command line or the Shooter.Random.Seed cvar. Zero picks a random seed
+ */
+UCLASS()
+class SYNAPSEQUEST_API UShooterRandomSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** State for a single substream */
+	struct FSubstream
+	{
+		/** Hash identifying the substream */
+		uint64 Key = 0;
+
+		/** Number of draws taken from the substream */
+		uint64 Counter = 0;
+	};
+
+	/** Seed for this world */
+	uint64 Seed = 0;
+
+	/** Substreams, keyed by the object that owns them */
+	TMap<TObjectKey<UObject>, FSubstream> Substreams;
+
+	/** Substream used for draws without an owning object */
+	FSubstream GlobalSubstream;
+
+public:
+
+	/** Only provide deterministic draws in game worlds */
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	/** Reads the seed */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/**
+	 *  Returns a random stream for a single draw from the passed object's substream
+	 *  Falls back to a non deterministic stream if the object's world doesn't have a random subsystem
+	 */
+	static FRandomStream Draw(const UObject* Owner);
+
+	/** Returns a random stream for the next draw of the passed object's substream */
+	FRandomStream NextDraw(const UObject* Owner);
+
+	/** Restarts every substream from the passed seed */
+	void SetSeed(uint64 NewSeed);
+
+	/** Returns the seed for this world */
+	uint64 GetSeed() const { return Seed; }
+
+protected:
+
+	/** Mixes the seed, substream key and counter into a 32 bit stream seed */
+	int32 HashDraw(uint64 Key, uint64 Counter) const;
+};
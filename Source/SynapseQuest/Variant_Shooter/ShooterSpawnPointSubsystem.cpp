@@ -0,0 +1,175 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/ShooterSpawnPointSubsystem.h"
+#include "ShooterRandomSubsystem.h"
+#include "GameFramework/PlayerStart.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<float> CVarShooterSpawnSafeDistance(
+	TEXT("Shooter.Spawn.SafeDistance"),
+	4000.0f,
+	TEXT("Spawn points with no threat closer than this distance are considered equally safe."),
+	ECVF_Default);
+
+bool UShooterSpawnPointSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer))
+	{
+		return false;
+	}
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && (World->WorldType == EWorldType::Game || World->WorldType == EWorldType::PIE);
+}
+
+void UShooterSpawnPointSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// gather the spawn points placed in the level. This is the only actor walk we do
+	for (TActorIterator<APlayerStart> It(&InWorld); It; ++It)
+	{
+		SpawnPoints.Add(*It);
+	}
+
+	// keep the list up to date as actors come and go
+	ActorSpawnedHandle = InWorld.AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &UShooterSpawnPointSubsystem::OnActorSpawned));
+	ActorDestroyedHandle = InWorld.AddOnActorDestroyedHandler(FOnActorDestroyed::FDelegate::CreateUObject(this, &UShooterSpawnPointSubsystem::OnActorDestroyed));
+}
+
+void UShooterSpawnPointSubsystem::Deinitialize()
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+		World->RemoveOnActorDestroyedHandler(ActorDestroyedHandle);
+	}
+
+	SpawnPoints.Reset();
+	Threats.Reset();
+
+	Super::Deinitialize();
+}
+
+void UShooterSpawnPointSubsystem::OnActorSpawned(AActor* Actor)
+{
+	if (APlayerStart* PlayerStart = Cast<APlayerStart>(Actor))
+	{
+		SpawnPoints.AddUnique(PlayerStart);
+	}
+}
+
+void UShooterSpawnPointSubsystem::OnActorDestroyed(AActor* Actor)
+{
+	if (APlayerStart* PlayerStart = Cast<APlayerStart>(Actor))
+	{
+		SpawnPoints.RemoveSwap(PlayerStart);
+	}
+}
+
+void UShooterSpawnPointSubsystem::RegisterThreat(AActor* Threat)
+{
+	if (Threat)
+	{
+		Threats.AddUnique(Threat);
+	}
+}
+
+void UShooterSpawnPointSubsystem::UnregisterThreat(AActor* Threat)
+{
+	Threats.RemoveSwap(Threat);
+}
+
+bool UShooterSpawnPointSubsystem::PickSpawnTransform(const UObject* Context, FTransform& OutTransform)
+{
+	// drop any spawn points that went away without a destroy event, e.g. streamed out levels
+	SpawnPoints.RemoveAllSwap([](const TWeakObjectPtr<APlayerStart>& SpawnPoint) { return !SpawnPoint.IsValid(); });
+
+	if (SpawnPoints.Num() == 0)
+	{
+		return false;
+	}
+
+	// cells are half the safe distance, so we only need to look at the 5x5 block around each spawn point
+	const float SafeDistance = FMath::Max(CVarShooterSpawnSafeDistance.GetValueOnGameThread(), 1.0f);
+	const float CellSize = SafeDistance * 0.5f;
+
+	BuildThreatCells(CellSize);
+
+	// score every spawn point by its distance to the closest threat
+	Scores.SetNumUninitialized(SpawnPoints.Num());
+
+	float BestScore = -1.0f;
+
+	for (int32 i = 0; i < SpawnPoints.Num(); ++i)
+	{
+		Scores[i] = GetThreatDistance(SpawnPoints[i]->GetActorLocation(), SafeDistance, CellSize);
+		BestScore = FMath::Max(BestScore, Scores[i]);
+	}
+
+	// gather every spawn point tied for the best score
+	TArray<int32, TInlineAllocator<16>> BestIndices;
+
+	for (int32 i = 0; i < SpawnPoints.Num(); ++i)
+	{
+		if (Scores[i] >= BestScore)
+		{
+			BestIndices.Add(i);
+		}
+	}
+
+	// break ties at random
+	const int32 Picked = BestIndices[UShooterRandomSubsystem::Draw(Context).RandRange(0, BestIndices.Num() - 1)];
+
+	OutTransform = SpawnPoints[Picked]->GetActorTransform();
+	return true;
+}
+
+void UShooterSpawnPointSubsystem::BuildThreatCells(float CellSize)
+{
+	ThreatCells.Reset();
+
+	for (int32 i = Threats.Num() - 1; i >= 0; --i)
+	{
+		const AActor* Threat = Threats[i].Get();
+
+		// forget destroyed threats
+		if (!Threat)
+		{
+			Threats.RemoveAtSwap(i, EAllowShrinking::No);
+			continue;
+		}
+
+		const FVector Location = Threat->GetActorLocation();
+		const FIntPoint Cell(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+
+		ThreatCells.FindOrAdd(Cell).Add(Location);
+	}
+}
+
+float UShooterSpawnPointSubsystem::GetThreatDistance(const FVector& Location, float SafeDistance, float CellSize) const
+{
+	const FIntPoint Center(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+	const int32 CellRadius = FMath::CeilToInt(SafeDistance / CellSize);
+
+	float ClosestSquared = FMath::Square(SafeDistance);
+
+	for (int32 Y = -CellRadius; Y <= CellRadius; ++Y)
+	{
+		for (int32 X = -CellRadius; X <= CellRadius; ++X)
+		{
+			if (const TArray<FVector, TInlineAllocator<4>>* Cell = ThreatCells.Find(Center + FIntPoint(X, Y)))
+			{
+				for (const FVector& ThreatLocation : *Cell)
+				{
+					ClosestSquared = FMath::Min(ClosestSquared, static_cast<float>(FVector::DistSquared(Location, ThreatLocation)));
+				}
+			}
+		}
+	}
+
+	return FMath::Sqrt(ClosestSquared);
+}
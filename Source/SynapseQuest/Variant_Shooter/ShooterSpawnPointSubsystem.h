@@ -0,0 +1,79 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterSpawnPointSubsystem.generated.h"
+
+class APlayerStart;
+
+/**
+ *  Keeps track of the player spawn points and the threats in the world, and picks the safest spawn point on request
+ *  Spawn points are gathered once when play begins and kept up to date through the world's actor spawn and destroy events.
+ *  Threats register themselves while they're alive. Picking bins the threats into a coarse grid and scores each
+ *  spawn point by the distance to the closest threat in the neighboring cells
+ */
+UCLASS()
+class SYNAPSEQUEST_API UShooterSpawnPointSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Registered spawn points */
+	TArray<TWeakObjectPtr<APlayerStart>> SpawnPoints;
+
+	/** Registered threats */
+	TArray<TWeakObjectPtr<AActor>> Threats;
+
+	/** Threat locations binned by grid cell. Rebuilt on every pick */
+	TMap<FIntPoint, TArray<FVector, TInlineAllocator<4>>> ThreatCells;
+
+	/** Spawn point scores. Reused on every pick */
+	TArray<float> Scores;
+
+	/** Handles for the world actor delegates */
+	FDelegateHandle ActorSpawnedHandle;
+	FDelegateHandle ActorDestroyedHandle;
+
+public:
+
+	/** Only track spawn points in game worlds */
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	/** Gathers the spawn points already in the world and starts listening for new ones */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Stops listening for actor events */
+	virtual void Deinitialize() override;
+
+	/** Starts considering the passed actor a threat when picking spawn points */
+	void RegisterThreat(AActor* Threat);
+
+	/** Stops considering the passed actor a threat */
+	void UnregisterThreat(AActor* Threat);
+
+	/**
+	 *  Picks the spawn point farthest from every threat. Ties are broken at random
+	 *  @param Context Object whose random stream is used to break ties
+	 *  @param OutTransform Transform of the picked spawn point
+	 *  @return false if there are no spawn points
+	 */
+	bool PickSpawnTransform(const UObject* Context, FTransform& OutTransform);
+
+	/** Returns the number of registered spawn points */
+	int32 GetNumSpawnPoints() const { return SpawnPoints.Num(); }
+
+protected:
+
+	/** Called when any actor is spawned in the world */
+	void OnActorSpawned(AActor* Actor);
+
+	/** Called when any actor is destroyed in the world */
+	void OnActorDestroyed(AActor* Actor);
+
+	/** Bins the current threat locations into the grid */
+	void BuildThreatCells(float CellSize);
+
+	/** Returns the distance to the closest threat, capped to the passed safe distance */
+	float GetThreatDistance(const FVector& Location, float SafeDistance, float CellSize) const;
+};
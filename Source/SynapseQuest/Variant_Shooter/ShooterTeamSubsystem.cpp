@@ -0,0 +1,161 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "Variant_Shooter/ShooterTeamSubsystem.h"
+#include "Engine/World.h"
+
+bool UShooterTeamSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer))
+	{
+		return false;
+	}
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && (World->WorldType == EWorldType::Game || World->WorldType == EWorldType::PIE);
+}
+
+UShooterTeamSubsystem* UShooterTeamSubsystem::Get(const UObject* WorldContext)
+{
+	const UWorld* World = WorldContext ? WorldContext->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UShooterTeamSubsystem>() : nullptr;
+}
+
+void UShooterTeamSubsystem::RegisterMember(AActor* Member, uint8 Team, bool bAlive)
+{
+	if (!Member)
+	{
+		return;
+	}
+
+	if (MemberIndices.Contains(Member))
+	{
+		SetTeam(Member, Team);
+		SetAlive(Member, bAlive);
+		return;
+	}
+
+	MemberIndices.Add(Member, Members.Num());
+	Members.Add(Member);
+	MemberTeams.Add(Team);
+	MemberAlive.Add(bAlive);
+
+	if (!TeamMembers.IsValidIndex(Team))
+	{
+		TeamMembers.SetNum(Team + 1);
+	}
+
+	TeamMembers[Team].Add(Member);
+}
+
+void UShooterTeamSubsystem::UnregisterMember(AActor* Member)
+{
+	int32 Index = INDEX_NONE;
+
+	if (!MemberIndices.RemoveAndCopyValue(Member, Index))
+	{
+		return;
+	}
+
+	TeamMembers[MemberTeams[Index]].RemoveSwap(Member);
+
+	// fill the gap with the last member
+	const int32 LastIndex = Members.Num() - 1;
+
+	if (Index != LastIndex)
+	{
+		Members[Index] = Members[LastIndex];
+		MemberTeams[Index] = MemberTeams[LastIndex];
+		MemberAlive[Index] = MemberAlive[LastIndex];
+
+		MemberIndices.Add(Members[Index], Index);
+	}
+
+	Members.RemoveAt(LastIndex, EAllowShrinking::No);
+	MemberTeams.RemoveAt(LastIndex, EAllowShrinking::No);
+	MemberAlive.RemoveAt(LastIndex, EAllowShrinking::No);
+}
+
+void UShooterTeamSubsystem::SetTeam(AActor* Member, uint8 Team)
+{
+	const int32* Index = MemberIndices.Find(Member);
+
+	if (!Index || MemberTeams[*Index] == Team)
+	{
+		return;
+	}
+
+	TeamMembers[MemberTeams[*Index]].RemoveSwap(Member);
+
+	if (!TeamMembers.IsValidIndex(Team))
+	{
+		TeamMembers.SetNum(Team + 1);
+	}
+
+	TeamMembers[Team].Add(Member);
+	MemberTeams[*Index] = Team;
+}
+
+void UShooterTeamSubsystem::SetAlive(AActor* Member, bool bAlive)
+{
+	if (const int32* Index = MemberIndices.Find(Member))
+	{
+		MemberAlive[*Index] = bAlive;
+	}
+}
+
+FGenericTeamId UShooterTeamSubsystem::GetTeam(const AActor* Actor) const
+{
+	if (const int32* Index = MemberIndices.Find(Actor))
+	{
+		return FGenericTeamId(MemberTeams[*Index]);
+	}
+
+	return FGenericTeamId::GetTeamIdentifier(Actor);
+}
+
+bool UShooterTeamSubsystem::IsAlive(const AActor* Actor) const
+{
+	const int32* Index = MemberIndices.Find(Actor);
+	return Index && MemberAlive[*Index];
+}
+
+ETeamAttitude::Type UShooterTeamSubsystem::GetAttitude(const AActor* From, const AActor* Towards) const
+{
+	if (!From || !Towards)
+	{
+		return ETeamAttitude::Neutral;
+	}
+
+	const int32* FromIndex = MemberIndices.Find(From);
+	const int32* TowardsIndex = MemberIndices.Find(Towards);
+
+	// unregistered actors are never part of the fight
+	if (!FromIndex || !TowardsIndex || !MemberAlive[*TowardsIndex])
+	{
+		return ETeamAttitude::Neutral;
+	}
+
+	return MemberTeams[*FromIndex] == MemberTeams[*TowardsIndex] ? ETeamAttitude::Friendly : ETeamAttitude::Hostile;
+}
+
+const TArray<TWeakObjectPtr<AActor>>& UShooterTeamSubsystem::GetTeamMembers(uint8 Team) const
+{
+	static const TArray<TWeakObjectPtr<AActor>> NoMembers;
+	return TeamMembers.IsValidIndex(Team) ? TeamMembers[Team] : NoMembers;
+}
+
+int32 UShooterTeamSubsystem::GetNumAliveMembers(uint8 Team) const
+{
+	int32 NumAlive = 0;
+
+	for (const TWeakObjectPtr<AActor>& Member : GetTeamMembers(Team))
+	{
+		if (const int32* Index = MemberIndices.Find(Member))
+		{
+			NumAlive += MemberAlive[*Index] ? 1 : 0;
+		}
+	}
+
+	return NumAlive;
+}
@@ -0,0 +1,73 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GenericTeamAgentInterface.h"
+#include "ShooterTeamSubsystem.generated.h"
+
+/**
+ *  Single source of truth for the team and alive state of every shooter character
+ *  Members are kept in parallel arrays indexed through a lookup map, with a member list per team.
+ *  Backs the IGenericTeamAgentInterface implementations of the characters and AI controllers,
+ *  so AI Perception affiliation filtering and StateTree friend or foe checks don't need actor tags
+ */
+UCLASS()
+class SYNAPSEQUEST_API UShooterTeamSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Registered members */
+	TArray<TWeakObjectPtr<AActor>> Members;
+
+	/** Team of each member */
+	TArray<uint8> MemberTeams;
+
+	/** Alive state of each member */
+	TArray<bool> MemberAlive;
+
+	/** Index of each registered member in the arrays above */
+	TMap<TWeakObjectPtr<const AActor>, int32> MemberIndices;
+
+	/** Members of each team, indexed by team ID */
+	TArray<TArray<TWeakObjectPtr<AActor>>> TeamMembers;
+
+public:
+
+	/** Only track teams in game worlds */
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	/** Adds a member to the passed team, or updates it if already registered */
+	void RegisterMember(AActor* Member, uint8 Team, bool bAlive = true);
+
+	/** Removes a member */
+	void UnregisterMember(AActor* Member);
+
+	/** Moves a registered member to another team */
+	void SetTeam(AActor* Member, uint8 Team);
+
+	/** Updates the alive state of a registered member */
+	void SetAlive(AActor* Member, bool bAlive);
+
+	/** Returns the team of the passed actor. Falls back to its team agent interface if it isn't registered */
+	FGenericTeamId GetTeam(const AActor* Actor) const;
+
+	/** Returns true if the passed actor is registered and alive */
+	bool IsAlive(const AActor* Actor) const;
+
+	/** Returns how the first actor feels about the second. Dead actors are neutral to everyone */
+	ETeamAttitude::Type GetAttitude(const AActor* From, const AActor* Towards) const;
+
+	/** Returns true if the first actor should fight the second */
+	bool IsHostile(const AActor* From, const AActor* Towards) const { return GetAttitude(From, Towards) == ETeamAttitude::Hostile; }
+
+	/** Returns the members of the passed team */
+	const TArray<TWeakObjectPtr<AActor>>& GetTeamMembers(uint8 Team) const;
+
+	/** Returns the number of live members in the passed team */
+	int32 GetNumAliveMembers(uint8 Team) const;
+
+	/** Returns the team subsystem for the passed world context, if any */
+	static UShooterTeamSubsystem* Get(const UObject* WorldContext);
+};
@@ -3,3 +3,35 @@
 
 #include "ShooterBulletCounterUI.h"
 
+void UShooterBulletCounterUI::SetBulletCount(int32 MagazineSize, int32 BulletCount)
+{
+	PendingMagazineSize = MagazineSize;
+	PendingBulletCount = BulletCount;
+	bBulletCountDirty = true;
+
+	MarkHUDDirty();
+}
+
+void UShooterBulletCounterUI::SetDamaged(float LifePercent)
+{
+	// several hits in the same frame play a single damage effect
+	PendingLifePercent = LifePercent;
+	bDamagedDirty = true;
+
+	MarkHUDDirty();
+}
+
+void UShooterBulletCounterUI::NativeFlushHUD()
+{
+	if (bBulletCountDirty)
+	{
+		bBulletCountDirty = false;
+		BP_UpdateBulletCounter(PendingMagazineSize, PendingBulletCount);
+	}
+
+	if (bDamagedDirty)
+	{
+		bDamagedDirty = false;
+		BP_Damaged(PendingLifePercent);
+	}
+}
@@ -3,19 +3,41 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "Blueprint/UserWidget.h"
+#include "SQHUDWidget.h"
 #include "ShooterBulletCounterUI.generated.h"
 
 /**
  *  Simple bullet counter UI widget for a first person shooter game
+ *  Bullet count and damage changes are coalesced into one Blueprint update per HUD flush
  */
 UCLASS(abstract)
-class SYNAPSEQUEST_API UShooterBulletCounterUI : public UUserWidget
+class SYNAPSEQUEST_API UShooterBulletCounterUI : public USQHUDWidget
 {
 	GENERATED_BODY()
+
+	/** Pending magazine size */
+	int32 PendingMagazineSize = 0;
+
+	/** Pending bullet count */
+	int32 PendingBulletCount = 0;
+
+	/** Pending life percentage */
+	float PendingLifePercent = 1.0f;
+
+	/** If true, the bullet count changed since the last flush */
+	bool bBulletCountDirty = false;
+
+	/** If true, we were damaged since the last flush */
+	bool bDamagedDirty = false;
 	
 public:
 
+	/** Queues a bullet counter update */
+	void SetBulletCount(int32 MagazineSize, int32 BulletCount);
+
+	/** Queues a life total update and damage effect */
+	void SetDamaged(float LifePercent);
+
 	/** Allows Blueprint to update sub-widgets with the new bullet count */
 	UFUNCTION(BlueprintImplementableEvent, Category="Shooter", meta=(DisplayName = "UpdateBulletCounter"))
 	void BP_UpdateBulletCounter(int32 MagazineSize, int32 BulletCount);
@@ -23,4 +45,9 @@ public:
 	/** Allows Blueprint to update sub-widgets with the new life total and play a damage effect on the HUD */
 	UFUNCTION(BlueprintImplementableEvent, Category="Shooter", meta=(DisplayName = "Damaged"))
 	void BP_Damaged(float LifePercent);
+
+protected:
+
+	/** Pushes the latest bullet count and life total to Blueprint */
+	virtual void NativeFlushHUD() override;
 };
@@ -3,3 +3,19 @@
 
 #include "ShooterUI.h"
 
+void UShooterUI::SetTeamScore(uint8 TeamByte, int32 Score)
+{
+	PendingScores.Add(TeamByte, Score);
+
+	MarkHUDDirty();
+}
+
+void UShooterUI::NativeFlushHUD()
+{
+	for (const TPair<uint8, int32>& TeamScore : PendingScores)
+	{
+		BP_UpdateScore(TeamScore.Key, TeamScore.Value);
+	}
+
+	PendingScores.Reset();
+}
@@ -3,20 +3,32 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "Blueprint/UserWidget.h"
+#include "SQHUDWidget.h"
 #include "ShooterUI.generated.h"
 
 /**
  *  Simple scoreboard UI for a first person shooter game
+ *  Score changes are coalesced into one Blueprint update per team per HUD flush
  */
 UCLASS(abstract)
-class SYNAPSEQUEST_API UShooterUI : public UUserWidget
+class SYNAPSEQUEST_API UShooterUI : public USQHUDWidget
 {
 	GENERATED_BODY()
+
+	/** Latest scores not yet pushed to Blueprint, by team ID */
+	TMap<uint8, int32> PendingScores;
 	
 public:
 
+	/** Queues a score update for the given team */
+	void SetTeamScore(uint8 TeamByte, int32 Score);
+
 	/** Allows Blueprint to update score sub-widgets */
 	UFUNCTION(BlueprintImplementableEvent, Category="Shooter", meta = (DisplayName = "Update Score"))
 	void BP_UpdateScore(uint8 TeamByte, int32 Score);
+
+protected:
+
+	/** Pushes the latest score of each changed team to Blueprint */
+	virtual void NativeFlushHUD() override;
 };
@@ -0,0 +1,264 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterExplosionSubsystem.h"
+#include "ShooterBenchmarkStats.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/DamageType.h"
+#include "Components/PrimitiveComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "Engine/OverlapResult.h"
+#include "Engine/World.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<float> CVarShooterExplosionMaxMergedRadius(
+	TEXT("Shooter.Explosions.MaxMergedRadius"),
+	2000.0f,
+	TEXT("Max radius of the overlap query used to resolve several explosions at once.\n")
+	TEXT("Explosions are only merged while their enclosing sphere stays under this radius. Set to 0 to disable merging."),
+	ECVF_Default);
+
+bool UShooterExplosionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UShooterExplosionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterExplosionSubsystem, STATGROUP_Tickables);
+}
+
+void UShooterExplosionSubsystem::QueueExplosion(const FShooterExplosion& Explosion)
+{
+	PendingExplosions.Add(Explosion);
+}
+
+void UShooterExplosionSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (PendingExplosions.Num() == 0)
+	{
+		return;
+	}
+
+	// swap the queue out, so explosions triggered while applying damage are resolved next frame
+	Swap(ResolvingExplosions, PendingExplosions);
+	PendingExplosions.Reset();
+
+	// greedily group explosions whose enclosing sphere stays small enough for a single overlap
+	const float MaxMergedRadius = CVarShooterExplosionMaxMergedRadius.GetValueOnGameThread();
+
+	TArray<TArray<int32>> Clusters;
+	TArray<FSphere> ClusterSpheres;
+
+	for (int32 i = 0; i < ResolvingExplosions.Num(); ++i)
+	{
+		const FSphere ExplosionSphere(ResolvingExplosions[i].Center, ResolvingExplosions[i].Radius);
+
+		bool bMerged = false;
+
+		for (int32 ClusterIndex = 0; ClusterIndex < Clusters.Num(); ++ClusterIndex)
+		{
+			FSphere Merged = ClusterSpheres[ClusterIndex];
+			Merged += ExplosionSphere;
+
+			if (Merged.W <= MaxMergedRadius)
+			{
+				ClusterSpheres[ClusterIndex] = Merged;
+				Clusters[ClusterIndex].Add(i);
+				bMerged = true;
+				break;
+			}
+		}
+
+		if (!bMerged)
+		{
+			Clusters.Emplace_GetRef().Add(i);
+			ClusterSpheres.Add(ExplosionSphere);
+		}
+	}
+
+	// resolve each cluster
+	for (const TArray<int32>& Cluster : Clusters)
+	{
+		GatherClusterContacts(Cluster);
+		CheckOcclusion();
+		ApplyContacts();
+	}
+
+	ApplyImpulses();
+
+	ResolvingExplosions.Reset();
+}
+
+void UShooterExplosionSubsystem::GatherClusterContacts(const TArray<int32>& Cluster)
+{
+	Targets.Reset();
+	TargetIndices.Reset();
+	Contacts.Reset();
+
+	// build the query sphere enclosing every explosion in the cluster
+	FSphere QuerySphere(ResolvingExplosions[Cluster[0]].Center, ResolvingExplosions[Cluster[0]].Radius);
+
+	for (int32 i = 1; i < Cluster.Num(); ++i)
+	{
+		QuerySphere += FSphere(ResolvingExplosions[Cluster[i]].Center, ResolvingExplosions[Cluster[i]].Radius);
+	}
+
+	// do a single sphere overlap for the whole cluster
+	TArray<FOverlapResult> Overlaps;
+
+	FCollisionObjectQueryParams ObjectParams;
+	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+	ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+	ObjectParams.AddObjectTypesToQuery(ECC_PhysicsBody);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ShooterExplosion), false);
+
+	GetWorld()->OverlapMultiByObjectType(Overlaps, QuerySphere.Center, FQuat::Identity, ObjectParams, FCollisionShape::MakeSphere(QuerySphere.W), QueryParams);
+	FShooterBenchmarkStats::AddSceneQueries();
+
+	// overlaps may return the same actor multiple times per each component overlapped
+	// keep only the first component for each actor
+	for (const FOverlapResult& CurrentOverlap : Overlaps)
+	{
+		AActor* OverlapActor = CurrentOverlap.GetActor();
+
+		if (!OverlapActor || TargetIndices.Contains(OverlapActor))
+		{
+			continue;
+		}
+
+		TargetIndices.Add(OverlapActor, Targets.Num());
+
+		FExplosionTarget& Target = Targets.AddDefaulted_GetRef();
+		Target.Actor = OverlapActor;
+		Target.Component = CurrentOverlap.GetComponent();
+		Target.Bounds = Target.Component ? Target.Component->Bounds : FBoxSphereBounds(OverlapActor->GetActorLocation(), FVector::ZeroVector, 0.0f);
+	}
+
+	// pair each explosion with the targets inside its own radius
+	const bool bMergedCluster = Cluster.Num() > 1;
+
+	for (int32 ExplosionIndex : Cluster)
+	{
+		const FShooterExplosion& Explosion = ResolvingExplosions[ExplosionIndex];
+
+		const AActor* DamageCauser = Explosion.DamageCauser.Get();
+		const APawn* ExplosionInstigator = Explosion.Instigator.Get();
+
+		for (int32 TargetIndex = 0; TargetIndex < Targets.Num(); ++TargetIndex)
+		{
+			const FExplosionTarget& Target = Targets[TargetIndex];
+
+			// skip the explosion source and, unless allowed, whoever caused it
+			if (Target.Actor == DamageCauser || (!Explosion.bDamageOwner && Target.Actor == ExplosionInstigator))
+			{
+				continue;
+			}
+
+			// merged queries are larger than each explosion, so check the target bounds against this explosion's radius
+			if (bMergedCluster && FVector::DistSquared(Explosion.Center, Target.Bounds.Origin) > FMath::Square(Explosion.Radius + Target.Bounds.SphereRadius))
+			{
+				continue;
+			}
+
+			// apply linear damage falloff past the full damage radius
+			const float Distance = FVector::Dist(Explosion.Center, Target.Actor->GetActorLocation());
+			const float FalloffAlpha = FMath::GetRangePct(Explosion.FullDamageRadius, Explosion.Radius, Distance);
+
+			FExplosionContact& Contact = Contacts.AddDefaulted_GetRef();
+			Contact.ExplosionIndex = ExplosionIndex;
+			Contact.TargetIndex = TargetIndex;
+			Contact.Scale = Explosion.Radius > Explosion.FullDamageRadius ? FMath::Lerp(1.0f, Explosion.MinDamageScale, FMath::Clamp(FalloffAlpha, 0.0f, 1.0f)) : 1.0f;
+		}
+	}
+}
+
+void UShooterExplosionSubsystem::CheckOcclusion()
+{
+	UWorld* World = GetWorld();
+
+	// scene queries are read only, so every contact can be traced independently
+	ParallelFor(Contacts.Num(), [this, World](int32 Index)
+	{
+		FExplosionContact& Contact = Contacts[Index];
+		const FShooterExplosion& Explosion = ResolvingExplosions[Contact.ExplosionIndex];
+
+		if (!Explosion.bCheckOcclusion)
+		{
+			return;
+		}
+
+		const FExplosionTarget& Target = Targets[Contact.TargetIndex];
+
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ShooterExplosionOcclusion), false, Target.Actor);
+		QueryParams.AddIgnoredActor(Explosion.DamageCauser.Get());
+
+		Contact.bOccluded = World->LineTraceTestByChannel(Explosion.Center, Target.Actor->GetActorLocation(), ECC_Visibility, QueryParams);
+		FShooterBenchmarkStats::AddSceneQueries();
+	});
+}
+
+void UShooterExplosionSubsystem::ApplyContacts()
+{
+	for (const FExplosionContact& Contact : Contacts)
+	{
+		if (Contact.bOccluded)
+		{
+			continue;
+		}
+
+		const FShooterExplosion& Explosion = ResolvingExplosions[Contact.ExplosionIndex];
+		const FExplosionTarget& Target = Targets[Contact.TargetIndex];
+
+		// damage may have destroyed the target while resolving a previous contact
+		if (!IsValid(Target.Actor))
+		{
+			continue;
+		}
+
+		// have we hit a character?
+		if (ACharacter* HitCharacter = Cast<ACharacter>(Target.Actor))
+		{
+			// ignore the owner of this explosion
+			if (HitCharacter != Explosion.Owner.Get() || Explosion.bDamageOwner)
+			{
+				// the instigator may have been destroyed since the explosion was queued
+				APawn* ExplosionInstigator = Explosion.Instigator.Get();
+				AController* InstigatorController = ExplosionInstigator ? ExplosionInstigator->GetController() : nullptr;
+
+				UGameplayStatics::ApplyDamage(HitCharacter, Explosion.Damage * Contact.Scale, InstigatorController, Explosion.DamageCauser.Get(), Explosion.DamageType);
+			}
+		}
+
+		// accumulate the physics impulse so each component is only pushed once
+		if (IsValid(Target.Component) && Target.Component->IsSimulatingPhysics())
+		{
+			const FVector ExplosionDir = (Target.Actor->GetActorLocation() - Explosion.Center).GetSafeNormal();
+
+			FPendingImpulse& PendingImpulse = PendingImpulses.FindOrAdd(Target.Component);
+			PendingImpulse.Impulse += ExplosionDir * Explosion.PhysicsForce * Contact.Scale;
+			PendingImpulse.LocationSum += Explosion.Center;
+			++PendingImpulse.Count;
+		}
+	}
+}
+
+void UShooterExplosionSubsystem::ApplyImpulses()
+{
+	for (const TPair<TWeakObjectPtr<UPrimitiveComponent>, FPendingImpulse>& Pair : PendingImpulses)
+	{
+		UPrimitiveComponent* Component = Pair.Key.Get();
+
+		if (IsValid(Component) && Component->IsSimulatingPhysics())
+		{
+			Component->AddImpulseAtLocation(Pair.Value.Impulse, Pair.Value.LocationSum / Pair.Value.Count);
+		}
+	}
+
+	PendingImpulses.Reset();
+}
@@ -0,0 +1,151 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterExplosionSubsystem.generated.h"
+
+class UDamageType;
+class UPrimitiveComponent;
+
+/**
+ *  Describes an explosion to be resolved by the explosion subsystem
+ */
+struct FShooterExplosion
+{
+	/** Center of the explosion */
+	FVector Center = FVector::ZeroVector;
+
+	/** Max distance for actors to be affected by the explosion */
+	float Radius = 500.0f;
+
+	/** Actors within this distance take full damage. Damage falls off linearly from here to the outer radius */
+	float FullDamageRadius = 500.0f;
+
+	/** Damage multiplier at the outer radius */
+	float MinDamageScale = 1.0f;
+
+	/** Damage applied to characters at full strength */
+	float Damage = 0.0f;
+
+	/** Physics impulse applied to simulating components at full strength */
+	float PhysicsForce = 0.0f;
+
+	/** Type of damage to apply */
+	TSubclassOf<UDamageType> DamageType;
+
+	/** If true, the owner of the explosion can be damaged by it */
+	bool bDamageOwner = false;
+
+	/** If true, actors hidden behind geometry from the explosion center are not affected */
+	bool bCheckOcclusion = false;
+
+	/** Actor that owns the explosion, usually the shooting character */
+	TWeakObjectPtr<AActor> Owner;
+
+	/** Pawn responsible for the damage */
+	TWeakObjectPtr<APawn> Instigator;
+
+	/** Actor reported as the damage causer */
+	TWeakObjectPtr<AActor> DamageCauser;
+};
+
+/**
+ *  Resolves explosion damage for the whole world once per frame
+ *  Explosions close to each other are merged into a single overlap query,
+ *  overlapped actors are deduplicated through a hash map instead of linear searches,
+ *  occlusion traces run in parallel, and physics impulses are accumulated so each component is only pushed once
+ */
+UCLASS()
+class SYNAPSEQUEST_API UShooterExplosionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** An actor overlapped by a cluster of explosions */
+	struct FExplosionTarget
+	{
+		/** Overlapped actor */
+		AActor* Actor = nullptr;
+
+		/** First overlapped component of the actor */
+		UPrimitiveComponent* Component = nullptr;
+
+		/** Bounds of the overlapped component, used to test against each explosion of a merged cluster */
+		FBoxSphereBounds Bounds;
+	};
+
+	/** An explosion affecting a target, pending occlusion and damage */
+	struct FExplosionContact
+	{
+		/** Index of the explosion in the pending list */
+		int32 ExplosionIndex = INDEX_NONE;
+
+		/** Index of the target in the cluster target list */
+		int32 TargetIndex = INDEX_NONE;
+
+		/** Damage and impulse multiplier after falloff */
+		float Scale = 1.0f;
+
+		/** True if the target is hidden behind geometry */
+		bool bOccluded = false;
+	};
+
+	/** Accumulated impulse for a single component */
+	struct FPendingImpulse
+	{
+		/** Sum of every impulse applied this frame */
+		FVector Impulse = FVector::ZeroVector;
+
+		/** Sum of the impulse locations, averaged when applied */
+		FVector LocationSum = FVector::ZeroVector;
+
+		/** Number of impulses accumulated */
+		int32 Count = 0;
+	};
+
+	/** Explosions queued this frame */
+	TArray<FShooterExplosion> PendingExplosions;
+
+	/** Explosions being resolved this tick */
+	TArray<FShooterExplosion> ResolvingExplosions;
+
+	/** Scratch buffers reused every frame */
+	TArray<FExplosionTarget> Targets;
+	TMap<AActor*, int32> TargetIndices;
+	TArray<FExplosionContact> Contacts;
+	TMap<TWeakObjectPtr<UPrimitiveComponent>, FPendingImpulse> PendingImpulses;
+
+public:
+
+	/** Only resolve explosions in game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Resolves every queued explosion */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/** Queues an explosion to be resolved at the end of the frame */
+	void QueueExplosion(const FShooterExplosion& Explosion);
+
+	/** Returns the number of explosions waiting to be resolved */
+	int32 GetNumPendingExplosions() const { return PendingExplosions.Num(); }
+
+protected:
+
+	/** Runs the overlap query for a cluster of resolving explosions and gathers the contacts */
+	void GatherClusterContacts(const TArray<int32>& Cluster);
+
+	/** Runs the occlusion traces for every contact that needs them */
+	void CheckOcclusion();
+
+	/** Applies damage and accumulates the impulses for every contact */
+	void ApplyContacts();
+
+	/** Applies the accumulated impulses */
+	void ApplyImpulses();
+};
@@ -0,0 +1,159 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterHitscanSubsystem.h"
+#include "ShooterProjectile.h"
+#include "ShooterBenchmarkStats.h"
+#include "GameFramework/Pawn.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarShooterHitscanParallelThreshold(
+	TEXT("Shooter.Hitscan.ParallelTraceThreshold"),
+	16,
+	TEXT("Minimum number of hitscan pellets in a frame before their traces are distributed across worker threads.\n")
+	TEXT("Set to 0 to always trace on the game thread."),
+	ECVF_Default);
+
+/** Actor tag that lets hitscan pellets go through an actor that isn't a pawn or physics body */
+static const FName ShooterPenetrableTag = FName("Penetrable");
+
+/** Returns true if a pellet can keep going past the passed hit. Level geometry and anything else not on the allow list stops it */
+static bool IsPenetrableHit(const FHitResult& Hit)
+{
+	const UPrimitiveComponent* HitComponent = Hit.GetComponent();
+	const AActor* HitActor = Hit.GetActor();
+
+	if (!HitComponent || !HitActor)
+	{
+		return false;
+	}
+
+	const ECollisionChannel ObjectType = HitComponent->GetCollisionObjectType();
+
+	return ObjectType == ECC_Pawn || ObjectType == ECC_PhysicsBody || HitActor->ActorHasTag(ShooterPenetrableTag);
+}
+
+bool UShooterHitscanSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UShooterHitscanSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterHitscanSubsystem, STATGROUP_Tickables);
+}
+
+void UShooterHitscanSubsystem::QueuePellet(FShooterHitscanPellet&& Pellet)
+{
+	PendingPellets.Add(MoveTemp(Pellet));
+}
+
+void UShooterHitscanSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (PendingPellets.Num() > 0)
+	{
+		TracePellets();
+		ApplyPelletHits();
+
+		PendingPellets.Reset();
+	}
+}
+
+void UShooterHitscanSubsystem::TracePellets()
+{
+	const int32 Num = PendingPellets.Num();
+	UWorld* World = GetWorld();
+
+	PelletHits.SetNum(Num, EAllowShrinking::No);
+
+	// small batches aren't worth the overhead of going wide
+	const int32 Threshold = CVarShooterHitscanParallelThreshold.GetValueOnGameThread();
+	const EParallelForFlags Flags = (Threshold <= 0 || Num < Threshold) ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None;
+
+	// scene queries are read only, so every pellet can be traced independently
+	ParallelFor(Num, [this, World](int32 Index)
+	{
+		const FShooterHitscanPellet& Pellet = PendingPellets[Index];
+		TArray<FHitResult, TInlineAllocator<4>>& Hits = PelletHits[Index];
+
+		Hits.Reset();
+
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ShooterHitscan), false, Pellet.Instigator.Get());
+
+		FVector Start = Pellet.Start;
+		const FVector End = Pellet.Start + Pellet.Direction * Pellet.Range;
+
+		// keep tracing through actors until we run out of penetrations or hit nothing
+		for (int32 Penetration = 0; Penetration <= Pellet.MaxPenetrations; ++Penetration)
+		{
+			FHitResult OutHit;
+
+			FShooterBenchmarkStats::AddSceneQueries();
+
+			if (!World->LineTraceSingleByChannel(OutHit, Start, End, Pellet.Channel, QueryParams))
+			{
+				break;
+			}
+
+			Hits.Add(OutHit);
+
+			// we can only go through pawns and other penetrable actors. Walls, floors and other world geometry stop the pellet
+			if (!IsPenetrableHit(OutHit))
+			{
+				break;
+			}
+
+			// continue the trace past the actor we just hit
+			QueryParams.AddIgnoredActor(OutHit.GetActor());
+			Start = OutHit.ImpactPoint;
+		}
+
+	}, Flags);
+}
+
+void UShooterHitscanSubsystem::ApplyPelletHits()
+{
+	UWorld* World = GetWorld();
+
+	// only make one impact noise per shot, even when it fires several pellets
+	uint32 LastNoiseShotId = 0;
+
+	for (int32 i = 0; i < PendingPellets.Num(); ++i)
+	{
+		const FShooterHitscanPellet& Pellet = PendingPellets[i];
+		const TArray<FHitResult, TInlineAllocator<4>>& Hits = PelletHits[i];
+
+		if (Hits.Num() == 0 || !Pellet.DamageDefaults)
+		{
+			continue;
+		}
+
+		FShooterProjectileSource Source;
+		Source.World = World;
+		Source.Owner = Pellet.Owner.Get();
+		Source.Instigator = Pellet.Instigator.Get();
+		Source.DamageCauser = Pellet.DamageCauser.Get();
+
+		// pellets of the same shot are queued together, so we only need to remember the last shot that made noise
+		if (Pellet.ShotId != LastNoiseShotId)
+		{
+			LastNoiseShotId = Pellet.ShotId;
+			Pellet.DamageDefaults->MakeImpactNoise(Source, Hits[0].ImpactPoint);
+		}
+
+		// damage every actor the pellet went through, losing damage with each penetration
+		float DamageScale = 1.0f;
+
+		for (const FHitResult& Hit : Hits)
+		{
+			Pellet.DamageDefaults->ProcessHit(Source, Hit.GetActor(), Hit.GetComponent(), Hit.ImpactPoint, Pellet.Direction, DamageScale);
+
+			DamageScale *= Pellet.PenetrationDamageScale;
+		}
+	}
+}
@@ -0,0 +1,98 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterHitscanSubsystem.generated.h"
+
+class AShooterProjectile;
+
+/**
+ *  A single hitscan pellet queued for resolution
+ */
+struct FShooterHitscanPellet
+{
+	/** Trace start location */
+	FVector Start = FVector::ZeroVector;
+
+	/** Normalized trace direction */
+	FVector Direction = FVector::ForwardVector;
+
+	/** Max trace distance */
+	float Range = 10000.0f;
+
+	/** Number of penetrable actors this pellet can go through after the first hit. Pawns, physics bodies and actors tagged "Penetrable" */
+	int32 MaxPenetrations = 0;
+
+	/** Damage multiplier applied for each actor penetrated */
+	float PenetrationDamageScale = 0.5f;
+
+	/** Channel to trace against. Defaults to the Projectile channel, which pawn capsules and meshes block */
+	TEnumAsByte<ECollisionChannel> Channel = ECC_GameTraceChannel1;
+
+	/** Identifies the shot this pellet belongs to, so multi pellet shots only make one impact noise */
+	uint32 ShotId = 0;
+
+	/** Projectile class whose defaults provide damage, damage type, physics force and noise */
+	TObjectPtr<const AShooterProjectile> DamageDefaults;
+
+	/** Actor that owns the weapon */
+	TWeakObjectPtr<AActor> Owner;
+
+	/** Pawn responsible for the damage */
+	TWeakObjectPtr<APawn> Instigator;
+
+	/** Actor reported as the damage causer */
+	TWeakObjectPtr<AActor> DamageCauser;
+};
+
+/**
+ *  Resolves hitscan shots from every weapon in the world in one batch
+ *  Shots are queued during the frame, traced in parallel when the subsystem ticks at the end of the frame,
+ *  and then damage and noise are applied in a single pass on the game thread
+ */
+UCLASS()
+class SYNAPSEQUEST_API UShooterHitscanSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Pellets queued this frame */
+	TArray<FShooterHitscanPellet> PendingPellets;
+
+	/** Trace results for each pellet. Holds one hit per actor penetrated */
+	TArray<TArray<FHitResult, TInlineAllocator<4>>> PelletHits;
+
+	/** Last shot ID handed out */
+	uint32 LastShotId = 0;
+
+public:
+
+	/** Only resolve shots in game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Traces and resolves every queued pellet */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/** Returns a new ID to group the pellets of a single shot */
+	uint32 NewShotId() { return ++LastShotId; }
+
+	/** Queues a pellet to be traced and resolved at the end of the frame */
+	void QueuePellet(FShooterHitscanPellet&& Pellet);
+
+	/** Returns the number of pellets waiting to be resolved */
+	int32 GetNumPendingPellets() const { return PendingPellets.Num(); }
+
+protected:
+
+	/** Runs the traces for every pending pellet */
+	void TracePellets();
+
+	/** Applies damage and noise for every traced pellet */
+	void ApplyPelletHits();
+};
@@ -7,12 +7,18 @@
 #include "Components/StaticMeshComponent.h"
 #include "ShooterWeaponHolder.h"
 #include "ShooterWeapon.h"
+#include "ShooterPickupSubsystem.h"
+#include "ShooterWeaponPreloadSubsystem.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
 #include "Engine/World.h"
-#include "TimerManager.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
 
 AShooterPickup::AShooterPickup()
 {
- 	PrimaryActorTick.bCanEverTick = true;
+ 	// spinning and respawns are handled by the pickup subsystem, so there's nothing to tick
+	PrimaryActorTick.bCanEverTick = false;
 
 	// create the root
 	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
@@ -36,6 +42,20 @@ AShooterPickup::AShooterPickup()
 	Mesh->SetupAttachment(SphereCollision);
 
 	Mesh->SetCollisionProfileName(FName("NoCollision"));
+
+	// pickups are placed in the level and rarely change, so they stay dormant until picked up or respawned
+	bReplicates = true;
+	NetDormancy = DORM_Initial;
+}
+
+void AShooterPickup::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(AShooterPickup, bPickedUp, Params);
 }
 
 void AShooterPickup::OnConstruction(const FTransform& Transform)
@@ -44,8 +64,24 @@ void AShooterPickup::OnConstruction(const FTransform& Transform)
 
 	if (FWeaponTableRow* WeaponData = WeaponType.GetRow<FWeaponTableRow>(FString()))
 	{
-		// set the mesh
-		Mesh->SetStaticMesh(WeaponData->StaticMesh.LoadSynchronous());
+		// show the weapon mesh if it's already in memory, or the placeholder until it streams in
+		UStaticMesh* LoadedMesh = WeaponData->StaticMesh.Get();
+		Mesh->SetStaticMesh(LoadedMesh ? LoadedMesh : PlaceholderMesh.Get());
+
+		// game worlds stream the mesh through the preload subsystem. In the editor, stream it in directly
+		if (!LoadedMesh && !WeaponData->StaticMesh.IsNull() && !GetWorld()->IsGameWorld())
+		{
+			TWeakObjectPtr<AShooterPickup> WeakThis(this);
+			TSoftObjectPtr<UStaticMesh> WeaponMesh = WeaponData->StaticMesh;
+
+			UAssetManager::GetStreamableManager().RequestAsyncLoad(WeaponMesh.ToSoftObjectPath(), FStreamableDelegate::CreateLambda([WeakThis, WeaponMesh]()
+			{
+				if (WeakThis.IsValid())
+				{
+					WeakThis->SetWeaponMesh(WeaponMesh.Get());
+				}
+			}));
+		}
 	}
 }
 
@@ -57,6 +93,27 @@ void AShooterPickup::BeginPlay()
 	{
 		// copy the weapon class
 		WeaponClass = WeaponData->WeaponToSpawn;
+
+		// get the weapon mesh, now or once it has streamed in
+		if (UShooterWeaponPreloadSubsystem* Preload = GetWorld()->GetSubsystem<UShooterWeaponPreloadSubsystem>())
+		{
+			Preload->RequestWeaponMesh(this);
+		}
+	}
+
+	// the subsystem bobs the mesh around where it was placed
+	MeshBaseLocation = Mesh->GetRelativeLocation();
+
+	// only the server hands out weapons, so clients don't need overlap events
+	if (!HasAuthority())
+	{
+		SphereCollision->SetGenerateOverlapEvents(false);
+	}
+
+	// register with the pickup subsystem
+	if (UShooterPickupSubsystem* PickupSubsystem = GetWorld()->GetSubsystem<UShooterPickupSubsystem>())
+	{
+		PickupSubsystem->RegisterPickup(this);
 	}
 }
 
@@ -64,45 +121,99 @@ void AShooterPickup::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
-	// clear the respawn timer
-	GetWorld()->GetTimerManager().ClearTimer(RespawnTimer);
+	// unregister from the pickup subsystem
+	if (UShooterPickupSubsystem* PickupSubsystem = GetWorld()->GetSubsystem<UShooterPickupSubsystem>())
+	{
+		PickupSubsystem->UnregisterPickup(this);
+	}
+}
+
+void AShooterPickup::SetWeaponMesh(UStaticMesh* WeaponMesh)
+{
+	if (WeaponMesh)
+	{
+		Mesh->SetStaticMesh(WeaponMesh);
+	}
+}
+
+void AShooterPickup::UpdateSpin(double Time)
+{
+	// keep the relative scale, since the respawn animation drives it
+	const FVector BobOffset(0.0f, 0.0f, FMath::Sin(Time * BobSpeed) * BobHeight);
+	const FRotator SpinRotation(0.0f, FMath::Fmod(Time * SpinRate, 360.0), 0.0f);
+
+	Mesh->SetRelativeLocationAndRotation(MeshBaseLocation + BobOffset, SpinRotation);
 }
 
 void AShooterPickup::OnOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
+	// only the server hands out weapons
+	if (!HasAuthority())
+	{
+		return;
+	}
+
 	// have we collided against a weapon holder?
 	if (IShooterWeaponHolder* WeaponHolder = Cast<IShooterWeaponHolder>(OtherActor))
 	{
 		WeaponHolder->AddWeaponClass(WeaponClass);
 
+		// hide the pickup
+		SetPickedUp(true);
+
+		// schedule the respawn
+		if (UShooterPickupSubsystem* PickupSubsystem = GetWorld()->GetSubsystem<UShooterPickupSubsystem>())
+		{
+			PickupSubsystem->ScheduleRespawn(this, RespawnTime);
+		}
+	}
+}
+
+void AShooterPickup::RespawnPickup()
+{
+	// unhide this pickup
+	SetPickedUp(false);
+}
+
+void AShooterPickup::SetPickedUp(bool bNewPickedUp)
+{
+	// dormant actors need to be flushed before changing replicated state. They go back to sleep once it's sent
+	FlushNetDormancy();
+
+	bPickedUp = bNewPickedUp;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AShooterPickup, bPickedUp, this);
+
+	ApplyPickedUpState();
+}
+
+void AShooterPickup::ApplyPickedUpState()
+{
+	if (bPickedUp)
+	{
 		// hide this mesh
 		SetActorHiddenInGame(true);
 
-		// disable collision
+		// disable collision, which also stops overlap detection while we wait to respawn
 		SetActorEnableCollision(false);
 
-		// disable ticking
-		SetActorTickEnabled(false);
+	} else {
+
+		// unhide this pickup
+		SetActorHiddenInGame(false);
+
+		// call the BP handler
+		BP_OnRespawn();
 
-		// schedule the respawn
-		GetWorld()->GetTimerManager().SetTimer(RespawnTimer, this, &AShooterPickup::RespawnPickup, RespawnTime, false);
 	}
 }
 
-void AShooterPickup::RespawnPickup()
+void AShooterPickup::OnRep_PickedUp()
 {
-	// unhide this pickup
-	SetActorHiddenInGame(false);
-
-	// call the BP handler
-	BP_OnRespawn();
+	ApplyPickedUpState();
 }
 
 void AShooterPickup::FinishRespawn()
 {
 	// enable collision
 	SetActorEnableCollision(true);
-
-	// enable tick
-	SetActorTickEnabled(true);
 }
@@ -20,7 +20,7 @@ struct FWeaponTableRow : public FTableRowBase
 {
 	GENERATED_BODY()
 
-	/** Mesh to display on the pickup */
+	/** Mesh to display on the pickup. Streamed in by the weapon preload subsystem */
 	UPROPERTY(EditAnywhere)
 	TSoftObjectPtr<UStaticMesh> StaticMesh;
 
@@ -31,8 +31,10 @@ struct FWeaponTableRow : public FTableRowBase
 
 /**
  *  Simple shooter game weapon pickup
+ *  Doesn't tick, and neither can its Blueprints. The pickup subsystem spins the mesh and schedules respawns
+ *  Shows a placeholder until its weapon mesh has streamed in
  */
-UCLASS(abstract)
+UCLASS(abstract, meta = (ChildCannotTick))
 class SYNAPSEQUEST_API AShooterPickup : public AActor
 {
 	GENERATED_BODY()
@@ -53,19 +55,42 @@ protected:
 
 	/** Type to weapon to grant on pickup. Set from the weapon data table. */
 	TSubclassOf<AShooterWeapon> WeaponClass;
+
+	/** Mesh to display until the weapon mesh has streamed in. Loaded with the pickup, so keep it cheap */
+	UPROPERTY(EditAnywhere, Category="Pickup")
+	TObjectPtr<UStaticMesh> PlaceholderMesh;
 	
 	/** Time to wait before respawning this pickup */
 	UPROPERTY(EditAnywhere, Category="Pickup", meta = (ClampMin = 0, ClampMax = 120, Units = "s"))
 	float RespawnTime = 4.0f;
 
-	/** Timer to respawn the pickup */
-	FTimerHandle RespawnTimer;
+	/** Speed the mesh spins at while the pickup is available */
+	UPROPERTY(EditAnywhere, Category="Pickup|Spin", meta = (ClampMin = 0, ClampMax = 720, Units = "DegreesPerSecond"))
+	float SpinRate = 100.0f;
+
+	/** Height the mesh bobs up and down by */
+	UPROPERTY(EditAnywhere, Category="Pickup|Spin", meta = (ClampMin = 0, ClampMax = 100, Units = "cm"))
+	float BobHeight = 15.0f;
+
+	/** Speed of the bobbing, in radians per second */
+	UPROPERTY(EditAnywhere, Category="Pickup|Spin", meta = (ClampMin = 0, ClampMax = 20))
+	float BobSpeed = 3.0f;
+
+	/** Relative location of the mesh the bobbing is centered on */
+	FVector MeshBaseLocation = FVector::ZeroVector;
+
+	/** If true, the pickup has been taken and is waiting to respawn. Only changed by the server */
+	UPROPERTY(ReplicatedUsing=OnRep_PickedUp)
+	bool bPickedUp = false;
 
 public:	
 	
 	/** Constructor */
 	AShooterPickup();
 
+	/** Sets up push model replication */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 protected:
 
 	/** Native construction script */
@@ -81,11 +106,35 @@ protected:
 	UFUNCTION()
 	virtual void OnOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
 
-protected:
+public:
 
-	/** Called when it's time to respawn this pickup */
+	/** Called by the pickup subsystem when it's time to respawn this pickup */
 	void RespawnPickup();
 
+	/** Returns true if the pickup has been taken and is waiting to respawn */
+	bool IsPickedUp() const { return bPickedUp; }
+
+	/** Returns the data table row for this pickup's weapon */
+	const FDataTableRowHandle& GetWeaponType() const { return WeaponType; }
+
+	/** Replaces the placeholder with the weapon mesh once it has streamed in */
+	void SetWeaponMesh(UStaticMesh* WeaponMesh);
+
+	/** Spins and bobs the mesh. Called by the pickup subsystem while the pickup is visible */
+	void UpdateSpin(double Time);
+
+protected:
+
+	/** Wakes the pickup up from net dormancy and replicates its new state */
+	void SetPickedUp(bool bNewPickedUp);
+
+	/** Hides or shows the pickup according to its state */
+	void ApplyPickedUpState();
+
+	/** Hides or shows the pickup on clients */
+	UFUNCTION()
+	void OnRep_PickedUp();
+
 	/** Passes control to Blueprint to animate the pickup respawn. Should end by calling FinishRespawn */
 	UFUNCTION(BlueprintImplementableEvent, Category="Pickup", meta = (DisplayName = "OnRespawn"))
 	void BP_OnRespawn();
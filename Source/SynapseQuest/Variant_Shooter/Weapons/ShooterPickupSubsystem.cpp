@@ -0,0 +1,128 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterPickupSubsystem.h"
+#include "ShooterPickup.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+
+bool UShooterPickupSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterPickupSubsystem::Deinitialize()
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(RespawnTimer);
+	}
+
+	Pickups.Reset();
+	PendingRespawns.Reset();
+
+	Super::Deinitialize();
+}
+
+void UShooterPickupSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// the spin is cosmetic, so dedicated servers skip it
+	UWorld* World = GetWorld();
+
+	if (Pickups.Num() == 0 || World->GetNetMode() == NM_DedicatedServer)
+	{
+		return;
+	}
+
+	const double Time = World->GetTimeSeconds();
+
+	for (const TWeakObjectPtr<AShooterPickup>& WeakPickup : Pickups)
+	{
+		// picked up pickups are hidden, so leave them alone until they respawn
+		AShooterPickup* Pickup = WeakPickup.Get();
+
+		if (Pickup && !Pickup->IsPickedUp())
+		{
+			Pickup->UpdateSpin(Time);
+		}
+	}
+}
+
+TStatId UShooterPickupSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterPickupSubsystem, STATGROUP_Tickables);
+}
+
+void UShooterPickupSubsystem::RegisterPickup(AShooterPickup* Pickup)
+{
+	if (Pickup)
+	{
+		Pickups.AddUnique(Pickup);
+	}
+}
+
+void UShooterPickupSubsystem::UnregisterPickup(AShooterPickup* Pickup)
+{
+	Pickups.RemoveSwap(Pickup);
+}
+
+void UShooterPickupSubsystem::ScheduleRespawn(AShooterPickup* Pickup, float Delay)
+{
+	FPendingRespawn PendingRespawn;
+	PendingRespawn.DueTime = GetWorld()->GetTimeSeconds() + FMath::Max(Delay, 0.0f);
+	PendingRespawn.Pickup = Pickup;
+
+	PendingRespawns.HeapPush(PendingRespawn);
+
+	// only rearm if this respawn is now the earliest
+	ArmRespawnTimer();
+}
+
+void UShooterPickupSubsystem::OnRespawnTimer()
+{
+	ArmedDueTime = 0.0;
+
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// respawn everything that's due, skipping pickups that ended play in the meantime
+	while (PendingRespawns.Num() > 0 && PendingRespawns.HeapTop().DueTime <= Now)
+	{
+		FPendingRespawn PendingRespawn;
+		PendingRespawns.HeapPop(PendingRespawn, EAllowShrinking::No);
+
+		AShooterPickup* Pickup = PendingRespawn.Pickup.Get();
+
+		if (IsValid(Pickup) && Pickup->HasActorBegunPlay())
+		{
+			Pickup->RespawnPickup();
+		}
+	}
+
+	// sleep until the next respawn
+	ArmRespawnTimer();
+}
+
+void UShooterPickupSubsystem::ArmRespawnTimer()
+{
+	if (PendingRespawns.Num() == 0)
+	{
+		return;
+	}
+
+	const double DueTime = PendingRespawns.HeapTop().DueTime;
+
+	// the timer is already armed for this respawn or an earlier one
+	if (ArmedDueTime > 0.0 && ArmedDueTime <= DueTime)
+	{
+		return;
+	}
+
+	ArmedDueTime = DueTime;
+
+	// a zero delay would clear the timer, so fire on the next frame instead
+	const float Delay = FMath::Max(static_cast<float>(DueTime - GetWorld()->GetTimeSeconds()), UE_KINDA_SMALL_NUMBER);
+
+	GetWorld()->GetTimerManager().SetTimer(RespawnTimer, this, &UShooterPickupSubsystem::OnRespawnTimer, Delay, false);
+}
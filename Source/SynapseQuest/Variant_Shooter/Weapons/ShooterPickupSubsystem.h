@@ -0,0 +1,87 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterPickupSubsystem.generated.h"
+
+class AShooterPickup;
+
+/**
+ *  Keeps track of every weapon pickup in the world, spins them and respawns them, replacing per pickup ticks and timers
+ *  Pickups are kept in a compact array and spun in a single tick, skipping hidden pickups and dedicated servers.
+ *  Pending respawns are kept in a min-heap ordered by due time, and a single timer is armed for the earliest one.
+ *  Respawns are only scheduled by the server
+ */
+UCLASS()
+class SYNAPSEQUEST_API UShooterPickupSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** A pickup waiting to respawn */
+	struct FPendingRespawn
+	{
+		/** World time the pickup respawns at */
+		double DueTime = 0.0;
+
+		/** Pickup to respawn */
+		TWeakObjectPtr<AShooterPickup> Pickup;
+
+		/** Heap ordering, earliest first */
+		bool operator<(const FPendingRespawn& Other) const { return DueTime < Other.DueTime; }
+	};
+
+	/** Registered pickups */
+	TArray<TWeakObjectPtr<AShooterPickup>> Pickups;
+
+	/** Min-heap of pending respawns */
+	TArray<FPendingRespawn> PendingRespawns;
+
+	/** Timer armed for the earliest pending respawn */
+	FTimerHandle RespawnTimer;
+
+	/** World time the respawn timer is armed for. Zero if it's not armed */
+	double ArmedDueTime = 0.0;
+
+public:
+
+	/** Only track pickups in game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Clears the respawn timer */
+	virtual void Deinitialize() override;
+
+	/** Spins every visible pickup */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable */
+	virtual TStatId GetStatId() const override;
+
+	/** Starts tracking a pickup */
+	void RegisterPickup(AShooterPickup* Pickup);
+
+	/** Stops tracking a pickup */
+	void UnregisterPickup(AShooterPickup* Pickup);
+
+	/**
+	 *  Schedules a pickup to respawn. Server only
+	 *  @param Pickup Pickup to respawn
+	 *  @param Delay Time to wait before respawning, in seconds
+	 */
+	void ScheduleRespawn(AShooterPickup* Pickup, float Delay);
+
+	/** Returns the number of registered pickups */
+	int32 GetNumPickups() const { return Pickups.Num(); }
+
+	/** Returns the number of pickups waiting to respawn */
+	int32 GetNumPendingRespawns() const { return PendingRespawns.Num(); }
+
+protected:
+
+	/** Respawns every due pickup and arms the timer for the next one */
+	void OnRespawnTimer();
+
+	/** Arms the respawn timer for the earliest pending respawn, if it isn't already */
+	void ArmRespawnTimer();
+};
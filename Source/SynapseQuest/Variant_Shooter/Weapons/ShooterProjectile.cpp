@@ -2,6 +2,7 @@
 
 
 #include "ShooterProjectile.h"
+#include "ShooterExplosionSubsystem.h"
 #include "Components/SphereComponent.h"
 #include "GameFramework/ProjectileMovementComponent.h"
 #include "GameFramework/Character.h"
@@ -9,7 +10,6 @@
 #include "GameFramework/DamageType.h"
 #include "GameFramework/Pawn.h"
 #include "GameFramework/Controller.h"
-#include "Engine/OverlapResult.h"
 #include "Engine/World.h"
 #include "TimerManager.h"
 
@@ -65,21 +65,8 @@ void AShooterProjectile::NotifyHit(class UPrimitiveComponent* MyComp, AActor* Ot
 	// disable collision on the projectile
 	CollisionComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 
-	// make AI perception noise
-	MakeNoise(NoiseLoudness, GetInstigator(), GetActorLocation(), NoiseRange, NoiseTag);
-
-	if (bExplodeOnHit)
-	{
-		
-		// apply explosion damage centered on the projectile
-		ExplosionCheck(GetActorLocation());
-
-	} else {
-
-		// single hit projectile. Process the collided actor
-		ProcessHit(Other, OtherComp, Hit.ImpactPoint, -Hit.ImpactNormal);
-
-	}
+	// make noise and damage whatever we hit
+	ProcessImpact(GetProjectileSource(), Hit);
 
 	// pass control to BP for any extra effects
 	BP_OnProjectileHit(Hit);
@@ -96,72 +83,118 @@ void AShooterProjectile::NotifyHit(class UPrimitiveComponent* MyComp, AActor* Ot
 	}
 }
 
-void AShooterProjectile::ExplosionCheck(const FVector& ExplosionCenter)
+void AShooterProjectile::ProcessImpact(const FShooterProjectileSource& Source, const FHitResult& Hit) const
 {
-	// do a sphere overlap check look for nearby actors to damage
-	TArray<FOverlapResult> Overlaps;
-
-	FCollisionShape OverlapShape;
-	OverlapShape.SetSphere(ExplosionRadius);
+	// projectiles on network clients are only for show. The server resolves the shot
+	if (Source.World->GetNetMode() == NM_Client)
+	{
+		return;
+	}
 
-	FCollisionObjectQueryParams ObjectParams;
-	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
-	ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
-	ObjectParams.AddObjectTypesToQuery(ECC_PhysicsBody);
+	// make AI perception noise
+	MakeImpactNoise(Source, Hit.Location);
 
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this);
-	if (!bDamageOwner)
+	if (bExplodeOnHit)
 	{
-		QueryParams.AddIgnoredActor(GetInstigator());
-	}
+		
+		// apply explosion damage centered on the projectile
+		ExplosionCheck(Source, Hit.Location);
 
-	GetWorld()->OverlapMultiByObjectType(Overlaps, ExplosionCenter, FQuat::Identity, ObjectParams, OverlapShape, QueryParams);
+	} else {
 
-	TArray<AActor*> DamagedActors;
+		// single hit projectile. Process the collided actor
+		ProcessHit(Source, Hit.GetActor(), Hit.GetComponent(), Hit.ImpactPoint, -Hit.ImpactNormal);
 
-	// process the overlap results
-	for (const FOverlapResult& CurrentOverlap : Overlaps)
-	{
-		// overlaps may return the same actor multiple times per each component overlapped
-		// ensure we only damage each actor once by adding it to a damaged list
-		if (DamagedActors.Find(CurrentOverlap.GetActor()) == INDEX_NONE)
-		{
-			DamagedActors.Add(CurrentOverlap.GetActor());
+	}
+}
 
-			// apply physics force away from the explosion
-			const FVector& ExplosionDir = CurrentOverlap.GetActor()->GetActorLocation() - GetActorLocation();
+void AShooterProjectile::ExplosionCheck(const FShooterProjectileSource& Source, const FVector& ExplosionCenter) const
+{
+	// explosions are resolved in a batch by the explosion subsystem
+	UShooterExplosionSubsystem* ExplosionSubsystem = Source.World->GetSubsystem<UShooterExplosionSubsystem>();
 
-			// push and/or damage the overlapped actor
-			ProcessHit(CurrentOverlap.GetActor(), CurrentOverlap.GetComponent(), GetActorLocation(), ExplosionDir.GetSafeNormal());
-		}
-			
+	if (!ExplosionSubsystem)
+	{
+		return;
 	}
+
+	FShooterExplosion Explosion;
+	Explosion.Center = ExplosionCenter;
+	Explosion.Radius = ExplosionRadius;
+	Explosion.FullDamageRadius = FMath::Min(ExplosionFullDamageRadius, ExplosionRadius);
+	Explosion.MinDamageScale = ExplosionMinDamageScale;
+	Explosion.Damage = HitDamage;
+	Explosion.PhysicsForce = PhysicsForce;
+	Explosion.DamageType = HitDamageType;
+	Explosion.bDamageOwner = bDamageOwner;
+	Explosion.bCheckOcclusion = bExplosionChecksOcclusion;
+	Explosion.Owner = Source.Owner;
+	Explosion.Instigator = Source.Instigator;
+	Explosion.DamageCauser = Source.DamageCauser;
+
+	ExplosionSubsystem->QueueExplosion(Explosion);
 }
 
-void AShooterProjectile::ProcessHit(AActor* HitActor, UPrimitiveComponent* HitComp, const FVector& HitLocation, const FVector& HitDirection)
+void AShooterProjectile::ProcessHit(const FShooterProjectileSource& Source, AActor* HitActor, UPrimitiveComponent* HitComp, const FVector& HitLocation, const FVector& HitDirection, float DamageScale) const
 {
+	// damage is only applied by the server
+	if (Source.World->GetNetMode() == NM_Client)
+	{
+		return;
+	}
+
 	// have we hit a character?
 	if (ACharacter* HitCharacter = Cast<ACharacter>(HitActor))
 	{
 		// ignore the owner of this projectile
-		if (HitCharacter != GetOwner() || bDamageOwner)
+		if (HitCharacter != Source.Owner || bDamageOwner)
 		{
+			// the instigator may have been destroyed while the projectile was in flight
+			AController* InstigatorController = IsValid(Source.Instigator) ? Source.Instigator->GetController() : nullptr;
+
 			// apply damage to the character
-			UGameplayStatics::ApplyDamage(HitCharacter, HitDamage, GetInstigator()->GetController(), this, HitDamageType);
+			UGameplayStatics::ApplyDamage(HitCharacter, HitDamage * DamageScale, InstigatorController, Source.DamageCauser, HitDamageType);
 		}
 	}
 
 	// have we hit a physics object?
-	if (HitComp->IsSimulatingPhysics())
+	if (HitComp && HitComp->IsSimulatingPhysics())
 	{
 		// give some physics impulse to the object
-		HitComp->AddImpulseAtLocation(HitDirection * PhysicsForce, HitLocation);
+		HitComp->AddImpulseAtLocation(HitDirection * PhysicsForce * DamageScale, HitLocation);
 	}
 }
 
+void AShooterProjectile::MakeImpactNoise(const FShooterProjectileSource& Source, const FVector& Location) const
+{
+	// noise needs an actor to originate from
+	if (IsValid(Source.DamageCauser))
+	{
+		Source.DamageCauser->MakeNoise(NoiseLoudness, Source.Instigator, Location, NoiseRange, NoiseTag);
+	}
+}
+
+FShooterProjectileSource AShooterProjectile::GetProjectileSource() const
+{
+	FShooterProjectileSource Source;
+	Source.World = GetWorld();
+	Source.Owner = GetOwner();
+	Source.Instigator = GetInstigator();
+	Source.DamageCauser = const_cast<AShooterProjectile*>(this);
+
+	return Source;
+}
+
 void AShooterProjectile::OnDeferredDestruction()
 {
 	// destroy this actor
 	Destroy();
 }
+
+bool AShooterProjectile::CanUseManagedSimulation() const
+{
+	// bouncing and physics projectiles need a full actor to simulate properly
+	return bAllowManagedSimulation
+		&& !ProjectileMovement->bShouldBounce
+		&& !CollisionComponent->IsSimulatingPhysics();
+}
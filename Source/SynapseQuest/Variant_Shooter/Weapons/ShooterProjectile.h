@@ -10,6 +10,26 @@ class USphereComponent;
 class UProjectileMovementComponent;
 class ACharacter;
 class UPrimitiveComponent;
+class UStaticMesh;
+
+/**
+ *  Describes who fired a projectile and what caused its damage.
+ *  Lets projectile hits be processed even when there's no live projectile actor
+ */
+struct FShooterProjectileSource
+{
+	/** World the projectile lives in */
+	UWorld* World = nullptr;
+
+	/** Actor that owns the projectile, usually the shooting character */
+	AActor* Owner = nullptr;
+
+	/** Pawn responsible for the damage done by the projectile */
+	APawn* Instigator = nullptr;
+
+	/** Actor reported as the damage causer and used to make hit noise */
+	AActor* DamageCauser = nullptr;
+};
 
 /**
  *  Simple projectile class for a first person shooter game
@@ -65,6 +85,18 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Projectile|Explosion", meta = (ClampMin = 0, ClampMax = 5000, Units = "cm"))
 	float ExplosionRadius = 500.0f;	
 
+	/** Actors within this distance of the explosion take full damage. Damage falls off linearly from here to the explosion radius */
+	UPROPERTY(EditAnywhere, Category="Projectile|Explosion", meta = (ClampMin = 0, ClampMax = 5000, Units = "cm"))
+	float ExplosionFullDamageRadius = 0.0f;
+
+	/** Damage multiplier for actors at the edge of the explosion radius */
+	UPROPERTY(EditAnywhere, Category="Projectile|Explosion", meta = (ClampMin = 0, ClampMax = 1))
+	float ExplosionMinDamageScale = 1.0f;
+
+	/** If true, actors hidden behind geometry from the explosion center are not affected */
+	UPROPERTY(EditAnywhere, Category="Projectile|Explosion")
+	bool bExplosionChecksOcclusion = false;
+
 	/** If true, this projectile has already hit another surface */
 	bool bHit = false;
 
@@ -75,6 +107,22 @@ protected:
 	/** Timer to handle deferred destruction of this projectile */
 	FTimerHandle DestructionTimer;
 
+	/** If true, weapons may simulate this projectile through the projectile subsystem instead of spawning an actor. Ignored for bouncing projectiles */
+	UPROPERTY(EditAnywhere, Category="Projectile|Managed")
+	bool bAllowManagedSimulation = true;
+
+	/** Mesh used to render this projectile when it's simulated by the projectile subsystem */
+	UPROPERTY(EditAnywhere, Category="Projectile|Managed")
+	TObjectPtr<UStaticMesh> ManagedMesh;
+
+	/** Scale applied to the managed projectile mesh */
+	UPROPERTY(EditAnywhere, Category="Projectile|Managed")
+	FVector ManagedMeshScale = FVector::OneVector;
+
+	/** Time a managed projectile can fly without hitting anything before it's discarded */
+	UPROPERTY(EditAnywhere, Category="Projectile|Managed", meta = (ClampMin = 0, ClampMax = 30, Units = "s"))
+	float ManagedLifetime = 3.0f;
+
 public:	
 
 	/** Constructor */
@@ -91,13 +139,24 @@ protected:
 	/** Handles collision */
 	virtual void NotifyHit(class UPrimitiveComponent* MyComp, AActor* Other, UPrimitiveComponent* OtherComp, bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit) override;
 
+public:
+
+	/** Makes hit noise and damages the hit actor, or explodes if this is an explosive projectile. Safe to call on the class default object */
+	void ProcessImpact(const FShooterProjectileSource& Source, const FHitResult& Hit) const;
+
+	/** Processes a projectile hit for the given actor. Damage is scaled by the given factor. Safe to call on the class default object */
+	void ProcessHit(const FShooterProjectileSource& Source, AActor* HitActor, UPrimitiveComponent* HitComp, const FVector& HitLocation, const FVector& HitDirection, float DamageScale = 1.0f) const;
+
+	/** Makes the AI perception noise for a hit at the given location. Safe to call on the class default object */
+	void MakeImpactNoise(const FShooterProjectileSource& Source, const FVector& Location) const;
+
 protected:
 
-	/** Looks up actors within the explosion radius and damages them */
-	void ExplosionCheck(const FVector& ExplosionCenter);
+	/** Queues an explosion with the explosion subsystem to damage actors within the explosion radius */
+	void ExplosionCheck(const FShooterProjectileSource& Source, const FVector& ExplosionCenter) const;
 
-	/** Processes a projectile hit for the given actor */
-	void ProcessHit(AActor* HitActor, UPrimitiveComponent* HitComp, const FVector& HitLocation, const FVector& HitDirection);
+	/** Builds the projectile source for this projectile actor */
+	FShooterProjectileSource GetProjectileSource() const;
 
 	/** Passes control to Blueprint to implement any effects on hit. */
 	UFUNCTION(BlueprintImplementableEvent, Category="Projectile", meta = (DisplayName = "On Projectile Hit"))
@@ -106,4 +165,23 @@ protected:
 	/** Called from the destruction timer to destroy this projectile */
 	void OnDeferredDestruction();
 
+public:
+
+	/** Returns true if this projectile can be simulated by the projectile subsystem without spawning an actor */
+	bool CanUseManagedSimulation() const;
+
+	/** Returns the collision component */
+	USphereComponent* GetCollisionComponent() const { return CollisionComponent; }
+
+	/** Returns the projectile movement component */
+	UProjectileMovementComponent* GetProjectileMovement() const { return ProjectileMovement; }
+
+	/** Returns the mesh used to render managed projectiles */
+	UStaticMesh* GetManagedMesh() const { return ManagedMesh; }
+
+	/** Returns the scale applied to the managed projectile mesh */
+	const FVector& GetManagedMeshScale() const { return ManagedMeshScale; }
+
+	/** Returns the max flight time of managed projectiles */
+	float GetManagedLifetime() const { return ManagedLifetime; }
 };
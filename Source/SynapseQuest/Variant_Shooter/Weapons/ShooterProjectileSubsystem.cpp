@@ -0,0 +1,324 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterProjectileSubsystem.h"
+#include "ShooterProjectile.h"
+#include "ShooterBenchmarkStats.h"
+#include "Components/SphereComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarShooterProjectileParallelSweepThreshold(
+	TEXT("Shooter.Projectiles.ParallelSweepThreshold"),
+	64,
+	TEXT("Minimum number of managed projectiles in flight before their sweeps are distributed across worker threads.\n")
+	TEXT("Set to 0 to always sweep on the game thread."),
+	ECVF_Default);
+
+bool UShooterProjectileSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterProjectileSubsystem::Deinitialize()
+{
+	// destroy the render actor
+	if (IsValid(RenderActor))
+	{
+		RenderActor->Destroy();
+	}
+
+	RenderActor = nullptr;
+	InstanceComponents.Reset();
+	Types.Reset();
+	TypeIndices.Reset();
+
+	Super::Deinitialize();
+}
+
+TStatId UShooterProjectileSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterProjectileSubsystem, STATGROUP_Tickables);
+}
+
+bool UShooterProjectileSubsystem::LaunchProjectile(TSubclassOf<AShooterProjectile> ProjectileClass, const FTransform& SpawnTransform, AActor* ShotOwner, APawn* ShotInstigator, AActor* DamageCauser)
+{
+	// find the projectile type
+	const int32 TypeIndex = FindOrAddType(ProjectileClass);
+
+	if (TypeIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FProjectileType& Type = Types[TypeIndex];
+	const UProjectileMovementComponent* Movement = Type.Defaults->GetProjectileMovement();
+
+	// launch along the spawn transform's facing, same as the projectile movement component does by default
+	const FVector Velocity = SpawnTransform.GetRotation().GetForwardVector() * FMath::Min(Movement->InitialSpeed, Type.MaxSpeed);
+
+	Positions.Add(SpawnTransform.GetLocation());
+	PreviousPositions.Add(SpawnTransform.GetLocation());
+	Velocities.Add(Velocity);
+	Lifetimes.Add(Type.Defaults->GetManagedLifetime());
+	TypeIds.Add(static_cast<uint16>(TypeIndex));
+	Owners.Add(ShotOwner);
+	Instigators.Add(ShotInstigator);
+	DamageCausers.Add(DamageCauser);
+
+	return true;
+}
+
+int32 UShooterProjectileSubsystem::FindOrAddType(TSubclassOf<AShooterProjectile> ProjectileClass)
+{
+	if (!ProjectileClass)
+	{
+		return INDEX_NONE;
+	}
+
+	// have we already registered this class?
+	if (const int32* FoundIndex = TypeIndices.Find(ProjectileClass.Get()))
+	{
+		return *FoundIndex;
+	}
+
+	const AShooterProjectile* Defaults = ProjectileClass->GetDefaultObject<AShooterProjectile>();
+
+	// ensure the class can be simulated without an actor
+	if (!Defaults->CanUseManagedSimulation() || Types.Num() >= MAX_uint16)
+	{
+		TypeIndices.Add(ProjectileClass.Get(), INDEX_NONE);
+		return INDEX_NONE;
+	}
+
+	UWorld* World = GetWorld();
+
+	// lazily spawn the actor that holds the instanced meshes
+	if (!IsValid(RenderActor))
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		RenderActor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+
+		USceneComponent* Root = NewObject<USceneComponent>(RenderActor, TEXT("Root"));
+		RenderActor->SetRootComponent(Root);
+		Root->RegisterComponent();
+	}
+
+	FProjectileType& Type = Types.AddDefaulted_GetRef();
+	Type.Defaults = Defaults;
+	Type.Radius = Defaults->GetCollisionComponent()->GetUnscaledSphereRadius();
+	Type.MaxSpeed = Defaults->GetProjectileMovement()->MaxSpeed > 0.0f ? Defaults->GetProjectileMovement()->MaxSpeed : UE_BIG_NUMBER;
+	Type.GravityZ = World->GetGravityZ() * Defaults->GetProjectileMovement()->ProjectileGravityScale;
+	Type.Channel = Defaults->GetCollisionComponent()->GetCollisionObjectType();
+
+	// create the instanced mesh for this type
+	if (UStaticMesh* Mesh = Defaults->GetManagedMesh())
+	{
+		Type.Instances = NewObject<UInstancedStaticMeshComponent>(RenderActor);
+		Type.Instances->SetStaticMesh(Mesh);
+		Type.Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Type.Instances->SetCanEverAffectNavigation(false);
+		Type.Instances->SetupAttachment(RenderActor->GetRootComponent());
+		Type.Instances->RegisterComponent();
+
+		InstanceComponents.Add(Type.Instances);
+	}
+
+	const int32 TypeIndex = Types.Num() - 1;
+	TypeIndices.Add(ProjectileClass.Get(), TypeIndex);
+
+	return TypeIndex;
+}
+
+void UShooterProjectileSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (Positions.Num() > 0)
+	{
+		Integrate(DeltaTime);
+		SweepProjectiles();
+		ResolveProjectiles();
+	}
+
+	UpdateInstances();
+}
+
+void UShooterProjectileSubsystem::Integrate(float DeltaTime)
+{
+	const int32 Num = Positions.Num();
+
+	// remember where each projectile started this frame so we can sweep along its path
+	FMemory::Memcpy(PreviousPositions.GetData(), Positions.GetData(), Num * sizeof(FVector));
+
+	// apply gravity per type. Projectiles without gravity skip this entirely
+	for (int32 i = 0; i < Num; ++i)
+	{
+		const FProjectileType& Type = Types[TypeIds[i]];
+
+		if (Type.GravityZ != 0.0f)
+		{
+			Velocities[i].Z += Type.GravityZ * DeltaTime;
+			Velocities[i] = Velocities[i].GetClampedToMaxSize(Type.MaxSpeed);
+		}
+	}
+
+	// position and velocity buffers are contiguous, so we can integrate them as flat component arrays
+	// this loop has no dependencies between elements and vectorizes cleanly
+	static_assert(sizeof(FVector) == 3 * sizeof(FVector::FReal), "FVector is expected to be tightly packed");
+
+	FVector::FReal* RESTRICT Pos = reinterpret_cast<FVector::FReal*>(Positions.GetData());
+	const FVector::FReal* RESTRICT Vel = reinterpret_cast<const FVector::FReal*>(Velocities.GetData());
+	const FVector::FReal Step = DeltaTime;
+
+	for (int32 i = 0, NumComponents = Num * 3; i < NumComponents; ++i)
+	{
+		Pos[i] += Vel[i] * Step;
+	}
+
+	// age the projectiles
+	for (int32 i = 0; i < Num; ++i)
+	{
+		Lifetimes[i] -= DeltaTime;
+	}
+}
+
+void UShooterProjectileSubsystem::SweepProjectiles()
+{
+	const int32 Num = Positions.Num();
+	UWorld* World = GetWorld();
+
+	SweepHits.Reset();
+	SweepHits.SetNum(Num);
+
+	// small batches aren't worth the overhead of going wide
+	const int32 Threshold = CVarShooterProjectileParallelSweepThreshold.GetValueOnGameThread();
+	const EParallelForFlags Flags = (Threshold <= 0 || Num < Threshold) ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None;
+
+	// scene queries are read only, so every projectile can be swept independently
+	ParallelFor(Num, [this, World](int32 Index)
+	{
+		const FProjectileType& Type = Types[TypeIds[Index]];
+
+		// ignore the pawn that shot the projectile
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ShooterManagedProjectile), false, Instigators[Index].Get());
+
+		World->SweepSingleByChannel(SweepHits[Index], PreviousPositions[Index], Positions[Index], FQuat::Identity, Type.Channel, FCollisionShape::MakeSphere(Type.Radius), QueryParams);
+
+	}, Flags);
+
+	FShooterBenchmarkStats::AddSceneQueries(Num);
+}
+
+void UShooterProjectileSubsystem::ResolveProjectiles()
+{
+	PendingRemoval.Reset();
+
+	UWorld* World = GetWorld();
+
+	// process hits on the game thread. Damage and physics aren't safe to apply from workers
+	for (int32 i = 0; i < Positions.Num(); ++i)
+	{
+		const FHitResult& Hit = SweepHits[i];
+
+		if (Hit.bBlockingHit)
+		{
+			FShooterProjectileSource Source;
+			Source.World = World;
+			Source.Owner = Owners[i].Get();
+			Source.Instigator = Instigators[i].Get();
+			Source.DamageCauser = DamageCausers[i].Get();
+
+			// resolve the hit through the projectile class logic
+			Types[TypeIds[i]].Defaults->ProcessImpact(Source, Hit);
+
+			PendingRemoval.Add(i);
+
+		} else if (Lifetimes[i] <= 0.0f) {
+
+			// the projectile expired without hitting anything
+			PendingRemoval.Add(i);
+		}
+	}
+
+	// remove back to front so swapped in elements have already been processed
+	for (int32 i = PendingRemoval.Num() - 1; i >= 0; --i)
+	{
+		RemoveProjectileAtSwap(PendingRemoval[i]);
+	}
+}
+
+void UShooterProjectileSubsystem::RemoveProjectileAtSwap(int32 Index)
+{
+	Positions.RemoveAtSwap(Index, EAllowShrinking::No);
+	PreviousPositions.RemoveAtSwap(Index, EAllowShrinking::No);
+	Velocities.RemoveAtSwap(Index, EAllowShrinking::No);
+	Lifetimes.RemoveAtSwap(Index, EAllowShrinking::No);
+	TypeIds.RemoveAtSwap(Index, EAllowShrinking::No);
+	Owners.RemoveAtSwap(Index, EAllowShrinking::No);
+	Instigators.RemoveAtSwap(Index, EAllowShrinking::No);
+	DamageCausers.RemoveAtSwap(Index, EAllowShrinking::No);
+}
+
+void UShooterProjectileSubsystem::UpdateInstances()
+{
+	// gather the transforms per type
+	for (FProjectileType& Type : Types)
+	{
+		Type.InstanceTransforms.Reset();
+	}
+
+	for (int32 i = 0; i < Positions.Num(); ++i)
+	{
+		FProjectileType& Type = Types[TypeIds[i]];
+
+		if (Type.Instances)
+		{
+			Type.InstanceTransforms.Emplace(Velocities[i].ToOrientationQuat(), Positions[i], Type.Defaults->GetManagedMeshScale());
+		}
+	}
+
+	// push them to the instanced meshes
+	for (FProjectileType& Type : Types)
+	{
+		if (!Type.Instances)
+		{
+			continue;
+		}
+
+		const int32 Desired = Type.InstanceTransforms.Num();
+		const int32 Current = Type.Instances->GetInstanceCount();
+
+		if (Current > Desired)
+		{
+			// trim the instances we no longer need from the end of the list, which avoids reindexing
+			TArray<int32> ToRemove;
+			ToRemove.Reserve(Current - Desired);
+
+			for (int32 i = Current - 1; i >= Desired; --i)
+			{
+				ToRemove.Add(i);
+			}
+
+			Type.Instances->RemoveInstances(ToRemove);
+
+		} else if (Current < Desired) {
+
+			// add the missing instances
+			TArray<FTransform> NewInstances(Type.InstanceTransforms.GetData() + Current, Desired - Current);
+			Type.Instances->AddInstances(NewInstances, false, true);
+		}
+
+		if (Desired > 0)
+		{
+			Type.Instances->BatchUpdateInstancesTransforms(0, Type.InstanceTransforms, true, true, true);
+		}
+	}
+}
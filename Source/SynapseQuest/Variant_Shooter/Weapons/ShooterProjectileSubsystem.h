@@ -0,0 +1,136 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterProjectile.h"
+#include "ShooterProjectileSubsystem.generated.h"
+
+class UInstancedStaticMeshComponent;
+
+/**
+ *  Simulates simple shooter projectiles without spawning an actor for each one
+ *  Projectile state is kept in structure-of-arrays buffers that are integrated and swept in one batched pass per frame
+ *  Only non-bouncing, non-physics projectiles are eligible. Hits are resolved through the projectile class defaults,
+ *  so they go through the same damage and explosion logic as projectile actors
+ *  Managed projectiles are rendered through one instanced static mesh per projectile class
+ */
+UCLASS()
+class SYNAPSEQUEST_API UShooterProjectileSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Data shared by all managed projectiles of the same class */
+	struct FProjectileType
+	{
+		/** Class defaults used to resolve hits */
+		TObjectPtr<const AShooterProjectile> Defaults;
+
+		/** Instanced mesh that renders every projectile of this type */
+		TObjectPtr<UInstancedStaticMeshComponent> Instances;
+
+		/** Collision radius of the projectile sweep */
+		float Radius = 0.0f;
+
+		/** Max speed of the projectile */
+		float MaxSpeed = 0.0f;
+
+		/** Gravity acceleration to apply to the projectile */
+		float GravityZ = 0.0f;
+
+		/** Collision channel to sweep against */
+		TEnumAsByte<ECollisionChannel> Channel = ECC_WorldDynamic;
+
+		/** Scratch buffer used to build the instance transforms every frame */
+		TArray<FTransform> InstanceTransforms;
+	};
+
+	/** Registered projectile types */
+	TArray<FProjectileType> Types;
+
+	/** Maps projectile classes to their index in the types list */
+	TMap<TObjectKey<UClass>, int32> TypeIndices;
+
+	/** Actor that holds the instanced mesh components */
+	UPROPERTY(Transient)
+	TObjectPtr<AActor> RenderActor;
+
+	/** Instanced mesh components, kept here so they're referenced by GC */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UInstancedStaticMeshComponent>> InstanceComponents;
+
+	// projectile buffers. Every array has one element per live projectile
+
+	/** Current projectile locations */
+	TArray<FVector> Positions;
+
+	/** Projectile locations at the start of the current frame */
+	TArray<FVector> PreviousPositions;
+
+	/** Current projectile velocities */
+	TArray<FVector> Velocities;
+
+	/** Remaining flight time */
+	TArray<float> Lifetimes;
+
+	/** Index into the types list */
+	TArray<uint16> TypeIds;
+
+	/** Actor that owns each projectile */
+	TArray<TWeakObjectPtr<AActor>> Owners;
+
+	/** Pawn responsible for each projectile's damage */
+	TArray<TWeakObjectPtr<APawn>> Instigators;
+
+	/** Actor reported as the damage causer, usually the weapon */
+	TArray<TWeakObjectPtr<AActor>> DamageCausers;
+
+	/** Sweep results for the current frame */
+	TArray<FHitResult> SweepHits;
+
+	/** Indices of the projectiles to remove this frame */
+	TArray<int32> PendingRemoval;
+
+public:
+
+	/** Only simulate projectiles in game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Integrates, sweeps and renders every managed projectile */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/** Launches a managed projectile of the given class. Returns false if the class can't be simulated without an actor */
+	bool LaunchProjectile(TSubclassOf<AShooterProjectile> ProjectileClass, const FTransform& SpawnTransform, AActor* ShotOwner, APawn* ShotInstigator, AActor* DamageCauser);
+
+	/** Returns the number of projectiles in flight */
+	int32 GetNumProjectiles() const { return Positions.Num(); }
+
+protected:
+
+	/** Finds or registers the type data for the given projectile class. Returns INDEX_NONE if the class isn't eligible */
+	int32 FindOrAddType(TSubclassOf<AShooterProjectile> ProjectileClass);
+
+	/** Advances every projectile by the given time step */
+	void Integrate(float DeltaTime);
+
+	/** Sweeps every projectile along its movement for this frame */
+	void SweepProjectiles();
+
+	/** Processes hits and expired projectiles */
+	void ResolveProjectiles();
+
+	/** Removes the projectile at the given index by swapping it with the last one */
+	void RemoveProjectileAtSwap(int32 Index);
+
+	/** Pushes the projectile transforms to the instanced meshes */
+	void UpdateInstances();
+};
@@ -5,9 +5,11 @@
 #include "Kismet/KismetMathLibrary.h"
 #include "Engine/World.h"
 #include "ShooterProjectile.h"
+#include "ShooterProjectileSubsystem.h"
+#include "ShooterHitscanSubsystem.h"
+#include "ShooterRandomSubsystem.h"
 #include "ShooterWeaponHolder.h"
 #include "Components/SceneComponent.h"
-#include "TimerManager.h"
 #include "Animation/AnimInstance.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "GameFramework/Pawn.h"
@@ -34,32 +36,60 @@ AShooterWeapon::AShooterWeapon()
 	ThirdPersonMesh->SetCollisionProfileName(FName("NoCollision"));
 	ThirdPersonMesh->SetFirstPersonPrimitiveType(EFirstPersonPrimitiveType::WorldSpaceRepresentation);
 	ThirdPersonMesh->bOwnerNoSee = true;
+
+	// weapons replicate so clients can attach and show them, but they only matter to clients their owner is relevant to
+	bReplicates = true;
+	bNetUseOwnerRelevancy = true;
 }
 
 void AShooterWeapon::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// subscribe to the owner's destroyed delegate
-	GetOwner()->OnDestroyed.AddDynamic(this, &AShooterWeapon::OnOwnerDestroyed);
-
-	// cast the weapon owner
-	WeaponOwner = Cast<IShooterWeaponHolder>(GetOwner());
-	PawnOwner = Cast<APawn>(GetOwner());
-
 	// fill the first ammo clip
 	CurrentBullets = MagazineSize;
 
-	// attach the meshes to the owner
-	WeaponOwner->AttachWeaponMeshes(this);
+	// the owner may not have replicated yet on clients
+	InitWeaponOwner();
 }
 
 void AShooterWeapon::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
-	// clear the refire timer
-	GetWorld()->GetTimerManager().ClearTimer(RefireTimer);
+	// drop any pending fire event
+	CancelFireEvent();
+}
+
+void AShooterWeapon::OnRep_Owner()
+{
+	Super::OnRep_Owner();
+
+	if (HasActorBegunPlay())
+	{
+		InitWeaponOwner();
+	}
+}
+
+void AShooterWeapon::InitWeaponOwner()
+{
+	if (WeaponOwner || !GetOwner())
+	{
+		return;
+	}
+
+	// subscribe to the owner's destroyed delegate
+	GetOwner()->OnDestroyed.AddDynamic(this, &AShooterWeapon::OnOwnerDestroyed);
+
+	// cast the weapon owner
+	WeaponOwner = Cast<IShooterWeaponHolder>(GetOwner());
+	PawnOwner = Cast<APawn>(GetOwner());
+
+	// attach the meshes to the owner
+	if (WeaponOwner)
+	{
+		WeaponOwner->AttachWeaponMeshes(this);
+	}
 }
 
 void AShooterWeapon::OnOwnerDestroyed(AActor* DestroyedActor)
@@ -74,19 +104,26 @@ void AShooterWeapon::ActivateWeapon()
 	SetActorHiddenInGame(false);
 
 	// notify the owner
-	WeaponOwner->OnWeaponActivated(this);
+	if (WeaponOwner)
+	{
+		WeaponOwner->OnWeaponActivated(this);
+	}
 }
 
 void AShooterWeapon::DeactivateWeapon()
 {
-	// ensure we're no longer firing this weapon while deactivated
+	// ensure we're no longer firing this weapon while deactivated, including buffered shots
+	bShotBuffered = false;
 	StopFiring();
 
 	// hide the weapon
 	SetActorHiddenInGame(true);
 
 	// notify the owner
-	WeaponOwner->OnWeaponDeactivated(this);
+	if (WeaponOwner)
+	{
+		WeaponOwner->OnWeaponDeactivated(this);
+	}
 }
 
 void AShooterWeapon::StartFiring()
@@ -96,21 +133,23 @@ void AShooterWeapon::StartFiring()
 
 	// check how much time has passed since we last shot
 	// this may be under the refire rate if the weapon shoots slow enough and the player is spamming the trigger
-	const float TimeSinceLastShot = GetWorld()->GetTimeSeconds() - TimeOfLastShot;
+	const double TimeSinceLastShot = GetWorld()->GetTimeSeconds() - TimeOfLastShot;
 
-	if (TimeSinceLastShot > RefireRate)
+	if (TimeSinceLastShot >= RefireRate)
 	{
 		// fire the weapon right away
 		Fire();
 
 	} else {
 
-		// if we're full auto, schedule the next shot
-		if (bFullAuto)
+		// wait out the rest of the cooldown before shooting
+		ScheduleFireEvent(EShooterWeaponFireEvent::Fire, TimeOfLastShot + RefireRate);
+
+		// semi auto weapons remember the trigger pull, so spamming the trigger never drops a shot
+		if (!bFullAuto)
 		{
-			GetWorld()->GetTimerManager().SetTimer(RefireTimer, this, &AShooterWeapon::Fire, TimeSinceLastShot, false);
+			bShotBuffered = true;
 		}
-
 	}
 }
 
@@ -119,23 +158,30 @@ void AShooterWeapon::StopFiring()
 	// lower the firing flag
 	bIsFiring = false;
 
-	// clear the refire timer
-	GetWorld()->GetTimerManager().ClearTimer(RefireTimer);
+	// cancel the pending shot or cooldown, unless a buffered semi auto shot is still waiting to fire
+	if (!bShotBuffered)
+	{
+		CancelFireEvent();
+	}
 }
 
 void AShooterWeapon::Fire()
 {
 	// ensure the player still wants to fire. They may have let go of the trigger
-	if (!bIsFiring)
+	if (!bIsFiring && !bShotBuffered)
 	{
 		return;
 	}
+
+	bShotBuffered = false;
 	
 	// fire a projectile at the target
 	FireProjectile(WeaponOwner->GetWeaponTargetLocation());
 
-	// update the time of our last shot
-	TimeOfLastShot = GetWorld()->GetTimeSeconds();
+	// update the time of our last shot. Scheduled shots count from their due time so full auto doesn't drift by a frame per shot,
+	// but never from more than one refire ago, so time lost to a hitch isn't paid back as a burst of catch up shots
+	const double Now = GetWorld()->GetTimeSeconds();
+	TimeOfLastShot = ScheduledShotTime >= 0.0 ? FMath::Max(ScheduledShotTime, Now - RefireRate) : Now;
 
 	// make noise so the AI perception system can hear us
 	MakeNoise(ShotLoudness, PawnOwner, PawnOwner->GetActorLocation(), ShotNoiseRange, ShotNoiseTag);
@@ -144,11 +190,11 @@ void AShooterWeapon::Fire()
 	if (bFullAuto)
 	{
 		// schedule the next shot
-		GetWorld()->GetTimerManager().SetTimer(RefireTimer, this, &AShooterWeapon::Fire, RefireRate, false);
+		ScheduleFireEvent(EShooterWeaponFireEvent::Fire, TimeOfLastShot + RefireRate);
 	} else {
 
 		// for semi-auto weapons, schedule the cooldown notification
-		GetWorld()->GetTimerManager().SetTimer(RefireTimer, this, &AShooterWeapon::FireCooldownExpired, RefireRate, false);
+		ScheduleFireEvent(EShooterWeaponFireEvent::CooldownExpired, TimeOfLastShot + RefireRate);
 
 	}
 }
@@ -159,19 +205,42 @@ void AShooterWeapon::FireCooldownExpired()
 	WeaponOwner->OnSemiWeaponRefire();
 }
 
+void AShooterWeapon::ScheduleFireEvent(EShooterWeaponFireEvent Event, double DueTime)
+{
+	// invalidate the previous event
+	++FireScheduleSerial;
+
+	if (UShooterWeaponFireSubsystem* FireScheduler = GetWorld()->GetSubsystem<UShooterWeaponFireSubsystem>())
+	{
+		FireScheduler->ScheduleEvent(this, Event, DueTime, FireScheduleSerial);
+	}
+}
+
+void AShooterWeapon::HandleFireEvent(EShooterWeaponFireEvent Event, double DueTime)
+{
+	switch (Event)
+	{
+	case EShooterWeaponFireEvent::Fire:
+		ScheduledShotTime = DueTime;
+		Fire();
+		ScheduledShotTime = -1.0;
+		break;
+
+	case EShooterWeaponFireEvent::CooldownExpired:
+		FireCooldownExpired();
+		break;
+	}
+}
+
 void AShooterWeapon::FireProjectile(const FVector& TargetLocation)
 {
-	// get the projectile transform
-	FTransform ProjectileTransform = CalculateProjectileSpawnTransform(TargetLocation);
-	
-	// spawn the projectile
-	FActorSpawnParameters SpawnParams;
-	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-	SpawnParams.TransformScaleMethod = ESpawnActorScaleMethod::OverrideRootScale;
-	SpawnParams.Owner = GetOwner();
-	SpawnParams.Instigator = PawnOwner;
+	SpawnShot(TargetLocation);
 
-	AShooterProjectile* Projectile = GetWorld()->SpawnActor<AShooterProjectile>(ProjectileClass, ProjectileTransform, SpawnParams);
+	// let the other clients see the shot. The owning client already predicted it
+	if (HasAuthority() && GetNetMode() != NM_Standalone)
+	{
+		MulticastFireCosmetic(TargetLocation);
+	}
 
 	// play the firing montage
 	WeaponOwner->PlayFiringMontage(FiringMontage);
@@ -192,6 +261,93 @@ void AShooterWeapon::FireProjectile(const FVector& TargetLocation)
 	WeaponOwner->UpdateWeaponHUD(CurrentBullets, MagazineSize);
 }
 
+void AShooterWeapon::SpawnShot(const FVector& TargetLocation)
+{
+	// resolve the shot through traces or projectiles
+	if (bHitscan)
+	{
+		QueueHitscanShot(TargetLocation);
+
+	} else {
+
+		LaunchProjectile(CalculateProjectileSpawnTransform(TargetLocation));
+
+	}
+}
+
+void AShooterWeapon::MulticastFireCosmetic_Implementation(FVector_NetQuantize TargetLocation)
+{
+	// the server and the owning client have already fired this shot
+	if (HasAuthority() || !WeaponOwner || (PawnOwner && PawnOwner->IsLocallyControlled()))
+	{
+		return;
+	}
+
+	// client shots don't apply damage, so this only plays the effects
+	SpawnShot(TargetLocation);
+
+	WeaponOwner->PlayFiringMontage(FiringMontage);
+}
+
+void AShooterWeapon::LaunchProjectile(const FTransform& ProjectileTransform)
+{
+	// try to launch an actorless projectile first
+	if (bUseManagedProjectiles)
+	{
+		if (UShooterProjectileSubsystem* ProjectileSubsystem = GetWorld()->GetSubsystem<UShooterProjectileSubsystem>())
+		{
+			if (ProjectileSubsystem->LaunchProjectile(ProjectileClass, ProjectileTransform, GetOwner(), PawnOwner, this))
+			{
+				return;
+			}
+		}
+	}
+
+	// spawn the projectile
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.TransformScaleMethod = ESpawnActorScaleMethod::OverrideRootScale;
+	SpawnParams.Owner = GetOwner();
+	SpawnParams.Instigator = PawnOwner;
+
+	GetWorld()->SpawnActor<AShooterProjectile>(ProjectileClass, ProjectileTransform, SpawnParams);
+}
+
+void AShooterWeapon::QueueHitscanShot(const FVector& TargetLocation)
+{
+	UShooterHitscanSubsystem* HitscanSubsystem = GetWorld()->GetSubsystem<UShooterHitscanSubsystem>();
+
+	// damage and noise settings come from the projectile class
+	if (!HitscanSubsystem || !ProjectileClass)
+	{
+		return;
+	}
+
+	const AShooterProjectile* DamageDefaults = ProjectileClass->GetDefaultObject<AShooterProjectile>();
+	const uint32 ShotId = HitscanSubsystem->NewShotId();
+
+	// queue each pellet with its own aim variance
+	for (int32 i = 0; i < PelletsPerShot; ++i)
+	{
+		const FTransform PelletTransform = CalculateProjectileSpawnTransform(TargetLocation);
+
+		FShooterHitscanPellet Pellet;
+		Pellet.Start = PelletTransform.GetLocation();
+		Pellet.Direction = PelletTransform.GetRotation().GetForwardVector();
+		Pellet.Range = HitscanRange;
+		Pellet.MaxPenetrations = MaxPenetrations;
+		Pellet.PenetrationDamageScale = PenetrationDamageScale;
+		Pellet.Channel = HitscanChannel;
+		Pellet.ShotId = ShotId;
+		Pellet.DamageDefaults = DamageDefaults;
+		Pellet.Owner = GetOwner();
+		Pellet.Instigator = PawnOwner;
+		Pellet.DamageCauser = this;
+
+		HitscanSubsystem->QueuePellet(MoveTemp(Pellet));
+	}
+}
+
 FTransform AShooterWeapon::CalculateProjectileSpawnTransform(const FVector& TargetLocation) const
 {
 	// find the muzzle location
@@ -201,7 +357,7 @@ FTransform AShooterWeapon::CalculateProjectileSpawnTransform(const FVector& Targ
 	const FVector SpawnLoc = MuzzleLoc + ((TargetLocation - MuzzleLoc).GetSafeNormal() * MuzzleOffset);
 
 	// find the aim rotation vector while applying some variance to the target 
-	const FRotator AimRot = UKismetMathLibrary::FindLookAtRotation(SpawnLoc, TargetLocation + (UKismetMathLibrary::RandomUnitVector() * AimVariance));
+	const FRotator AimRot = UKismetMathLibrary::FindLookAtRotation(SpawnLoc, TargetLocation + (UShooterRandomSubsystem::Draw(this).VRand() * AimVariance));
 
 	// return the built transform
 	return FTransform(AimRot, SpawnLoc, FVector::OneVector);
@@ -6,6 +6,7 @@
 #include "GameFramework/Actor.h"
 #include "ShooterWeaponHolder.h"
 #include "Animation/AnimInstance.h"
+#include "ShooterWeaponFireSubsystem.h"
 #include "ShooterWeapon.generated.h"
 
 class IShooterWeaponHolder;
@@ -42,6 +43,34 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Ammo")
 	TSubclassOf<AShooterProjectile> ProjectileClass;
 
+	/** If true, eligible projectiles are simulated by the projectile subsystem instead of being spawned as actors */
+	UPROPERTY(EditAnywhere, Category="Ammo")
+	bool bUseManagedProjectiles = false;
+
+	/** If true, this weapon resolves shots with batched traces instead of projectiles. Damage and noise settings still come from the projectile class */
+	UPROPERTY(EditAnywhere, Category="Hitscan")
+	bool bHitscan = false;
+
+	/** Number of pellets traced for each hitscan shot */
+	UPROPERTY(EditAnywhere, Category="Hitscan", meta = (EditCondition = "bHitscan", ClampMin = 1, ClampMax = 32))
+	int32 PelletsPerShot = 1;
+
+	/** Number of actors a hitscan pellet can go through after the first hit. Only pawns, physics bodies and actors tagged "Penetrable" can be gone through */
+	UPROPERTY(EditAnywhere, Category="Hitscan", meta = (EditCondition = "bHitscan", ClampMin = 0, ClampMax = 10))
+	int32 MaxPenetrations = 0;
+
+	/** Damage multiplier applied to a hitscan pellet for each actor it goes through */
+	UPROPERTY(EditAnywhere, Category="Hitscan", meta = (EditCondition = "bHitscan", ClampMin = 0, ClampMax = 1))
+	float PenetrationDamageScale = 0.5f;
+
+	/** Max distance of hitscan traces */
+	UPROPERTY(EditAnywhere, Category="Hitscan", meta = (EditCondition = "bHitscan", ClampMin = 0, ClampMax = 100000, Units = "cm"))
+	float HitscanRange = 10000.0f;
+
+	/** Collision channel hitscan traces run against. Defaults to the Projectile channel, since pawns ignore Visibility */
+	UPROPERTY(EditAnywhere, Category="Hitscan", meta = (EditCondition = "bHitscan"))
+	TEnumAsByte<ECollisionChannel> HitscanChannel = ECC_GameTraceChannel1;
+
 	/** Number of bullets in a magazine */
 	UPROPERTY(EditAnywhere, Category="Ammo", meta = (ClampMin = 0, ClampMax = 100))
 	int32 MagazineSize = 10;
@@ -85,14 +114,20 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Refire", meta = (ClampMin = 0, ClampMax = 5, Units = "s"))
 	float RefireRate = 0.5f;
 
-	/** Game time of last shot fired, used to enforce refire rate on semi auto */
-	float TimeOfLastShot = 0.0f;
+	/** Game time of last shot fired, used to enforce the refire rate */
+	double TimeOfLastShot = 0.0;
 
 	/** If true, the weapon is currently firing */
 	bool bIsFiring = false;
 
-	/** Timer to handle full auto refiring */
-	FTimerHandle RefireTimer;
+	/** If true, a semi auto trigger pull came in during the cooldown and will fire when it expires, even if the trigger is released */
+	bool bShotBuffered = false;
+
+	/** Due time of the scheduled shot being fired, or a negative value when firing right away */
+	double ScheduledShotTime = -1.0;
+
+	/** Bumped every time the pending fire event is replaced or cancelled, so the fire scheduler can drop the stale one */
+	uint32 FireScheduleSerial = 0;
 
 	/** Cast pawn pointer to the owner for AI perception system interactions */
 	TObjectPtr<APawn> PawnOwner;
@@ -122,6 +157,12 @@ protected:
 	/** Gameplay Cleanup */
 	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
 
+	/** Finishes initialization on clients where the owner replicated after the weapon began play */
+	virtual void OnRep_Owner() override;
+
+	/** Caches the owner and attaches to it. Does nothing if there's no owner yet or it's already been done */
+	void InitWeaponOwner();
+
 protected:
 
 	/** Called when the weapon's owner is destroyed */
@@ -150,9 +191,28 @@ protected:
 	/** Called when the refire rate time has passed while shooting semi auto weapons */
 	void FireCooldownExpired();
 
+	/** Replaces the pending fire event with a new one */
+	void ScheduleFireEvent(EShooterWeaponFireEvent Event, double DueTime);
+
+	/** Cancels the pending fire event */
+	void CancelFireEvent() { ++FireScheduleSerial; }
+
 	/** Fire a projectile towards the target location */
 	virtual void FireProjectile(const FVector& TargetLocation);
 
+	/** Resolves the shot through traces or projectiles */
+	void SpawnShot(const FVector& TargetLocation);
+
+	/** Replays a shot fired on the server for the other clients. Purely cosmetic */
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastFireCosmetic(FVector_NetQuantize TargetLocation);
+
+	/** Spawns or launches a projectile with the given transform */
+	void LaunchProjectile(const FTransform& ProjectileTransform);
+
+	/** Queues the pellets of a hitscan shot towards the target location */
+	void QueueHitscanShot(const FVector& TargetLocation);
+
 	/** Calculates the spawn transform for projectiles shot by this weapon */
 	FTransform CalculateProjectileSpawnTransform(const FVector& TargetLocation) const;
 
@@ -177,4 +237,13 @@ public:
 
 	/** Returns the current bullet count */
 	int32 GetBulletCount() const { return CurrentBullets; }
+
+	/** Refills the magazine, e.g. when a pooled owner is respawned */
+	void RefillMagazine() { CurrentBullets = MagazineSize; }
+
+	/** Returns the serial of the pending fire event */
+	uint32 GetFireScheduleSerial() const { return FireScheduleSerial; }
+
+	/** Called by the fire scheduler when the pending fire event comes due */
+	void HandleFireEvent(EShooterWeaponFireEvent Event, double DueTime);
 };
@@ -0,0 +1,67 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterWeaponFireSubsystem.h"
+#include "ShooterWeapon.h"
+#include "Engine/World.h"
+
+bool UShooterWeaponFireSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UShooterWeaponFireSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterWeaponFireSubsystem, STATGROUP_Tickables);
+}
+
+void UShooterWeaponFireSubsystem::ScheduleEvent(AShooterWeapon* Weapon, EShooterWeaponFireEvent Event, double DueTime, uint32 Serial)
+{
+	FScheduledEvent ScheduledEvent;
+	ScheduledEvent.DueTime = DueTime;
+	ScheduledEvent.Weapon = Weapon;
+	ScheduledEvent.Serial = Serial;
+	ScheduledEvent.Event = Event;
+
+	ScheduledEvents.HeapPush(ScheduledEvent);
+}
+
+void UShooterWeaponFireSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (ScheduledEvents.Num() == 0)
+	{
+		return;
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// pop everything that's due before dispatching, so events scheduled by the weapons wait for the next tick
+	DueEvents.Reset();
+
+	while (ScheduledEvents.Num() > 0 && ScheduledEvents.HeapTop().DueTime <= Now)
+	{
+		FScheduledEvent ScheduledEvent;
+		ScheduledEvents.HeapPop(ScheduledEvent, EAllowShrinking::No);
+
+		// drop events the weapon has cancelled or replaced
+		const AShooterWeapon* Weapon = ScheduledEvent.Weapon.Get();
+
+		if (IsValid(Weapon) && Weapon->GetFireScheduleSerial() == ScheduledEvent.Serial)
+		{
+			DueEvents.Add(ScheduledEvent);
+		}
+	}
+
+	// dispatch in due time order. A weapon may cancel a later event in the batch, so check the serial again
+	for (const FScheduledEvent& DueEvent : DueEvents)
+	{
+		AShooterWeapon* Weapon = DueEvent.Weapon.Get();
+
+		if (IsValid(Weapon) && Weapon->GetFireScheduleSerial() == DueEvent.Serial)
+		{
+			Weapon->HandleFireEvent(DueEvent.Event, DueEvent.DueTime);
+		}
+	}
+}
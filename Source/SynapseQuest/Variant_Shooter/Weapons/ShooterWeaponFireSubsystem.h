@@ -0,0 +1,82 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterWeaponFireSubsystem.generated.h"
+
+class AShooterWeapon;
+
+/**
+ *  Timed weapon events handled by the fire scheduler
+ */
+enum class EShooterWeaponFireEvent : uint8
+{
+	/** Fire the next shot */
+	Fire,
+
+	/** Notify the owner that a semi auto weapon can shoot again */
+	CooldownExpired
+};
+
+/**
+ *  Schedules the refire and cooldown events of every weapon in the world, replacing per weapon timers
+ *  Events are kept in a min-heap ordered by due time, and every due event is dispatched in a single batch per tick.
+ *  Weapons cancel events by bumping their schedule serial, and stale events are dropped when they come due
+ */
+UCLASS()
+class SYNAPSEQUEST_API UShooterWeaponFireSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** A weapon event waiting to come due */
+	struct FScheduledEvent
+	{
+		/** World time the event is due at */
+		double DueTime = 0.0;
+
+		/** Weapon to notify */
+		TWeakObjectPtr<AShooterWeapon> Weapon;
+
+		/** Weapon schedule serial at the time this event was scheduled. The event is stale if it no longer matches */
+		uint32 Serial = 0;
+
+		/** Event type */
+		EShooterWeaponFireEvent Event = EShooterWeaponFireEvent::Fire;
+
+		/** Heap ordering, earliest first */
+		bool operator<(const FScheduledEvent& Other) const { return DueTime < Other.DueTime; }
+	};
+
+	/** Min-heap of scheduled events */
+	TArray<FScheduledEvent> ScheduledEvents;
+
+	/** Events that came due this tick. Reused every tick */
+	TArray<FScheduledEvent> DueEvents;
+
+public:
+
+	/** Only schedule weapon events in game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Dispatches every due event */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat ID for this tickable */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/**
+	 *  Schedules a weapon event
+	 *  @param Weapon Weapon to notify
+	 *  @param Event Event type
+	 *  @param DueTime World time the event is due at
+	 *  @param Serial Weapon schedule serial. The event is dropped if the weapon's serial changes before it's due
+	 */
+	void ScheduleEvent(AShooterWeapon* Weapon, EShooterWeaponFireEvent Event, double DueTime, uint32 Serial);
+
+	/** Returns the number of scheduled events, including stale ones not yet dropped */
+	int32 GetNumScheduledEvents() const { return ScheduledEvents.Num(); }
+};
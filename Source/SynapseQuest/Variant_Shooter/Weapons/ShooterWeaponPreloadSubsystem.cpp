@@ -0,0 +1,238 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "ShooterWeaponPreloadSubsystem.h"
+#include "ShooterPickup.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/OutputDevice.h"
+#include "SynapseQuest.h"
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice ShooterWeaponsLoadReportCommand(
+	TEXT("Shooter.Weapons.LoadReport"),
+	TEXT("Prints the streaming time of every weapon mesh requested by the pickups in the world."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (const UShooterWeaponPreloadSubsystem* Preload = World ? World->GetSubsystem<UShooterWeaponPreloadSubsystem>() : nullptr)
+		{
+			Preload->Report(Ar);
+		}
+	}));
+
+bool UShooterWeaponPreloadSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UShooterWeaponPreloadSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// gather the weapons of every pickup placed in the level. Pickups haven't begun play yet, so they'll find their weapon already requested
+	TArray<int32> Indices;
+
+	for (TActorIterator<AShooterPickup> It(&InWorld); It; ++It)
+	{
+		const int32 Index = FindOrAddWeaponLoad(It->GetWeaponType());
+
+		if (Index != INDEX_NONE)
+		{
+			Indices.AddUnique(Index);
+		}
+	}
+
+	// stream them all in one request
+	StreamWeaponLoads(Indices);
+}
+
+void UShooterWeaponPreloadSubsystem::Deinitialize()
+{
+	for (FWeaponLoad& WeaponLoad : WeaponLoads)
+	{
+		if (WeaponLoad.Handle.IsValid() && WeaponLoad.Handle->IsLoadingInProgress())
+		{
+			WeaponLoad.Handle->CancelHandle();
+		}
+	}
+
+	WeaponLoads.Reset();
+	WeaponLoadIndices.Reset();
+
+	Super::Deinitialize();
+}
+
+void UShooterWeaponPreloadSubsystem::RequestWeaponMesh(AShooterPickup* Pickup)
+{
+	if (!Pickup)
+	{
+		return;
+	}
+
+	const int32 Index = FindOrAddWeaponLoad(Pickup->GetWeaponType());
+
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	FWeaponLoad& WeaponLoad = WeaponLoads[Index];
+	++WeaponLoad.NumPickups;
+
+	if (UStaticMesh* LoadedMesh = WeaponLoad.StaticMesh.Get())
+	{
+		Pickup->SetWeaponMesh(LoadedMesh);
+		return;
+	}
+
+	WeaponLoad.WaitingPickups.Add(Pickup);
+
+	// weapons that weren't in the level at begin play get a request of their own
+	if (!WeaponLoad.Handle.IsValid())
+	{
+		StreamWeaponLoads({ Index });
+	}
+}
+
+int32 UShooterWeaponPreloadSubsystem::FindOrAddWeaponLoad(const FDataTableRowHandle& WeaponType)
+{
+	const FWeaponTableRow* WeaponData = WeaponType.GetRow<FWeaponTableRow>(FString());
+
+	if (!WeaponData || WeaponData->StaticMesh.IsNull())
+	{
+		return INDEX_NONE;
+	}
+
+	// weapon rows sharing a mesh share its load
+	const FSoftObjectPath MeshPath = WeaponData->StaticMesh.ToSoftObjectPath();
+
+	if (const int32* Index = WeaponLoadIndices.Find(MeshPath))
+	{
+		return *Index;
+	}
+
+	FWeaponLoad& WeaponLoad = WeaponLoads.AddDefaulted_GetRef();
+	WeaponLoad.RowName = WeaponType.RowName;
+	WeaponLoad.StaticMesh = WeaponData->StaticMesh;
+
+	return WeaponLoadIndices.Add(MeshPath, WeaponLoads.Num() - 1);
+}
+
+void UShooterWeaponPreloadSubsystem::StreamWeaponLoads(const TArray<int32>& Indices)
+{
+	const double Now = FPlatformTime::Seconds();
+
+	TArray<FSoftObjectPath> MeshPaths;
+	TArray<int32> StreamedIndices;
+
+	for (const int32 Index : Indices)
+	{
+		FWeaponLoad& WeaponLoad = WeaponLoads[Index];
+		WeaponLoad.RequestTime = Now;
+
+		// meshes already in memory cost nothing
+		if (WeaponLoad.StaticMesh.Get())
+		{
+			WeaponLoad.LoadTime = 0.0;
+			continue;
+		}
+
+		MeshPaths.Add(WeaponLoad.StaticMesh.ToSoftObjectPath());
+		StreamedIndices.Add(Index);
+	}
+
+	if (MeshPaths.Num() == 0)
+	{
+		return;
+	}
+
+	TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		MoveTemp(MeshPaths),
+		FStreamableDelegate::CreateUObject(this, &UShooterWeaponPreloadSubsystem::OnLoadCompleted));
+
+	if (!Handle.IsValid())
+	{
+		return;
+	}
+
+	// get notified as each mesh comes in, so the per weapon times aren't all the time of the slowest one
+	Handle->BindUpdateDelegate(FStreamableUpdateDelegate::CreateUObject(this, &UShooterWeaponPreloadSubsystem::OnLoadUpdated));
+
+	for (const int32 Index : StreamedIndices)
+	{
+		WeaponLoads[Index].Handle = Handle;
+	}
+}
+
+void UShooterWeaponPreloadSubsystem::OnLoadUpdated(TSharedRef<FStreamableHandle> Handle)
+{
+	ApplyLoadedMeshes();
+}
+
+void UShooterWeaponPreloadSubsystem::OnLoadCompleted()
+{
+	ApplyLoadedMeshes();
+
+	UE_LOG(LogSynapseQuest, Log, TEXT("Shooter weapon preload finished. Run Shooter.Weapons.LoadReport for the per weapon times."));
+}
+
+void UShooterWeaponPreloadSubsystem::ApplyLoadedMeshes()
+{
+	const double Now = FPlatformTime::Seconds();
+
+	for (FWeaponLoad& WeaponLoad : WeaponLoads)
+	{
+		if (WeaponLoad.LoadTime >= 0.0)
+		{
+			continue;
+		}
+
+		UStaticMesh* LoadedMesh = WeaponLoad.StaticMesh.Get();
+
+		if (!LoadedMesh)
+		{
+			continue;
+		}
+
+		WeaponLoad.LoadTime = Now - WeaponLoad.RequestTime;
+
+		// swap the placeholders for the weapon mesh
+		for (const TWeakObjectPtr<AShooterPickup>& Pickup : WeaponLoad.WaitingPickups)
+		{
+			if (Pickup.IsValid())
+			{
+				Pickup->SetWeaponMesh(LoadedMesh);
+			}
+		}
+
+		WeaponLoad.WaitingPickups.Reset();
+	}
+}
+
+void UShooterWeaponPreloadSubsystem::Report(FOutputDevice& Ar) const
+{
+	Ar.Logf(TEXT("Shooter.Weapons.LoadReport: %d weapons"), WeaponLoads.Num());
+
+	for (const FWeaponLoad& WeaponLoad : WeaponLoads)
+	{
+		if (WeaponLoad.LoadTime >= 0.0)
+		{
+			Ar.Logf(TEXT("  %s (%s): loaded in %.2f ms, %d pickups"),
+				*WeaponLoad.RowName.ToString(), *WeaponLoad.StaticMesh.GetAssetName(), WeaponLoad.LoadTime * 1000.0, WeaponLoad.NumPickups);
+
+		} else if (WeaponLoad.Handle.IsValid() && WeaponLoad.Handle->HasLoadCompleted()) {
+
+			Ar.Logf(TEXT("  %s (%s): failed to load, %d pickups"),
+				*WeaponLoad.RowName.ToString(), *WeaponLoad.StaticMesh.GetAssetName(), WeaponLoad.NumPickups);
+
+		} else {
+
+			Ar.Logf(TEXT("  %s (%s): loading for %.2f ms, %d pickups"),
+				*WeaponLoad.RowName.ToString(), *WeaponLoad.StaticMesh.GetAssetName(), (FPlatformTime::Seconds() - WeaponLoad.RequestTime) * 1000.0, WeaponLoad.NumPickups);
+
+		}
+	}
+}
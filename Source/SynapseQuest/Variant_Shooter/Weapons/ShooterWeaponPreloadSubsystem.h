@@ -0,0 +1,92 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterWeaponPreloadSubsystem.generated.h"
+
+class AShooterPickup;
+class UStaticMesh;
+struct FDataTableRowHandle;
+struct FStreamableHandle;
+
+/**
+ *  Streams the weapon assets referenced by the pickups in the world, replacing synchronous loads
+ *  The pickups placed in the level are gathered when play begins and their meshes are requested in a single batch.
+ *  Pickups show a placeholder mesh until theirs has streamed in. Pickups spawned later request their weapon on their own.
+ *  Load times are recorded per weapon and printed with Shooter.Weapons.LoadReport
+ */
+UCLASS()
+class SYNAPSEQUEST_API UShooterWeaponPreloadSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Streaming state of a single weapon mesh */
+	struct FWeaponLoad
+	{
+		/** Data table row the weapon was first requested from */
+		FName RowName;
+
+		/** Mesh being streamed */
+		TSoftObjectPtr<UStaticMesh> StaticMesh;
+
+		/** Streaming request the mesh belongs to. Shared by every weapon in the same batch */
+		TSharedPtr<FStreamableHandle> Handle;
+
+		/** Real time the mesh was requested at */
+		double RequestTime = 0.0;
+
+		/** Seconds from the request until the mesh was loaded. Negative while loading */
+		double LoadTime = -1.0;
+
+		/** Number of pickups showing this weapon */
+		int32 NumPickups = 0;
+
+		/** Pickups waiting for the mesh */
+		TArray<TWeakObjectPtr<AShooterPickup>> WaitingPickups;
+	};
+
+	/** Every requested weapon */
+	TArray<FWeaponLoad> WeaponLoads;
+
+	/** Index of each weapon by mesh path */
+	TMap<FSoftObjectPath, int32> WeaponLoadIndices;
+
+public:
+
+	/** Only preload weapons in game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Gathers the pickups placed in the level and streams their weapons in a single batch */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Cancels any streaming still in progress */
+	virtual void Deinitialize() override;
+
+	/** Gives the pickup its weapon mesh, now or once it has streamed in */
+	void RequestWeaponMesh(AShooterPickup* Pickup);
+
+	/** Prints the load time of every weapon */
+	void Report(FOutputDevice& Ar) const;
+
+protected:
+
+	/**
+	 *  Finds or adds the weapon for a data table row
+	 *  @return the weapon index, or INDEX_NONE if the row has no mesh
+	 */
+	int32 FindOrAddWeaponLoad(const FDataTableRowHandle& WeaponType);
+
+	/** Streams the passed weapons in a single request */
+	void StreamWeaponLoads(const TArray<int32>& Indices);
+
+	/** Called as each asset of a request streams in */
+	void OnLoadUpdated(TSharedRef<FStreamableHandle> Handle);
+
+	/** Called when a request has finished streaming */
+	void OnLoadCompleted();
+
+	/** Records the load time of the newly loaded weapons and passes their meshes to the waiting pickups */
+	void ApplyLoadedMeshes();
+};